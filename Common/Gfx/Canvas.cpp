@@ -25,7 +25,9 @@ Microsoft::WRL::ComPtr<IWICImagingFactory> Canvas::c_WICFactory;
 Canvas::Canvas() :
 	m_Bitmap(),
 	m_TextAntiAliasing(false),
-	m_CanUseAxisAlignClip(false)
+	m_CanUseAxisAlignClip(false),
+	m_Clip(),
+	m_HasClip(false)
 {
 	Initialize();
 }
@@ -103,6 +105,7 @@ void Canvas::Resize(int w, int h)
 
 	m_GdipBitmap.reset(new Gdiplus::Bitmap(w, h, w * 4, PixelFormat32bppPARGB, m_Bitmap.GetData()));
 	m_GdipGraphics.reset(new Gdiplus::Graphics(m_GdipBitmap.get()));
+	m_HasClip = false;
 }
 
 bool Canvas::BeginDraw()
@@ -144,6 +147,12 @@ bool Canvas::BeginTargetDraw()
 
 		m_Target->BeginDraw();
 
+		if (m_HasClip)
+		{
+			// Pushed before the transform is applied so that the clip stays in canvas coordinates.
+			m_Target->PushAxisAlignedClip(Util::ToRectF(m_Clip), D2D1_ANTIALIAS_MODE_ALIASED);
+		}
+
 		// Apply any transforms that occurred before creation of |m_Target|.
 		UpdateTargetTransform();
 
@@ -157,6 +166,11 @@ void Canvas::EndTargetDraw()
 {
 	if (m_Target)
 	{
+		if (m_HasClip)
+		{
+			m_Target->PopAxisAlignedClip();
+		}
+
 		m_Target->EndDraw();
 		m_Target.Reset();
 	}
@@ -248,6 +262,25 @@ void Canvas::RotateTransform(float angle, float x, float y, float dx, float dy)
 	}
 }
 
+void Canvas::SetClip(const Gdiplus::Rect& rect)
+{
+	EndTargetDraw();
+
+	m_GdipGraphics->SetClip(rect);
+	m_Clip = rect;
+	m_HasClip = true;
+}
+
+void Canvas::ResetClip()
+{
+	if (!m_HasClip) return;
+
+	EndTargetDraw();
+
+	m_GdipGraphics->ResetClip();
+	m_HasClip = false;
+}
+
 void Canvas::SetAntiAliasing(bool enable)
 {
 	// TODO: Set m_Target aliasing?
@@ -280,6 +313,53 @@ void Canvas::Clear(const Gdiplus::Color& color)
 	m_Target->Clear(Util::ToColorF(color));
 }
 
+void Canvas::Scroll(int dx, int dy)
+{
+	EndTargetDraw();
+
+	BYTE* data = m_Bitmap.GetData();
+	if (!data || (dx == 0 && dy == 0)) return;
+
+	const size_t stride = (size_t)m_W * 4;
+	if (abs(dx) >= m_W || abs(dy) >= m_H)
+	{
+		memset(data, 0, stride * m_H);
+		return;
+	}
+
+	// Rows are moved away from the direction of the scroll first so that they are not overwritten
+	// before being read.
+	const size_t width = (size_t)(m_W - abs(dx)) * 4;
+	const size_t exposed = (size_t)abs(dx) * 4;
+	const int first = (dy > 0) ? m_H - 1 : 0;
+	const int last = (dy > 0) ? dy - 1 : m_H + dy;
+	const int step = (dy > 0) ? -1 : 1;
+	for (int y = first; y != last; y += step)
+	{
+		BYTE* row = data + y * stride;
+		const BYTE* src = data + (y - dy) * stride;
+		if (dx >= 0)
+		{
+			memmove(row + exposed, src, width);
+			memset(row, 0, exposed);
+		}
+		else
+		{
+			memmove(row, src + exposed, width);
+			memset(row + width, 0, exposed);
+		}
+	}
+
+	if (dy > 0)
+	{
+		memset(data, 0, stride * dy);
+	}
+	else if (dy < 0)
+	{
+		memset(data + stride * (m_H + dy), 0, stride * -dy);
+	}
+}
+
 void Canvas::DrawTextW(const std::wstring& srcStr, const TextFormat& format, Gdiplus::RectF& rect,
 	const Gdiplus::SolidBrush& brush, bool applyInlineFormatting)
 {
@@ -468,6 +548,13 @@ void Canvas::DrawBitmap(Gdiplus::Bitmap* bitmap, const Gdiplus::Rect& dstRect, c
 	bitmapLock->Release();
 }
 
+void Canvas::DrawCanvas(Canvas& canvas, int x, int y)
+{
+	const Gdiplus::Rect dstRect(x, y, canvas.m_W, canvas.m_H);
+	const Gdiplus::Rect srcRect(0, 0, canvas.m_W, canvas.m_H);
+	DrawBitmap(canvas.m_GdipBitmap.get(), dstRect, srcRect);
+}
+
 void Canvas::DrawMaskedBitmap(Gdiplus::Bitmap* bitmap, Gdiplus::Bitmap* maskBitmap, const Gdiplus::Rect& dstRect,
 	const Gdiplus::Rect& srcRect, const Gdiplus::Rect& srcRect2)
 {
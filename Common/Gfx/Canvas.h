@@ -38,6 +38,7 @@ public:
 	int GetH() const { return m_H; }
 
 	void SetAccurateText(bool option) { m_AccurateText = option; }
+	bool GetAccurateText() const { return m_AccurateText; }
 
 	// Resize the draw area of the Canvas. This function must not be called if BeginDraw() has been
 	// called and has not yet been matched by a correspoding call to EndDraw.
@@ -61,11 +62,20 @@ public:
 	void ResetTransform();
 	void RotateTransform(float angle, float x, float y, float dx, float dy);
 
+	// Restricts all drawing to |rect| until ResetClip() is called. This must be called while the
+	// transform is the identity so that |rect| is in canvas coordinates.
+	void SetClip(const Gdiplus::Rect& rect);
+	void ResetClip();
+
 	void SetAntiAliasing(bool enable);
 	void SetTextAntiAliasing(bool enable);
 
 	void Clear(const Gdiplus::Color& color = Gdiplus::Color(0, 0, 0, 0));
 
+	// Moves the pixels by |dx|, |dy| and makes the uncovered area transparent. BeginDraw() must
+	// have been called.
+	void Scroll(int dx, int dy);
+
 	void DrawTextW(const std::wstring& srcStr, const TextFormat& format, Gdiplus::RectF& rect,
 		const Gdiplus::SolidBrush& brush, bool applyInlineFormatting = false);
 	bool MeasureTextW(const std::wstring& srcStr, const TextFormat& format, Gdiplus::RectF& rect);
@@ -75,6 +85,10 @@ public:
 	void DrawMaskedBitmap(Gdiplus::Bitmap* bitmap, Gdiplus::Bitmap* maskBitmap, const Gdiplus::Rect& dstRect,
 		const Gdiplus::Rect& srcRect, const Gdiplus::Rect& srcRect2);
 
+	// Draws the contents of |canvas| with the top left corner at |x|, |y|. BeginDraw() must not
+	// have been called on |canvas|.
+	void DrawCanvas(Canvas& canvas, int x, int y);
+
 	void FillRectangle(Gdiplus::Rect& rect, const Gdiplus::SolidBrush& brush);
 
 	void DrawGeometry(Shape& shape, int x, int y);
@@ -122,6 +136,10 @@ private:
 	// |true| if PushAxisAlignedClip()/PopAxisAlignedClip() can be used.
 	bool m_CanUseAxisAlignClip;
 
+	// Set by SetClip() and applied to |m_Target| each time it is created.
+	Gdiplus::Rect m_Clip;
+	bool m_HasClip;
+
 	static UINT c_Instances;
 	static Microsoft::WRL::ComPtr<ID2D1Factory1> c_D2DFactory;
 	static Microsoft::WRL::ComPtr<IDWriteFactory1> c_DWFactory;
@@ -26,8 +26,7 @@
 #include "TextInlineFormat/TextInlineFormatWeight.h"
 #include "../StringUtil.h"
 #include "../../Library/ConfigParser.h"
-#include "../../Library/pcre/config.h"
-#include "../../Library/pcre/pcre.h"
+#include "../RegExpCache.h"
 #include <ole2.h>  // For Gdiplus.h.
 #include <GdiPlus.h>
 
@@ -483,15 +482,8 @@ void TextFormatD2D::FindInlineRanges(const std::wstring& str)
 		std::vector<DWRITE_TEXT_RANGE> ranges;
 
 		int ovector[300];
-		const char* error;
-		int errorOffset = 0;
 		int offset = 0;
-		pcre16* re = pcre16_compile(
-			(PCRE_SPTR16)fmt->GetPattern().c_str(),
-			PCRE_UTF16,
-			&error,
-			&errorOffset,
-			nullptr);  // Use default character tables.
+		auto re = GetRegExpCache().Get(fmt->GetPattern(), PCRE_UTF16);
 		if (!re)
 		{
 			//LogNoticeF(this, L"InlinePattern%i error at offset %d: %S", errorOffset, error);
@@ -500,10 +492,8 @@ void TextFormatD2D::FindInlineRanges(const std::wstring& str)
 		{
 			do
 			{
-				const int rc = pcre16_exec(
-					re,
-					nullptr,
-					(PCRE_SPTR16)str.c_str(),
+				const int rc = re->Exec(
+					str.c_str(),
 					(int)str.length(),
 					offset,
 					PCRE_NOTEMPTY,          // Empty string is not a valid match
@@ -541,8 +531,6 @@ void TextFormatD2D::FindInlineRanges(const std::wstring& str)
 
 			} while (true);
 
-			pcre16_free(re);
-
 			// Gradients are set up differently then other options because they require 'inner ranges'
 			// when text is split between multiple lines - otherwise set the range.
 			if (fmt->GetType() == InlineType::GradientColor)
@@ -199,19 +199,40 @@ static CharType GetCharType(WCHAR ch);
 static BYTE GetFunctionIndex(const WCHAR* str, BYTE len);
 static Operator GetOperator(const WCHAR* str);
 
-struct Parser
+enum class OpCode : BYTE
+{
+	Number,             // Pushes |number|.
+	Slot,               // Pushes the value of |slot|.
+	Operator,           // Applies the Operator in |arg|.
+	SingleArgFunction,  // Applies the function in |arg|.
+	MultiArgFunction,   // Applies the function in |arg| to the topmost |slot| values.
+	Select              // Pops the condition and both values of the ?: operator.
+};
+
+// The compiler only tracks the depth of the value stack. The actual values are computed when the
+// program is passed to Evaluate().
+struct Compiler
 {
 	Operation opStack[96];
-	double numStack[64];
 	char opTop;
 	char valTop;
 	int obrDist;
+	Program* program;
 
-	Parser() : opTop(0), valTop(-1), obrDist(2) { opStack[0].type = Operator::OpeningBracket; }
+	Compiler(Program* program) : opTop(0), valTop(-1), obrDist(2), program(program) { opStack[0].type = Operator::OpeningBracket; }
+
+	void Emit(OpCode opcode, BYTE arg = 0, int slot = 0, double number = 0.0)
+	{
+		const Program::Instruction instruction = { (BYTE)opcode, arg, slot, number };
+		program->code.push_back(instruction);
+	}
 };
 
-static const WCHAR* CalcToObr(Parser& parser);
-static const WCHAR* Calc(Parser& parser);
+static const int MAX_VALUES = 64;
+
+static const WCHAR* CalcToObr(Compiler& compiler);
+static const WCHAR* Calc(Compiler& compiler);
+static const WCHAR* Calc(Operator oper, double* numStack, int& valTop, double* result);
 
 struct Lexer
 {
@@ -273,55 +294,116 @@ const WCHAR* CheckedParse(const WCHAR* formula, double* result)
 	return error;
 }
 
+struct ParseContext
+{
+	GetValueFunc getValue;
+	void* getValueContext;
+	std::vector<double> values;
+};
+
+static bool ResolveParseValue(const WCHAR* str, int len, int* slot, void* context)
+{
+	auto parseContext = (ParseContext*)context;
+
+	double value;
+	if (parseContext->getValue &&
+		parseContext->getValue(str, len, &value, parseContext->getValueContext))
+	{
+		*slot = (int)parseContext->values.size();
+		parseContext->values.push_back(value);
+		return true;
+	}
+
+	return false;
+}
+
+static double GetParseValue(int slot, void* context)
+{
+	return ((ParseContext*)context)->values[slot];
+}
+
 const WCHAR* Parse(
 	const WCHAR* formula, double* result, GetValueFunc getValue, void* getValueContext)
+{
+	if (!*formula)
+	{
+		*result = 0.0;
+		return nullptr;
+	}
+
+	// Reuse the buffers of the previous call so that one-off formulas do not allocate. They are
+	// taken out for the duration of the call in case |getValue| parses another formula.
+	static thread_local Program s_Program;
+	static thread_local std::vector<double> s_Values;
+
+	ParseContext context = { getValue, getValueContext };
+	Program program;
+	program.code.swap(s_Program.code);
+	context.values.swap(s_Values);
+
+	const WCHAR* error = Compile(formula, &program, ResolveParseValue, &context);
+	if (!error)
+	{
+		error = Evaluate(program, result, GetParseValue, &context);
+	}
+
+	program.Clear();
+	context.values.clear();
+	s_Program.code.swap(program.code);
+	s_Values.swap(context.values);
+	return error;
+}
+
+const WCHAR* Compile(
+	const WCHAR* formula, Program* program, ResolveNameFunc resolveName, void* resolveNameContext)
 {
 	static WCHAR errorBuffer[128];
 
+	program->Clear();
 	if (!*formula)
 	{
-		*result = 0.0;
 		return nullptr;
 	}
 
-	Parser parser;
+	Compiler compiler(program);
 	Lexer lexer(formula);
 
-	const WCHAR* error;
-	for (;;)
+	const WCHAR* error = nullptr;
+	while (!error)
 	{
-		if ((parser.opTop == _countof(parser.opStack) - 2) ||
-			(parser.valTop == _countof(parser.numStack) - 2))
+		if ((compiler.opTop == _countof(compiler.opStack) - 2) ||
+			(compiler.valTop == MAX_VALUES - 2))
 		{
-			return eInternal;
+			error = eInternal;
+			break;
 		}
 
 		Token token = GetNextToken(lexer);
-		--parser.obrDist;
+		--compiler.obrDist;
 		switch (token)
 		{
 		case Token::Error:
-			return eSyntax;
+			error = eSyntax;
+			break;
 
 		case Token::Final:
-			if ((error = CalcToObr(parser)) != nullptr)
-			{
-				return error;
-			}
-			else if (parser.opTop != -1 || parser.valTop != 0)
+			if ((error = CalcToObr(compiler)) == nullptr)
 			{
-				return eInternal;
-			}
-			else
-			{
-				// Done!
-				*result = parser.numStack[0];
-				return nullptr;
+				if (compiler.opTop != -1 || compiler.valTop != 0)
+				{
+					error = eInternal;
+				}
+				else
+				{
+					// Done!
+					return nullptr;
+				}
 			}
 			break;
 
 		case Token::Number:
-			parser.numStack[++parser.valTop] = lexer.value.num;
+			compiler.Emit(OpCode::Number, 0, 0, lexer.value.num);
+			++compiler.valTop;
 			break;
 
 		case Token::Operator:
@@ -329,29 +411,32 @@ const WCHAR* Parse(
 			{
 			case Operator::OpeningBracket:
 				{
-					parser.opStack[++parser.opTop] = g_BrOp;
-					parser.obrDist = 2;
+					compiler.opStack[++compiler.opTop] = g_BrOp;
+					compiler.obrDist = 2;
 				}
 				break;
 
 			case Operator::ClosingBracket:
 				{
-					if ((error = CalcToObr(parser)) != nullptr) return error;
+					if ((error = CalcToObr(compiler)) == nullptr && compiler.opTop < 0)
+					{
+						error = eBrackets;
+					}
 				}
 				break;
 
 			case Operator::Comma:
 				{
-					if ((error = CalcToObr(parser)) != nullptr) return error;
-						
-					if (parser.opStack[parser.opTop].type == Operator::MultiArgFunction)
+					if ((error = CalcToObr(compiler)) != nullptr) break;
+
+					if (compiler.opStack[compiler.opTop].type == Operator::MultiArgFunction)
 					{
-						parser.opStack[++parser.opTop] = g_BrOp;
-						parser.obrDist = 2;
+						compiler.opStack[++compiler.opTop] = g_BrOp;
+						compiler.obrDist = 2;
 					}
 					else
 					{
-						return eSyntax;
+						error = eSyntax;
 					}
 				}
 				break;
@@ -363,7 +448,7 @@ const WCHAR* Parse(
 					switch (op.type)
 					{
 					case Operator::Addition:
-						if (parser.obrDist >= 1)
+						if (compiler.obrDist >= 1)
 						{
 							// Goto next token
 							continue;
@@ -371,9 +456,9 @@ const WCHAR* Parse(
 						break;
 
 					case Operator::Subtraction:
-						if (parser.obrDist >= 1)
+						if (compiler.obrDist >= 1)
 						{
-							parser.opStack[++parser.opTop] = g_NegOp;
+							compiler.opStack[++compiler.opTop] = g_NegOp;
 
 							// Goto next token
 							continue;
@@ -382,15 +467,16 @@ const WCHAR* Parse(
 
 					case Operator::Conditional:
 					case Operator::ConditionalSeparator:
-						parser.obrDist = 2;
+						compiler.obrDist = 2;
 						break;
 					}
 
-					while (g_OpPriorities[(int)op.type] <= g_OpPriorities[(int)parser.opStack[parser.opTop].type])
+					while (!error &&
+						g_OpPriorities[(int)op.type] <= g_OpPriorities[(int)compiler.opStack[compiler.opTop].type])
 					{
-						if ((error = Calc(parser)) != nullptr) return error;
+						error = Calc(compiler);
 					}
-					parser.opStack[++parser.opTop] = op;
+					compiler.opStack[++compiler.opTop] = op;
 				}
 				break;
 			}
@@ -405,11 +491,13 @@ const WCHAR* Parse(
 					switch (op.funcIndex)
 					{
 					case FUNC_E:
-						parser.numStack[++parser.valTop] = M_E;
+						compiler.Emit(OpCode::Number, 0, 0, M_E);
+						++compiler.valTop;
 						break;
 
 					case FUNC_PI:
-						parser.numStack[++parser.valTop] = M_PI;
+						compiler.Emit(OpCode::Number, 0, 0, M_PI);
+						++compiler.valTop;
 						break;
 
 					case FUNC_ATAN2:
@@ -418,213 +506,294 @@ const WCHAR* Parse(
 					case FUNC_MAX:
 					case FUNC_CLAMP:
 						op.type = Operator::MultiArgFunction;
-						op.prevTop = parser.valTop;
-						parser.opStack[++parser.opTop] = op;
+						op.prevTop = compiler.valTop;
+						compiler.opStack[++compiler.opTop] = op;
 						break;
 
 					default:	// Internal function
 						op.type = Operator::SingleArgFunction;
-						parser.opStack[++parser.opTop] = op;
+						compiler.opStack[++compiler.opTop] = op;
 						break;
 					}
 				}
 				else
 				{
-					double dblval;
-					if (getValue && getValue(lexer.name, (int)lexer.nameLen, &dblval, getValueContext))
+					int slot;
+					if (resolveName && resolveName(lexer.name, (int)lexer.nameLen, &slot, resolveNameContext))
 					{
-						parser.numStack[++parser.valTop] = dblval;
+						compiler.Emit(OpCode::Slot, 0, slot);
+						++compiler.valTop;
 						break;
 					}
 
 					const std::wstring name(lexer.name, lexer.nameLen);
 					_snwprintf_s(errorBuffer, _TRUNCATE, eUnknFunc, name.c_str());
-					return errorBuffer;
+					error = errorBuffer;
 				}
 				break;
 			}
 
 		default:
-			return eSyntax;
+			error = eSyntax;
+			break;
 		}
 	}
+
+	program->Clear();
+	return error;
 }
 
-static const WCHAR* Calc(Parser& parser)
+const WCHAR* Evaluate(
+	const Program& program, double* result, GetSlotValueFunc getSlotValue, void* getSlotValueContext)
 {
-	double res;
-	Operation op = parser.opStack[parser.opTop--];
+	if (program.IsEmpty())
+	{
+		*result = 0.0;
+		return nullptr;
+	}
+
+	double numStack[MAX_VALUES];
+	int valTop = -1;
+
+	for (const auto& instruction : program.code)
+	{
+		double res;
+		switch ((OpCode)instruction.opcode)
+		{
+		case OpCode::Number:
+			res = instruction.number;
+			break;
+
+		case OpCode::Slot:
+			res = getSlotValue ? getSlotValue(instruction.slot, getSlotValueContext) : 0.0;
+			break;
+
+		case OpCode::SingleArgFunction:
+			res = (*(SingleArgFunction)g_Functions[instruction.arg].proc)(numStack[valTop--]);
+			break;
+
+		case OpCode::MultiArgFunction:
+			{
+				valTop -= instruction.slot;
+				const WCHAR* error = (*(MultiArgFunction)g_Functions[instruction.arg].proc)(instruction.slot, &numStack[valTop + 1], &res);
+				if (error) return error;
+			}
+			break;
+
+		case OpCode::Select:
+			{
+				const double right = numStack[valTop--];
+				const double left = numStack[valTop--];
+				res = numStack[valTop--] ? left : right;
+			}
+			break;
+
+		case OpCode::Operator:
+			{
+				const WCHAR* error = Calc((Operator)instruction.arg, numStack, valTop, &res);
+				if (error) return error;
+			}
+			break;
+
+		default:
+			return eInternal;
+		}
+
+		numStack[++valTop] = res;
+	}
+
+	*result = numStack[0];
+	return nullptr;
+}
+
+static const WCHAR* Calc(Compiler& compiler)
+{
+	Operation op = compiler.opStack[compiler.opTop--];
 
 	// Multi-argument function
 	if (op.type == Operator::Conditional)
 	{
-		return nullptr; 
+		return nullptr;
 	}
 	else if (op.type == Operator::MultiArgFunction)
 	{
-		int paramcnt = parser.valTop - op.prevTop;
+		const int paramcnt = compiler.valTop - op.prevTop;
 
-		parser.valTop = op.prevTop;
-		const WCHAR* error = (*(MultiArgFunction)g_Functions[op.funcIndex].proc)(paramcnt, &parser.numStack[parser.valTop + 1], &res);
-		if (error) return error;
-
-		parser.numStack[++parser.valTop] = res;
+		compiler.valTop = op.prevTop;
+		compiler.Emit(OpCode::MultiArgFunction, op.funcIndex, paramcnt);
+		++compiler.valTop;
 		return nullptr;
 	}
-	else if (parser.valTop < 0)
+	else if (compiler.valTop < 0)
 	{
 		return eExtraOp;
 	}
 
-	// Right arg
-	double right = parser.numStack[parser.valTop--];
-
 	// One arg operations
 	if (op.type == Operator::BitwiseNOT)
 	{
-		res = (double)(~((long long)right));
+		compiler.Emit(OpCode::Operator, (BYTE)op.type);
 	}
 	else if (op.type == Operator::SingleArgFunction)
 	{
-		res = (*(SingleArgFunction)g_Functions[op.funcIndex].proc)(right);
+		compiler.Emit(OpCode::SingleArgFunction, op.funcIndex);
 	}
-	else
+	else if (compiler.valTop < 1)
+	{
+		return eExtraOp;
+	}
+	else if (op.type == Operator::ConditionalSeparator)
 	{
-		if (parser.valTop < 0)
+		// Needs three arguments
+		if (compiler.opTop < 0 || compiler.opStack[compiler.opTop--].type != Operator::Conditional ||
+			compiler.valTop < 2)
 		{
-			return eExtraOp;
+			return eLogicErr;
 		}
 
-		// Left arg
-		double left = parser.numStack[parser.valTop--];
-		switch (op.type)
-		{
-		case Operator::ShiftLeft:
-			res = (double)((long long)left << (long long)right);
-			break;
+		compiler.Emit(OpCode::Select);
+		compiler.valTop -= 2;
+	}
+	else
+	{
+		compiler.Emit(OpCode::Operator, (BYTE)op.type);
+		--compiler.valTop;
+	}
 
-		case Operator::ShiftRight:
-			res = (double)((long long)left >> (long long)right);
-			break;
+	return nullptr;
+}
 
-		case Operator::Power:
-			res = pow(left, right);
-			break;
+static const WCHAR* Calc(Operator oper, double* numStack, int& valTop, double* result)
+{
+	double& res = *result;
 
-		case Operator::NotEqual:
-			res = left != right;
-			break;
+	// Right arg
+	double right = numStack[valTop--];
 
-		case Operator::GreatorOrEqual:
-			res = left >= right;
-			break;
+	// One arg operations
+	if (oper == Operator::BitwiseNOT)
+	{
+		res = (double)(~((long long)right));
+		return nullptr;
+	}
 
-		case Operator::LessOrEqual:
-			res = left <= right;
-			break;
+	// Left arg
+	double left = numStack[valTop--];
+	switch (oper)
+	{
+	case Operator::ShiftLeft:
+		res = (double)((long long)left << (long long)right);
+		break;
 
-		case Operator::LogicalAND:
-			res = left && right;
-			break;
+	case Operator::ShiftRight:
+		res = (double)((long long)left >> (long long)right);
+		break;
 
-		case Operator::LogicalOR:
-			res = left || right;
-			break;
+	case Operator::Power:
+		res = pow(left, right);
+		break;
 
-		case Operator::Addition:
-			res = left + right;
-			break;
+	case Operator::NotEqual:
+		res = left != right;
+		break;
 
-		case Operator::Subtraction:
-			res = left - right;
-			break;
+	case Operator::GreatorOrEqual:
+		res = left >= right;
+		break;
 
-		case Operator::Multiplication:
-			res = left*  right;
-			break;
+	case Operator::LessOrEqual:
+		res = left <= right;
+		break;
 
-		case Operator::Division:
-			if (right == 0.0)
-			{
-				return eInfinity;
-			}
-			else
-			{
-				res = left / right;
-			}
-			break;
+	case Operator::LogicalAND:
+		res = left && right;
+		break;
 
-		case Operator::Modulo:
-			res = fmod(left, right);
-			break;
+	case Operator::LogicalOR:
+		res = left || right;
+		break;
 
-		case Operator::UNK:
-			if (left <= 0)
-			{
-				res = 0.0;
-			}
-			else if (right == 0.0)
-			{
-				return eInfinity;
-			}
-			else
-			{
-				res = ceil(left / right);
-			}
-			break;
+	case Operator::Addition:
+		res = left + right;
+		break;
 
-		case Operator::BitwiseXOR:
-			res = (double)((long long)left ^ (long long)right);
-			break;
+	case Operator::Subtraction:
+		res = left - right;
+		break;
 
-		case Operator::BitwiseAND:
-			res = (double)((long long)left & (long long)right);
-			break;
+	case Operator::Multiplication:
+		res = left*  right;
+		break;
 
-		case Operator::BitwiseOR:
-			res = (double)((long long)left | (long long)right);
-			break;
+	case Operator::Division:
+		if (right == 0.0)
+		{
+			return eInfinity;
+		}
+		else
+		{
+			res = left / right;
+		}
+		break;
 
-		case Operator::Equal:
-			res = left == right;
-			break;
+	case Operator::Modulo:
+		res = fmod(left, right);
+		break;
 
-		case Operator::Greater:
-			res = left > right;
-			break;
+	case Operator::UNK:
+		if (left <= 0)
+		{
+			res = 0.0;
+		}
+		else if (right == 0.0)
+		{
+			return eInfinity;
+		}
+		else
+		{
+			res = ceil(left / right);
+		}
+		break;
 
-		case Operator::Less:
-			res = left < right;
-			break;
+	case Operator::BitwiseXOR:
+		res = (double)((long long)left ^ (long long)right);
+		break;
 
-		case Operator::ConditionalSeparator:
-			{
-				// Needs three arguments
-				if (parser.opTop < 0 || parser.opStack[parser.opTop--].type != Operator::Conditional)
-				{
-					return eLogicErr;
-				}
-				res = parser.numStack[parser.valTop--] ? left : right;
-			}
-			break;
+	case Operator::BitwiseAND:
+		res = (double)((long long)left & (long long)right);
+		break;
 
-		default:
-			return eInternal;
-		}
+	case Operator::BitwiseOR:
+		res = (double)((long long)left | (long long)right);
+		break;
+
+	case Operator::Equal:
+		res = left == right;
+		break;
+
+	case Operator::Greater:
+		res = left > right;
+		break;
+
+	case Operator::Less:
+		res = left < right;
+		break;
+
+	default:
+		return eInternal;
 	}
 
-	parser.numStack[++parser.valTop] = res;
 	return nullptr;
 }
 
-static const WCHAR* CalcToObr(Parser& parser)
+static const WCHAR* CalcToObr(Compiler& compiler)
 {
-	while (parser.opStack[parser.opTop].type != Operator::OpeningBracket)
+	while (compiler.opStack[compiler.opTop].type != Operator::OpeningBracket)
 	{
-		const WCHAR* error = Calc(parser);
+		const WCHAR* error = Calc(compiler);
 		if (error) return error;
 	}
-	--parser.opTop;
+	--compiler.opTop;
 	return nullptr;
 }
 
@@ -11,17 +11,48 @@
 #define RM_COMMON_MATHPARSER_H_
 
 #include <Windows.h>
+#include <vector>
 
 namespace MathParser
 {
 	typedef bool (*GetValueFunc)(const WCHAR* str, int len, double* value, void* context);
 
+	// Resolves a name that is not a built-in function to a caller defined slot index. The value
+	// of the slot is then requested through GetSlotValueFunc each time the program is evaluated.
+	typedef bool (*ResolveNameFunc)(const WCHAR* str, int len, int* slot, void* context);
+	typedef double (*GetSlotValueFunc)(int slot, void* context);
+
+	// Formula compiled into a postfix instruction list. Evaluating a program does not involve
+	// any string work.
+	struct Program
+	{
+		struct Instruction
+		{
+			BYTE opcode;
+			BYTE arg;
+			int slot;
+			double number;
+		};
+
+		std::vector<Instruction> code;
+
+		bool IsEmpty() const { return code.empty(); }
+		void Clear() { code.clear(); }
+	};
+
 	const WCHAR* Check(const WCHAR* formula);
 	const WCHAR* CheckedParse(const WCHAR* formula, double* result);
 	const WCHAR* Parse(
 		const WCHAR* formula, double* result,
 		GetValueFunc getValue = nullptr, void* getValueContext = nullptr);
 
+	const WCHAR* Compile(
+		const WCHAR* formula, Program* program,
+		ResolveNameFunc resolveName = nullptr, void* resolveNameContext = nullptr);
+	const WCHAR* Evaluate(
+		const Program& program, double* result,
+		GetSlotValueFunc getSlotValue = nullptr, void* getSlotValueContext = nullptr);
+
 	bool IsDelimiter(WCHAR ch);
 };
 
@@ -86,6 +86,61 @@ public:
 		Assert::AreEqual(30.0, value);
 	}
 
+	TEST_METHOD(TestCompile)
+	{
+		Program program;
+		double value;
+
+		Assert::IsNull(Compile(L"", &program));
+		Assert::IsNull(Evaluate(program, &value));
+		Assert::AreEqual(0.0, value);
+
+		Assert::IsNull(Compile(L"(1 + 2) * 3", &program));
+		Assert::IsNull(Evaluate(program, &value));
+		Assert::AreEqual(9.0, value);
+
+		Assert::IsNull(Compile(L"clamp(a, 0, bbb) + (a > 5 ? 1 : 2)", &program, ResolveNameHelper));
+		double slotValues[] = { 10.0, 20.0 };
+		Assert::IsNull(Evaluate(program, &value, GetSlotValueHelper, slotValues));
+		Assert::AreEqual(11.0, value);
+
+		// The program must reflect the current slot values.
+		slotValues[0] = 30.0;
+		Assert::IsNull(Evaluate(program, &value, GetSlotValueHelper, slotValues));
+		Assert::AreEqual(21.0, value);
+
+		slotValues[1] = 0.0;
+		Assert::IsNull(Compile(L"a / bbb", &program, ResolveNameHelper));
+		Assert::IsNotNull(Evaluate(program, &value, GetSlotValueHelper, slotValues));
+
+		Assert::IsNotNull(Compile(L"ccc_", &program, ResolveNameHelper));
+		Assert::IsTrue(program.IsEmpty());
+		Assert::IsNotNull(Compile(L"1 +* 2", &program));
+		Assert::IsNull(Compile(L"min(1) + 1", &program));
+		Assert::IsNotNull(Evaluate(program, &value));
+	}
+
+	static bool ResolveNameHelper(const WCHAR* str, int len, int* slot, void* context)
+	{
+		if (wcsncmp(str, L"a", len) == 0)
+		{
+			*slot = 0;
+			return true;
+		}
+		else if (wcsncmp(str, L"bbb", len) == 0)
+		{
+			*slot = 1;
+			return true;
+		}
+
+		return false;
+	}
+
+	static double GetSlotValueHelper(int slot, void* context)
+	{
+		return ((double*)context)[slot];
+	}
+
 	static bool GetValueHelper(const WCHAR* str, int len, double* value, void* context)
 	{
 		if (wcsncmp(str, L"a", len) == 0)
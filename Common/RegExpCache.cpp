@@ -0,0 +1,122 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "RegExpCache.h"
+
+RegExp::RegExp(pcre16* code) :
+	m_Code(code),
+	m_Extra()
+{
+	// Studying returns nullptr if nothing could be learned about the pattern, which is fine.
+	const char* error;
+	m_Extra = pcre16_study(m_Code, PCRE_STUDY_JIT_COMPILE, &error);
+}
+
+RegExp::~RegExp()
+{
+	if (m_Extra)
+	{
+		pcre16_free_study(m_Extra);
+	}
+
+	pcre16_free(m_Code);
+}
+
+RegExpCache& GetRegExpCache()
+{
+	static RegExpCache s_RegExpCache(RegExpCache::DEFAULT_CAPACITY);
+	return s_RegExpCache;
+}
+
+RegExpCache::RegExpCache(size_t capacity) :
+	m_Capacity(capacity > 0 ? capacity : 1),
+	m_Hits(),
+	m_Misses(),
+	m_Evictions()
+{
+	InitializeCriticalSection(&m_CriticalSection);
+}
+
+RegExpCache::~RegExpCache()
+{
+	Clear();
+	DeleteCriticalSection(&m_CriticalSection);
+}
+
+/*
+** Returns the compiled pattern. Returns nullptr and sets error and errorOffset if the pattern
+** could not be compiled.
+**
+*/
+std::shared_ptr<const RegExp> RegExpCache::Get(const std::wstring& pattern, int options, const char** error, int* errorOffset)
+{
+	EnterCriticalSection(&m_CriticalSection);
+
+	m_Key.first.assign(pattern);
+	m_Key.second = options;
+
+	auto iter = m_Index.find(m_Key);
+	if (iter != m_Index.end())
+	{
+		++m_Hits;
+
+		// Move to the front.
+		m_Entries.splice(m_Entries.begin(), m_Entries, iter->second);
+	}
+	else
+	{
+		++m_Misses;
+
+		Entry entry = { m_Key, nullptr, nullptr, 0 };
+		pcre16* code = pcre16_compile(
+			(PCRE_SPTR16)pattern.c_str(),
+			options,
+			&entry.error,
+			&entry.errorOffset,
+			nullptr);  // Use default character tables.
+		if (code)
+		{
+			entry.regExp.reset(new RegExp(code));
+		}
+
+		if (m_Entries.size() >= m_Capacity)
+		{
+			// Evict the least recently used.
+			m_Index.erase(m_Entries.back().key);
+			m_Entries.pop_back();
+			++m_Evictions;
+		}
+
+		m_Entries.push_front(std::move(entry));
+		m_Index.emplace(m_Key, m_Entries.begin());
+	}
+
+	const Entry& entry = m_Entries.front();
+	std::shared_ptr<const RegExp> regExp = entry.regExp;
+	if (error) *error = entry.error;
+	if (errorOffset) *errorOffset = entry.errorOffset;
+
+	LeaveCriticalSection(&m_CriticalSection);
+	return regExp;
+}
+
+void RegExpCache::Clear()
+{
+	EnterCriticalSection(&m_CriticalSection);
+	m_Index.clear();
+	m_Entries.clear();
+	LeaveCriticalSection(&m_CriticalSection);
+}
+
+size_t RegExpCache::GetSize()
+{
+	EnterCriticalSection(&m_CriticalSection);
+	const size_t size = m_Entries.size();
+	LeaveCriticalSection(&m_CriticalSection);
+	return size;
+}
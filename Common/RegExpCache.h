@@ -0,0 +1,103 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#ifndef RM_COMMON_REGEXPCACHE_H_
+#define RM_COMMON_REGEXPCACHE_H_
+
+#include <Windows.h>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "../Library/pcre/config.h"
+#include "../Library/pcre/pcre.h"
+
+// A pattern compiled with pcre16_compile() and studied with pcre16_study(). The JIT compiler is
+// used if PCRE was built with it.
+class RegExp
+{
+public:
+	~RegExp();
+
+	RegExp(const RegExp& other) = delete;
+	RegExp& operator=(RegExp other) = delete;
+
+	int Exec(const WCHAR* subject, int length, int offset, int options, int* ovector, int ovecsize) const
+	{
+		return pcre16_exec(m_Code, m_Extra, (PCRE_SPTR16)subject, length, offset, options, ovector, ovecsize);
+	}
+
+private:
+	friend class RegExpCache;
+
+	RegExp(pcre16* code);
+
+	pcre16* m_Code;
+	pcre16_extra* m_Extra;
+};
+
+// Process-wide cache of compiled regular expressions keyed by the pattern and the compile
+// options. When the cache is full, the least recently used pattern is evicted. Patterns that fail
+// to compile are cached as well so that the error is returned without compiling again.
+//
+// All functions are thread-safe. A RegExp returned by Get() stays valid as long as it is
+// referenced, even if it is evicted in the meantime.
+class RegExpCache
+{
+public:
+	RegExpCache(size_t capacity);
+	~RegExpCache();
+
+	RegExpCache(const RegExpCache& other) = delete;
+	RegExpCache& operator=(RegExpCache other) = delete;
+
+	std::shared_ptr<const RegExp> Get(const std::wstring& pattern, int options, const char** error = nullptr, int* errorOffset = nullptr);
+
+	void Clear();
+
+	size_t GetSize();
+	ULONGLONG GetHits() const { return m_Hits; }
+	ULONGLONG GetMisses() const { return m_Misses; }
+	ULONGLONG GetEvictions() const { return m_Evictions; }
+
+	static const size_t DEFAULT_CAPACITY = 256;
+
+private:
+	typedef std::pair<std::wstring, int> Key;
+
+	struct KeyHash
+	{
+		size_t operator()(const Key& key) const
+		{
+			return std::hash<std::wstring>()(key.first) ^ ((size_t)key.second * 0x9E3779B9);
+		}
+	};
+
+	struct Entry
+	{
+		Key key;
+		std::shared_ptr<const RegExp> regExp;  // nullptr if the pattern could not be compiled
+		const char* error;
+		int errorOffset;
+	};
+
+	std::list<Entry> m_Entries;  // Most recently used first
+	std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_Index;
+	Key m_Key;  // buffer
+
+	size_t m_Capacity;
+
+	ULONGLONG m_Hits;
+	ULONGLONG m_Misses;
+	ULONGLONG m_Evictions;
+
+	CRITICAL_SECTION m_CriticalSection;
+};
+
+RegExpCache& GetRegExpCache();
+
+#endif
@@ -0,0 +1,78 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "RegExpCache.h"
+#include "UnitTest.h"
+
+TEST_CLASS(Common_RegExpCache_Test)
+{
+public:
+	TEST_METHOD(TestGet)
+	{
+		RegExpCache cache(4);
+
+		auto re1 = cache.Get(L"a(b+)", PCRE_UTF16);
+		auto re2 = cache.Get(L"a(b+)", PCRE_UTF16);
+		Assert::IsTrue(re1 && re1 == re2);
+		Assert::AreEqual(1ULL, cache.GetHits());
+		Assert::AreEqual(1ULL, cache.GetMisses());
+
+		// Different options are compiled separately.
+		auto re3 = cache.Get(L"a(b+)", PCRE_UTF16 | PCRE_CASELESS);
+		Assert::IsTrue(re3 && re3 != re1);
+		Assert::AreEqual(2ULL, cache.GetMisses());
+
+		int ovector[30];
+		Assert::AreEqual(2, re1->Exec(L"xabb", 4, 0, 0, ovector, 30));
+		Assert::AreEqual(1, ovector[0]);
+		Assert::AreEqual(4, ovector[3]);
+		Assert::IsTrue(re1->Exec(L"xABB", 4, 0, 0, ovector, 30) < 0);
+		Assert::AreEqual(2, re3->Exec(L"xABB", 4, 0, 0, ovector, 30));
+	}
+
+	TEST_METHOD(TestError)
+	{
+		RegExpCache cache(4);
+
+		const char* error = nullptr;
+		int errorOffset = -1;
+		Assert::IsFalse(cache.Get(L"a(b", PCRE_UTF16, &error, &errorOffset) != nullptr);
+		Assert::IsNotNull(error);
+		Assert::AreEqual(3, errorOffset);
+
+		// The error is cached as well.
+		const char* error2 = nullptr;
+		Assert::IsFalse(cache.Get(L"a(b", PCRE_UTF16, &error2) != nullptr);
+		Assert::IsTrue(error == error2);
+		Assert::AreEqual(1ULL, cache.GetHits());
+	}
+
+	TEST_METHOD(TestEviction)
+	{
+		RegExpCache cache(2);
+
+		auto a = cache.Get(L"a", PCRE_UTF16);
+		cache.Get(L"b", PCRE_UTF16);
+		cache.Get(L"a", PCRE_UTF16);  // "b" is now the least recently used
+		cache.Get(L"c", PCRE_UTF16);
+		Assert::AreEqual(1ULL, cache.GetEvictions());
+		Assert::AreEqual((size_t)2, cache.GetSize());
+
+		cache.Get(L"a", PCRE_UTF16);
+		Assert::AreEqual(2ULL, cache.GetHits());
+		cache.Get(L"b", PCRE_UTF16);
+		Assert::AreEqual(4ULL, cache.GetMisses());
+		Assert::AreEqual(2ULL, cache.GetEvictions());
+
+		// Patterns stay usable after they have been evicted.
+		cache.Clear();
+		Assert::AreEqual((size_t)0, cache.GetSize());
+		int ovector[3];
+		Assert::AreEqual(1, a->Exec(L"a", 1, 0, 0, ovector, 3));
+	}
+};
@@ -134,4 +134,57 @@ void EncodeUrl(std::wstring& str)
 	}
 }
 
+int FormatDecimal(WCHAR* buffer, size_t size, double value, int decimals)
+{
+	static const double c_Powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+
+	// Below 2^43, the scaled value is within 2^-11 of the exact product. Unless the fraction is
+	// near one half, rounding it gives the same digits as printf. Ties are left to printf.
+	if (decimals >= 0 && decimals < _countof(c_Powers) && size >= 32)
+	{
+		const double scaled = fabs(value) * c_Powers[decimals];
+		if (scaled < 8796093022208.0)
+		{
+			const double integer = floor(scaled);
+			const double fraction = scaled - integer;
+			if (fabs(fraction - 0.5) > 1.0 / 512.0)
+			{
+				unsigned long long digits = (unsigned long long)integer + (fraction > 0.5 ? 1 : 0);
+
+				// Digits from the least significant, with at least one before the decimal point.
+				WCHAR reversed[32];
+				int count = 0;
+				do
+				{
+					reversed[count++] = (WCHAR)(L'0' + digits % 10);
+					digits /= 10;
+				}
+				while (digits != 0 || count <= decimals);
+
+				WCHAR* pos = buffer;
+				if (signbit(value))
+				{
+					*pos++ = L'-';
+				}
+
+				for (int i = count - 1; i >= 0; --i)
+				{
+					*pos++ = reversed[i];
+					if (i == decimals && i != 0)
+					{
+						*pos++ = L'.';
+					}
+				}
+
+				*pos = L'\0';
+				return (int)(pos - buffer);
+			}
+		}
+	}
+
+	WCHAR format[32];
+	_snwprintf_s(format, _TRUNCATE, L"%%.%if", decimals);
+	return _snwprintf_s(buffer, size, _TRUNCATE, format, value);
+}
+
 }  // namespace StringUtil
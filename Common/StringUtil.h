@@ -49,6 +49,10 @@ void EscapeRegExp(std::wstring& str);
 
 void EncodeUrl(std::wstring& str);
 
+// Same as _snwprintf_s(buffer, size, _TRUNCATE, L"%.<decimals>f", value), but values that can be
+// rounded exactly with integer arithmetic are formatted without going through printf.
+int FormatDecimal(WCHAR* buffer, size_t size, double value, int decimals);
+
 
 /*
 ** Case insensitive find function for std::string and std::wstring.
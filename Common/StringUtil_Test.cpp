@@ -42,6 +42,42 @@ public:
 		EncodeUrl(str);
 		Assert::AreEqual(L"%20%21%2A%27%28%29%3B%3A%40test%26%3D%2B%24%2C%2F%3F%23%5Bing%5D", str.c_str());
 	}
+
+	TEST_METHOD(TestFormatDecimal)
+	{
+		WCHAR buffer[128];
+		Assert::AreEqual(4, FormatDecimal(buffer, _countof(buffer), 1.5, 2));
+		Assert::AreEqual(L"1.50", buffer);
+		FormatDecimal(buffer, _countof(buffer), -0.001, 2);
+		Assert::AreEqual(L"-0.00", buffer);
+		FormatDecimal(buffer, _countof(buffer), 99.96, 1);
+		Assert::AreEqual(L"100.0", buffer);
+		FormatDecimal(buffer, _countof(buffer), 12345.678, 0);
+		Assert::AreEqual(L"12346", buffer);
+		FormatDecimal(buffer, _countof(buffer), 1e20, 2);
+		Assert::AreEqual(L"100000000000000000000.00", buffer);
+
+		// Compare with printf.
+		WCHAR expected[128];
+		unsigned int seed = 1;
+		for (int i = 0; i < 100000; ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			const int decimals = (int)(seed >> 16) % 12;
+			seed = seed * 1103515245 + 12345;
+			double value = (double)(int)(seed >> 1) / (double)(1 << ((seed >> 8) % 30));
+			if (i % 4 == 0)
+			{
+				// Ties and values that are exact in decimal.
+				value = (double)(int)(seed >> 12) / 8.0;
+			}
+
+			const int length = FormatDecimal(buffer, _countof(buffer), value, decimals);
+			_snwprintf_s(expected, _TRUNCATE, L"%.*f", decimals, value);
+			Assert::AreEqual((const WCHAR*)expected, buffer);
+			Assert::AreEqual((int)wcslen(expected), length);
+		}
+	}
 };
 
 }  // namespace StringUtil
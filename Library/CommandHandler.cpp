@@ -7,6 +7,7 @@
 
 #include "StdAfx.h"
 #include "../Common/PathUtil.h"
+#include "../Common/StringUtil.h"
 #include "CommandHandler.h"
 #include "ConfigParser.h"
 #include "DialogAbout.h"
@@ -91,6 +92,8 @@ const BangInfo s_Bangs[] =
 	{ Bang::UnpauseMeasureGroup, L"UnpauseMeasureGroup", 1 },
 	{ Bang::TogglePauseMeasureGroup, L"TogglePauseMeasureGroup", 1 },
 	{ Bang::UpdateMeasureGroup, L"UpdateMeasureGroup", 1 },
+	{ Bang::BeginBatch, L"BeginBatch", 0 },
+	{ Bang::EndBatch, L"EndBatch", 0 },
 	{ Bang::SkinCustomMenu, L"SkinCustomMenu", 0 }
 };
 
@@ -139,6 +142,37 @@ const CustomBangInfo s_CustomBangs[] =
 	{ Bang::LsBoxHook, L"LsBoxHook", CommandHandler::DoLsBoxHookBang }
 };
 
+/*
+** Returns the index of the bang in the bang tables, counting s_Bangs, s_GroupBangs, and
+** s_CustomBangs one after another, or -1 if not found. The name is not case-sensitive.
+**
+*/
+int FindBang(const WCHAR* name)
+{
+	static const std::unordered_map<std::wstring, int> s_Index = []()
+	{
+		std::unordered_map<std::wstring, int> index;
+		int i = 0;
+		auto add = [&](const WCHAR* name)
+		{
+			std::wstring key = name;
+			StringUtil::ToLowerCase(key);
+			index.emplace(key, i++);  // The first one wins if a name is listed twice.
+		};
+
+		for (const auto& bangInfo : s_Bangs) add(bangInfo.name);
+		for (const auto& bangInfo : s_GroupBangs) add(bangInfo.name);
+		for (const auto& bangInfo : s_CustomBangs) add(bangInfo.name);
+		return index;
+	}();
+
+	std::wstring key = name;
+	StringUtil::ToLowerCase(key);
+
+	auto iter = s_Index.find(key);
+	return (iter != s_Index.end()) ? iter->second : -1;
+}
+
 void DoBang(const BangInfo& bangInfo, std::vector<std::wstring>& args, Skin* skin)
 {
 	const size_t argsCount = args.size();
@@ -220,8 +254,58 @@ void DoGroupBang(const BangInfo& bangInfo, std::vector<std::wstring>& args, Skin
 	}
 }
 
+/*
+** Runs the bang with the index returned by FindBang().
+**
+*/
+void RunBang(int bang, std::vector<std::wstring>& args, Skin* skin)
+{
+	const int bangCount = (int)_countof(s_Bangs);
+	const int groupBangCount = (int)_countof(s_GroupBangs);
+	if (bang < bangCount)
+	{
+		DoBang(s_Bangs[bang], args, skin);
+	}
+	else if (bang < bangCount + groupBangCount)
+	{
+		DoGroupBang(s_GroupBangs[bang - bangCount], args, skin);
+	}
+	else
+	{
+		s_CustomBangs[bang - bangCount - groupBangCount].handlerFunc(args, skin);
+	}
+}
+
+/*
+** Splits the arguments of a bang like ParseString() does. The [Measure] references are replaced
+** when the bang is executed.
+**
+*/
+void AddArguments(const WCHAR* str, std::vector<ActionProgram::Argument>& args)
+{
+	for (auto& value : CommandHandler::ParseString(str))
+	{
+		const bool dynamic = value.find(L'[') != std::wstring::npos;
+		args.push_back({std::move(value), dynamic});
+	}
+}
+
 }  // namespace
 
+void ActionProgram::Set(const std::wstring& action)
+{
+	if (m_Steps && action == m_Text) return;
+
+	auto steps = std::make_shared<std::vector<Step>>();
+	if (!action.empty())
+	{
+		CommandHandler::CompileAction(action.c_str(), *steps);
+	}
+
+	m_Text = action;
+	m_Steps = steps;
+}
+
 /*
 ** Parses and executes the given command.
 **
@@ -381,36 +465,182 @@ void CommandHandler::ExecuteCommand(const WCHAR* command, Skin* skin, bool multi
 }
 
 /*
-** Runs the given bang.
+** Splits the given command into steps in the same way as ExecuteCommand() does so that
+** ExecuteAction() gives the same result.
 **
 */
-void CommandHandler::ExecuteBang(const WCHAR* name, std::vector<std::wstring>& args, Skin* skin)
+void CommandHandler::CompileAction(const WCHAR* command, std::vector<ActionProgram::Step>& steps, bool multi)
 {
-	for (const auto& bangInfo : s_Bangs)
+	typedef ActionProgram::Step Step;
+
+	if (command[0] == L'!')	// Bang
 	{
-		if (_wcsicmp(bangInfo.name, name) == 0)
+		++command;	// Skip "!"
+
+		if (_wcsnicmp(L"Execute", command, 7) == 0)
 		{
-			DoBang(bangInfo, args, skin);
+			command += 7;
+			command = wcschr(command, L'[');
+			if (!command) return;
+		}
+		else
+		{
+			if (_wcsnicmp(command, L"Rainmeter", 9) == 0)
+			{
+				// Skip "Rainmeter" for backwards compatibility
+				command += 9;
+			}
+
+			Step step;
+			step.type = Step::Type::Bang;
+
+			const WCHAR* pos = wcschr(command, L' ');
+			if (pos)
+			{
+				step.name.assign(command, pos - command);
+				AddArguments(pos + 1, step.args);
+			}
+			else
+			{
+				step.name = command;
+			}
+
+			step.bang = FindBang(step.name.c_str());
+			steps.push_back(std::move(step));
 			return;
 		}
 	}
 
-	for (const auto& bangInfo : s_GroupBangs)
+	if (multi && command[0] == L'[')	// Multi-bang
 	{
-		if (_wcsicmp(bangInfo.name, name) == 0)
+		std::wstring bangs = command;
+		std::wstring::size_type start = std::wstring::npos;
+		int count = 0;
+		for (size_t i = 0, isize = bangs.size(); i < isize; ++i)
 		{
-			DoGroupBang(bangInfo, args, skin);
-			return;
+			if (bangs[i] == L'[')
+			{
+				if (count == 0)
+				{
+					start = i;
+				}
+				++count;
+			}
+			else if (bangs[i] == L']')
+			{
+				--count;
+
+				if (count == 0 && start != std::wstring::npos)
+				{
+					// Change ] to nullptr
+					bangs[i] = L'\0';
+
+					// Skip whitespace
+					start = bangs.find_first_not_of(L" \t\r\n", start + 1, 4);
+
+					const WCHAR* newCommand = bangs.c_str() + start;
+					if (_wcsnicmp(newCommand, L"!Delay ", wcslen(L"!Delay ")) == 0)
+					{
+						Step step;
+						step.type = Step::Type::Delay;
+						step.bang = -1;
+						step.name.assign(newCommand + 1, wcslen(L"Delay"));
+						step.text = bangs.c_str() + i + 1;
+						AddArguments(newCommand + wcslen(L"!Delay "), step.args);
+						steps.push_back(std::move(step));
+					}
+					else
+					{
+						CompileAction(newCommand, steps, false);
+					}
+				}
+			}
+			else if (bangs[i] == L'"' && isize > (i + 2) && bangs[i + 1] == L'"' && bangs[i + 2] == L'"')
+			{
+				i += 3;
+
+				std::wstring::size_type pos = bangs.find(L"\"\"\"", i);
+				if (pos != std::wstring::npos)
+				{
+					i = pos + 2;	// Skip "", loop will skip last "
+				}
+			}
 		}
 	}
+	else
+	{
+		// Built-ins and commands to run are left to ExecuteCommand().
+		Step step;
+		step.type = Step::Type::Command;
+		step.bang = -1;
+		step.text = command;
+		steps.push_back(std::move(step));
+	}
+}
+
+/*
+** Executes the action compiled with CompileAction().
+**
+*/
+void CommandHandler::ExecuteAction(const ActionProgram& action, Skin* skin)
+{
+	typedef ActionProgram::Step Step;
 
-	for (const auto& bangInfo : s_CustomBangs)
+	// Hold a reference in case one of the bangs sets the action again.
+	const auto steps = action.m_Steps;
+	if (!steps) return;
+
+	std::vector<std::wstring> args;
+	for (const auto& step : *steps)
 	{
-		if (_wcsicmp(bangInfo.name, name) == 0)
+		if (step.type == Step::Type::Command)
 		{
-			bangInfo.handlerFunc(args, skin);
-			return;
+			ExecuteCommand(step.text.c_str(), skin, false);
+			continue;
 		}
+
+		args.resize(step.args.size());
+		for (size_t i = 0, isize = step.args.size(); i < isize; ++i)
+		{
+			const ActionProgram::Argument& arg = step.args[i];
+			args[i] = arg.value;
+			if (arg.dynamic && skin)
+			{
+				skin->GetParser().ReplaceMeasures(args[i]);
+			}
+		}
+
+		if (step.type == Step::Type::Delay && skin)
+		{
+			if (args.size() == 1)
+			{
+				auto delay = ConfigParser::ParseUInt(args[0].c_str(), 0);
+				skin->DoDelayedCommand(step.text.c_str(), delay);
+				return;
+			}
+		}
+		else if (step.bang != -1)
+		{
+			RunBang(step.bang, args, skin);
+		}
+		else
+		{
+			LogErrorF(skin, L"Invalid bang: !%s", step.name.c_str());
+		}
+	}
+}
+
+/*
+** Runs the given bang.
+**
+*/
+void CommandHandler::ExecuteBang(const WCHAR* name, std::vector<std::wstring>& args, Skin* skin)
+{
+	const int bang = FindBang(name);
+	if (bang != -1)
+	{
+		RunBang(bang, args, skin);
+		return;
 	}
 
 	LogErrorF(skin, L"Invalid bang: !%s", name);
@@ -9,6 +9,7 @@
 #define RM_LIBRARY_COMMANDHANDLER_H_
 
 #include <Windows.h>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -90,6 +91,8 @@ enum class Bang
 	SetTransparencyGroup,
 	SetVariableGroup,
 	SetOptionGroup,
+	BeginBatch,
+	EndBatch,
 	WriteKeyValue,
 	LoadLayout,
 	SetClip,
@@ -105,11 +108,55 @@ enum class Bang
 	LsBoxHook
 };
 
+// An action option, e.g. OnUpdateAction, split into its bangs and their arguments when it is set
+// so that it can be executed without parsing the string again. Only the arguments containing
+// [Measure] references are replaced when executed.
+class ActionProgram
+{
+public:
+	// Compiles |action| unless it is the same as the current one.
+	void Set(const std::wstring& action);
+
+	const std::wstring& GetText() const { return m_Text; }
+	bool IsEmpty() const { return m_Text.empty(); }
+
+	struct Argument
+	{
+		std::wstring value;
+		bool dynamic;		// Contains [Measure] references
+	};
+
+	struct Step
+	{
+		enum class Type
+		{
+			Bang,
+			Delay,			// [!Delay N] followed by the rest of the action in |text|
+			Command			// Executed with ExecuteCommand()
+		};
+
+		Type type;
+		int bang;			// Index to the bang table or -1 if invalid
+		std::wstring name;
+		std::wstring text;
+		std::vector<Argument> args;
+	};
+
+private:
+	friend class CommandHandler;
+
+	std::wstring m_Text;
+
+	// Shared so that the steps stay valid if the action is set again while it is being executed.
+	std::shared_ptr<const std::vector<Step>> m_Steps;
+};
+
 // Parses and executes commands and bangs.
 class CommandHandler
 {
 public:
 	void ExecuteCommand(const WCHAR* command, Skin* skin, bool multi = true);
+	void ExecuteAction(const ActionProgram& action, Skin* skin);
 	void ExecuteBang(const WCHAR* name, std::vector<std::wstring>& args, Skin* skin);
 
 	static void RunCommand(std::wstring command);
@@ -117,6 +164,8 @@ public:
 
 	static std::vector<std::wstring> ParseString(const WCHAR* str, ConfigParser* parser = nullptr);
 
+	static void CompileAction(const WCHAR* command, std::vector<ActionProgram::Step>& steps, bool multi = true);
+
 	static void DoActivateSkinBang(std::vector<std::wstring>& args, Skin* skin);
 	static void DoDeactivateSkinBang(std::vector<std::wstring>& args, Skin* skin);
 	static void DoToggleSkinBang(std::vector<std::wstring>& args, Skin* skin);
@@ -9,6 +9,7 @@
 #include "../Common/MathParser.h"
 #include "../Common/PathUtil.h"
 #include "ConfigParser.h"
+#include "IniParser.h"
 #include "Util.h"
 #include "Rainmeter.h"
 #include "System.h"
@@ -37,15 +38,26 @@ const std::unordered_map<PairedPunctuation, PairInfo> s_PairedPunct =
 	{ PairedPunctuation::Guillemet,   { L'<', L'>' } }
 };
 
+const size_t MAX_CACHED_FORMULAS = 256;
+
 }  // namespace
 
 std::unordered_map<std::wstring, std::wstring> ConfigParser::c_MonitorVariables;
+UINT ConfigParser::c_MonitorVariablesVersion = 0;
 
 ConfigParser::ConfigParser() :
 	m_LastReplaced(false),
 	m_LastDefaultUsed(false),
 	m_LastValueDefined(false),
 	m_CurrentSection(),
+	m_VariablesVersion(),
+	m_SymbolsVersion(),
+	m_CurrentSectionUsed(false),
+	m_TrackedMeasures(),
+	m_TrackedOther(false),
+	m_OptionHash(),
+	m_TrackedFiles(),
+	m_ReadError(false),
 	m_Skin()
 {
 }
@@ -58,9 +70,12 @@ void ConfigParser::Initialize(const std::wstring& filename, Skin* skin, LPCTSTR
 {
 	m_Skin = skin;
 
-	m_Measures.clear();
+	m_Symbols.Clear();
+	++m_SymbolsVersion;
 	m_Sections.clear();
 	m_Values.clear();
+	m_Formulas.clear();
+	m_OptionTemplates.clear();
 	m_BuiltInVariables.clear();
 	m_Variables.clear();
 
@@ -70,6 +85,10 @@ void ConfigParser::Initialize(const std::wstring& filename, Skin* skin, LPCTSTR
 	m_LastValueDefined = false;
 
 	m_CurrentSection = nullptr;
+	m_TrackedMeasures = nullptr;
+	m_OptionHash = nullptr;
+	m_TrackedFiles = nullptr;
+	m_ReadError = false;
 	m_SectionInsertPos = m_Sections.end();
 
 	// Set the built-in variables. Do this before the ini file is read so that the paths can be used with @include
@@ -78,7 +97,15 @@ void ConfigParser::Initialize(const std::wstring& filename, Skin* skin, LPCTSTR
 
 	System::UpdateIniFileMappingList();
 
-	ReadIniFile(filename, skinSection);
+	if (skin && !skinSection && GetRainmeter().GetSkinCache())
+	{
+		ReadCachedIniFile(filename);
+	}
+	else
+	{
+		ReadIniFile(filename, skinSection);
+	}
+
 	ReadVariables();
 
 	// Clear and minimize
@@ -136,12 +163,52 @@ void ConfigParser::ReadVariables()
 void ConfigParser::SetVariable(std::wstring strVariable, const std::wstring& strValue)
 {
 	StrToUpperC(strVariable);
-	m_Variables[strVariable] = strValue;
+	auto result = m_Variables.insert(std::make_pair(strVariable, strValue));
+	if (result.second)
+	{
+		++m_VariablesVersion;
+	}
+	else if (result.first->second != strValue)
+	{
+		result.first->second = strValue;
+		++m_VariablesVersion;
+	}
 }
 
 void ConfigParser::SetBuiltInVariable(const std::wstring& strVariable, const std::wstring& strValue)
 {
-	m_BuiltInVariables[strVariable] = strValue;
+	auto result = m_BuiltInVariables.insert(std::make_pair(strVariable, strValue));
+	if (result.second)
+	{
+		++m_VariablesVersion;
+	}
+	else if (result.first->second != strValue)
+	{
+		result.first->second = strValue;
+		++m_VariablesVersion;
+	}
+}
+
+/*
+** Starts recording the measures that are referenced with [Measure] or [Measure:...] in the
+** options read after this call.
+**
+*/
+void ConfigParser::StartReferenceTracking(std::vector<Measure*>* measures)
+{
+	m_TrackedMeasures = measures;
+	m_TrackedOther = false;
+}
+
+/*
+** Stops recording. Returns false if something else than a measure (e.g. [Meter:X]) was
+** referenced.
+**
+*/
+bool ConfigParser::StopReferenceTracking()
+{
+	m_TrackedMeasures = nullptr;
+	return !m_TrackedOther;
 }
 
 /*
@@ -156,6 +223,11 @@ const std::wstring* ConfigParser::GetVariable(const std::wstring& strVariable)
 	std::unordered_map<std::wstring, std::wstring>::const_iterator iter = m_BuiltInVariables.find(strTmp);
 	if (iter != m_BuiltInVariables.end())
 	{
+		if (&(*iter).second == m_CurrentSection)
+		{
+			m_CurrentSectionUsed = true;
+		}
+
 		return &(*iter).second;
 	}
 
@@ -177,11 +249,11 @@ const std::wstring* ConfigParser::GetVariable(const std::wstring& strVariable)
 }
 
 /*
-** Gets the value of a section variable. Returns true if strValue is set.
-** The selector is stripped from strVariable.
+** Resolves the section and the selector of a section variable such as [Meter:X] or
+** [Measure:/1024, 2]. Returns false if strVariable is not a valid section variable.
 **
 */
-bool ConfigParser::GetSectionVariable(std::wstring& strVariable, std::wstring& strValue)
+bool ConfigParser::ParseSectionVariable(std::wstring strVariable, SectionVariable& variable)
 {
 	size_t colonPos = strVariable.find_last_of(L':');
 	if (colonPos == std::wstring::npos)
@@ -195,35 +267,39 @@ bool ConfigParser::GetSectionVariable(std::wstring& strVariable, std::wstring& s
 
 	bool isKeySelector = (!selector.empty() && iswalpha(selectorSz[0]));
 
+	variable.meter = nullptr;
+	variable.measure = nullptr;
+	variable.scale = 1;
+	variable.decimals = -1;
+
 	if (isKeySelector)
 	{
 		// [Meter:X], [Meter:Y], [Meter:W], [Meter:H]
 		Meter* meter = m_Skin->GetMeter(strVariable);
 		if (meter)
 		{
-			WCHAR buffer[32];
 			if (_wcsicmp(selectorSz, L"X") == 0)
 			{
-				_itow_s(meter->GetX(), buffer, 10);
+				variable.type = SectionVariable::Type::MeterX;
 			}
 			else if (_wcsicmp(selectorSz, L"Y") == 0)
 			{
-				_itow_s(meter->GetY(), buffer, 10);
+				variable.type = SectionVariable::Type::MeterY;
 			}
 			else if (_wcsicmp(selectorSz, L"W") == 0)
 			{
-				_itow_s(meter->GetW(), buffer, 10);
+				variable.type = SectionVariable::Type::MeterW;
 			}
 			else if (_wcsicmp(selectorSz, L"H") == 0)
 			{
-				_itow_s(meter->GetH(), buffer, 10);
+				variable.type = SectionVariable::Type::MeterH;
 			}
 			else
 			{
 				return false;
 			}
 
-			strValue = buffer;
+			variable.meter = meter;
 			return true;
 		}
 	}
@@ -235,16 +311,8 @@ bool ConfigParser::GetSectionVariable(std::wstring& strVariable, std::wstring& s
 	// EscapeRegExp: [Measure:EscapeRegExp] (Escapes regular expression syntax, used for 'IfMatch')
 	// EncodeUrl: [Measure:EncodeUrl] (Escapes URL reserved characters)
 	// TimeStamp: [TimeMeasure:TimeStamp] (ONLY for Time measures, returns the Windows timestamp of the measure)
-	enum class ValueType
-	{
-		Raw,
-		Percentual,
-		Max,
-		Min,
-		EscapeRegExp,
-		EncodeUrl,
-		TimeStamp
-	} valueType = ValueType::Raw;
+	typedef SectionVariable::Type ValueType;
+	ValueType valueType = ValueType::Raw;
 
 	if (isKeySelector)
 	{
@@ -305,104 +373,151 @@ bool ConfigParser::GetSectionVariable(std::wstring& strVariable, std::wstring& s
 	}
 
 	Measure* measure = m_Skin->GetMeasure(strVariable);
-	if (measure)
+	if (!measure)
 	{
-		if (valueType == ValueType::EscapeRegExp)
-		{
-			strValue = measure->GetStringValue();
-			StringUtil::EscapeRegExp(strValue);
-			return true;
-		}
-		else if (valueType == ValueType::EncodeUrl)
-		{
-			strValue = measure->GetStringValue();
-			StringUtil::EncodeUrl(strValue);
-			return true;
-		}
-		else if (measure->GetTypeID() == TypeID<MeasureTime>() && valueType == ValueType::TimeStamp)
+		return false;
+	}
+
+	variable.measure = measure;
+	variable.type = valueType;
+
+	if (valueType == ValueType::EscapeRegExp || valueType == ValueType::EncodeUrl)
+	{
+		return true;
+	}
+	else if (valueType == ValueType::TimeStamp)
+	{
+		if (measure->GetTypeID() == TypeID<MeasureTime>())
 		{
-			MeasureTime* time = (MeasureTime*)measure;
-			strValue = std::to_wstring(time->GetTimeStamp().QuadPart / 10000000);
 			return true;
 		}
 
-		int scale = 1;
+		// Other measures return the raw value.
+		variable.type = ValueType::Raw;
+	}
 
-		const WCHAR* decimalsSz = wcschr(selectorSz, L',');
-		if (decimalsSz)
+	const WCHAR* decimalsSz = wcschr(selectorSz, L',');
+	if (decimalsSz)
+	{
+		++decimalsSz;
+	}
+
+	if (*selectorSz == L'%')  // Percentual
+	{
+		if (valueType == ValueType::Max || valueType == ValueType::Min)
 		{
-			++decimalsSz;
+			// '%' cannot be used with Max/Min values.
+			return false;
 		}
 
-		if (*selectorSz == L'%')  // Percentual
+		variable.type = ValueType::Percentual;
+	}
+	else if (*selectorSz == L'/')  // Scale
+	{
+		errno = 0;
+		variable.scale = _wtoi(selectorSz + 1);
+		if (errno == EINVAL || variable.scale == 0)
 		{
-			if (valueType == ValueType::Max || valueType == ValueType::Min)
-			{
-				// '%' cannot be used with Max/Min values.
-				return false;
-			}
-
-			valueType = ValueType::Percentual;
+			// Invalid scale value.
+			return false;
 		}
-		else if (*selectorSz == L'/')  // Scale
+	}
+	else
+	{
+		if (decimalsSz)
 		{
-			errno = 0;
-			scale = _wtoi(selectorSz + 1);
-			if (errno == EINVAL || scale == 0)
-			{
-				// Invalid scale value.
-				return false;
-			}
+			return false;
 		}
-		else
-		{
-			if (decimalsSz)
-			{
-				return false;
-			}
 
-			decimalsSz = selectorSz;
-		}
+		decimalsSz = selectorSz;
+	}
 
-		const double value =
-			(valueType == ValueType::Percentual) ? measure->GetRelativeValue() * 100.0 :
-			(valueType == ValueType::Max)        ? measure->GetMaxValue() / scale :
-			(valueType == ValueType::Min)        ? measure->GetMinValue() / scale :
-			                                       measure->GetValue() / scale;
-		int decimals = 10;
-		if (decimalsSz)
-		{
-			while (iswspace(*decimalsSz)) ++decimalsSz;
+	if (decimalsSz)
+	{
+		while (iswspace(*decimalsSz)) ++decimalsSz;
 
-			if (*decimalsSz)
-			{
-				decimals = _wtoi(decimalsSz);
-				decimals = max(0, decimals);
-				decimals = min(32, decimals);
-			}
-			else
-			{
-				decimalsSz = nullptr;
-			}
+		if (*decimalsSz)
+		{
+			variable.decimals = _wtoi(decimalsSz);
+			variable.decimals = max(0, variable.decimals);
+			variable.decimals = min(32, variable.decimals);
 		}
+	}
+
+	return true;
+}
 
-		WCHAR format[32];
-		WCHAR buffer[128];
-		_snwprintf_s(format, _TRUNCATE, L"%%.%if", decimals);
-		int bufferLen = _snwprintf_s(buffer, _TRUNCATE, format, value);
-			
-		if (!decimalsSz)
+/*
+** Gets the current value of a section variable resolved with ParseSectionVariable().
+**
+*/
+void ConfigParser::GetSectionVariableValue(const SectionVariable& variable, std::wstring& strValue)
+{
+	typedef SectionVariable::Type ValueType;
+
+	if (variable.meter)
+	{
+		if (m_TrackedMeasures)
 		{
-			// Remove trailing zeros if decimal count was not specified.
-			measure->RemoveTrailingZero(buffer, bufferLen);
-			bufferLen = (int)wcslen(buffer);
+			m_TrackedOther = true;
 		}
 
-		strValue.assign(buffer, bufferLen);
-		return true;
+		const int value =
+			(variable.type == ValueType::MeterX) ? variable.meter->GetX() :
+			(variable.type == ValueType::MeterY) ? variable.meter->GetY() :
+			(variable.type == ValueType::MeterW) ? variable.meter->GetW() :
+			                                       variable.meter->GetH();
+
+		WCHAR buffer[32];
+		_itow_s(value, buffer, 10);
+		strValue = buffer;
+		return;
 	}
-	
-	return false;
+
+	Measure* measure = variable.measure;
+	if (m_TrackedMeasures)
+	{
+		m_TrackedMeasures->push_back(measure);
+	}
+
+	if (variable.type == ValueType::EscapeRegExp)
+	{
+		strValue = measure->GetStringValue();
+		StringUtil::EscapeRegExp(strValue);
+		return;
+	}
+	else if (variable.type == ValueType::EncodeUrl)
+	{
+		strValue = measure->GetStringValue();
+		StringUtil::EncodeUrl(strValue);
+		return;
+	}
+	else if (variable.type == ValueType::TimeStamp)
+	{
+		MeasureTime* time = (MeasureTime*)measure;
+		strValue = std::to_wstring(time->GetTimeStamp().QuadPart / 10000000);
+		return;
+	}
+
+	const double value =
+		(variable.type == ValueType::Percentual) ? measure->GetRelativeValue() * 100.0 :
+		(variable.type == ValueType::Max)        ? measure->GetMaxValue() / variable.scale :
+		(variable.type == ValueType::Min)        ? measure->GetMinValue() / variable.scale :
+		                                           measure->GetValue() / variable.scale;
+
+	WCHAR format[32];
+	WCHAR buffer[128];
+	_snwprintf_s(format, _TRUNCATE, L"%%.%if", (variable.decimals < 0) ? 10 : variable.decimals);
+	int bufferLen = _snwprintf_s(buffer, _TRUNCATE, format, value);
+
+	if (variable.decimals < 0)
+	{
+		// Remove trailing zeros if decimal count was not specified.
+		measure->RemoveTrailingZero(buffer, bufferLen);
+		bufferLen = (int)wcslen(buffer);
+	}
+
+	strValue.assign(buffer, bufferLen);
 }
 
 void ConfigParser::ResetMonitorVariables(Skin* skin)
@@ -425,7 +540,12 @@ void ConfigParser::SetMultiMonitorVariables(bool reset)
 {
 	auto setMonitorVariable = [&](const WCHAR* variable, const WCHAR* value)
 	{
-		c_MonitorVariables[variable] = value;
+		std::wstring& str = c_MonitorVariables[variable];
+		if (str != value)
+		{
+			str = value;
+			++c_MonitorVariablesVersion;
+		}
 	};
 
 	if (!reset && c_MonitorVariables.empty())
@@ -676,66 +796,183 @@ bool ConfigParser::ReplaceVariables(std::wstring& result)
 */
 bool ConfigParser::ReplaceMeasures(std::wstring& result)
 {
-	bool replaced = false;
+	if (result.find(L'[') == std::wstring::npos)
+	{
+		return false;
+	}
+
+	MeasureTemplate compiled;
+	CompileMeasures(result, compiled);
+	return RenderMeasures(compiled, result);
+}
 
+/*
+** Splits the string into the text and the [Measure] and [Section:selector] references to be
+** replaced. Escaped references such as [*Measure*] are unescaped in the text.
+**
+*/
+void ConfigParser::CompileMeasures(const std::wstring& str, MeasureTemplate& compiled)
+{
+	std::wstring& text = compiled.text;
+	text.clear();
+	compiled.references.clear();
+
+	size_t pos = 0;  // Start of the part of str not yet appended to text.
 	size_t start = 0;
-	while ((start = result.find(L'[', start)) != std::wstring::npos)
+	while ((start = str.find(L'[', start)) != std::wstring::npos)
 	{
 		size_t si = start + 1;
-		size_t end = result.find(L']', si);
+		size_t end = str.find(L']', si);
 		if (end == std::wstring::npos)
 		{
 			break;
 		}
 
-		size_t next = result.find(L'[', si);
+		size_t next = str.find(L'[', si);
 		if (next == std::wstring::npos || end < next)
 		{
 			size_t ei = end - 1;
-			if (si != ei && result[si] == L'*' && result[ei] == L'*')
+			if (si != ei && str[si] == L'*' && str[ei] == L'*')
 			{
-				result.erase(ei, 1);
-				result.erase(si, 1);
-				start = ei;
+				text.append(str, pos, si - pos);
+				text.append(str, si + 1, ei - si - 1);
+				pos = ei + 1;
 			}
 			else
 			{
-				std::wstring var = result.substr(si, end - si);
-
-				Measure* measure = GetMeasure(var);
-				if (measure)
+				MeasureTemplate::Reference reference;
+				reference.measure = GetMeasure(str.c_str() + si, end - si);
+				if (reference.measure ||
+					ParseSectionVariable(str.substr(si, end - si), reference.variable))
 				{
-					const WCHAR* value = measure->GetStringOrFormattedValue(AUTOSCALE_OFF, 1, -1, false);
-					size_t valueLen = wcslen(value);
-
-					// Measure found, replace it with the value
-					result.replace(start, end - start + 1, value, valueLen);
-					start += valueLen;
-					replaced = true;
-				}
-				else
-				{
-					std::wstring value;
-					if (GetSectionVariable(var, value))
-					{
-						// Replace section variable with the value.
-						result.replace(start, end - start + 1, value);
-						start += value.length();
-						replaced = true;
-					}
-					else
-					{
-						start = end;
-					}
+					text.append(str, pos, start - pos);
+					reference.position = text.length();
+					compiled.references.push_back(reference);
+					pos = end + 1;
 				}
 			}
+
+			start = end;
 		}
 		else
 		{
 			start = next;
 		}
 	}
-	
+
+	text.append(str, pos, std::wstring::npos);
+}
+
+/*
+** Renders the string compiled with CompileMeasures() into result. Returns true if something was
+** replaced.
+**
+*/
+bool ConfigParser::RenderMeasures(const MeasureTemplate& compiled, std::wstring& result)
+{
+	if (compiled.references.empty())
+	{
+		result = compiled.text;
+		return false;
+	}
+
+	result.clear();
+
+	size_t pos = 0;
+	for (const auto& reference : compiled.references)
+	{
+		result.append(compiled.text, pos, reference.position - pos);
+		pos = reference.position;
+
+		if (reference.measure)
+		{
+			if (m_TrackedMeasures)
+			{
+				m_TrackedMeasures->push_back(reference.measure);
+			}
+
+			result += reference.measure->GetStringOrFormattedValue(AUTOSCALE_OFF, 1, -1, false);
+		}
+		else
+		{
+			GetSectionVariableValue(reference.variable, m_SectionVariableValue);
+			result += m_SectionVariableValue;
+		}
+	}
+
+	result.append(compiled.text, pos, std::wstring::npos);
+	return true;
+}
+
+/*
+** Replaces the variables and measures in the value stored in m_Values. The variables are replaced
+** only if the value or a variable has changed since the last time, and the measures are replaced
+** from a template compiled once. Returns true if something was replaced.
+**
+*/
+bool ConfigParser::ReplaceCached(const std::wstring& source, const std::wstring& section, bool bReplaceMeasures, std::wstring& result)
+{
+	OptionTemplate& entry = m_OptionTemplates[&source];
+	if (entry.variablesVersion != m_VariablesVersion ||
+		entry.monitorVariablesVersion != c_MonitorVariablesVersion ||
+		(entry.usesCurrentSection && entry.section != section) ||
+		entry.source != source)
+	{
+		entry.source = source;
+		entry.value = source;
+		entry.variablesReplaced = false;
+		entry.usesCurrentSection = false;
+
+		if (entry.value.find(L'#') != std::wstring::npos)
+		{
+			m_CurrentSection->assign(section);  // Set temporarily
+			m_CurrentSectionUsed = false;
+
+			entry.variablesReplaced = ReplaceVariables(entry.value);
+			entry.usesCurrentSection = m_CurrentSectionUsed;
+
+			m_CurrentSection->clear();  // Reset
+		}
+		else
+		{
+			PathUtil::ExpandEnvironmentVariables(entry.value);
+		}
+
+		if (entry.usesCurrentSection)
+		{
+			entry.section = section;
+		}
+		else
+		{
+			entry.section.clear();
+		}
+
+		entry.variablesVersion = m_VariablesVersion;
+		entry.monitorVariablesVersion = c_MonitorVariablesVersion;
+		entry.measuresCompiled = false;
+	}
+
+	bool replaced = entry.variablesReplaced;
+
+	if (!bReplaceMeasures || entry.value.find(L'[') == std::wstring::npos)
+	{
+		result = entry.value;
+	}
+	else
+	{
+		if (!entry.measuresCompiled || entry.symbolsVersion != m_SymbolsVersion)
+		{
+			CompileMeasures(entry.value, entry.measures);
+			entry.measuresCompiled = true;
+			entry.symbolsVersion = m_SymbolsVersion;
+		}
+
+		if (RenderMeasures(entry.measures, result))
+		{
+			replaced = true;
+		}
+	}
+
 	return replaced;
 }
 
@@ -752,8 +989,8 @@ const std::wstring& ConfigParser::ReadString(LPCTSTR section, LPCTSTR key, LPCTS
 	const std::wstring strKey = key;
 	const std::wstring strDefault = defValue;
 
-	const std::wstring& strValue = GetValue(strSection, strKey, strDefault);
-	if (&strValue == &strDefault)
+	const std::wstring* source = &GetValue(strSection, strKey, strDefault);
+	if (source == &strDefault)
 	{
 		bool foundStyleValue = false;
 
@@ -768,7 +1005,7 @@ const std::wstring& ConfigParser::ReadString(LPCTSTR section, LPCTSTR key, LPCTS
 
 			if (&strStyleValue != &strDefault)
 			{
-				result = strStyleValue;
+				source = &strStyleValue;
 				foundStyleValue = true;
 				break;
 			}
@@ -778,42 +1015,37 @@ const std::wstring& ConfigParser::ReadString(LPCTSTR section, LPCTSTR key, LPCTS
 		{
 			result = strDefault;
 			m_LastDefaultUsed = true;
+
+			if (m_OptionHash)
+			{
+				m_OptionHash->Add(strKey);
+				m_OptionHash->Add(result);
+			}
 			return result;
 		}
 	}
-	else
-	{
-		result = strValue;
-	}
 
-	if (!result.empty())
+	if (source->size() >= 3)
 	{
 		m_LastValueDefined = true;
 
-		if (result.size() >= 3)
+		// The source is a value in m_Values so the result of the replacements can be cached.
+		if (ReplaceCached(*source, strSection, bReplaceMeasures, result))
 		{
-			if (result.find(L'#') != std::wstring::npos)
-			{
-				m_CurrentSection->assign(strSection);  // Set temporarily
-
-				if (ReplaceVariables(result))
-				{
-					m_LastReplaced = true;
-				}
-
-				m_CurrentSection->clear();  // Reset
-			}
-			else
-			{
-				PathUtil::ExpandEnvironmentVariables(result);
-			}
-
-			if (bReplaceMeasures && ReplaceMeasures(result))
-			{
-				m_LastReplaced = true;
-			}
+			m_LastReplaced = true;
 		}
 	}
+	else
+	{
+		result = *source;
+		m_LastValueDefined = !result.empty();
+	}
+
+	if (m_OptionHash)
+	{
+		m_OptionHash->Add(strKey);
+		m_OptionHash->Add(result);
+	}
 
 	return result;
 }
@@ -834,19 +1066,18 @@ void ConfigParser::AddMeasure(Measure* pMeasure)
 {
 	if (pMeasure)
 	{
-		m_Measures[StrToUpper(pMeasure->GetOriginalName())] = pMeasure;
+		m_Symbols.AddMeasure(pMeasure->GetOriginalName(), pMeasure);
+		++m_SymbolsVersion;
 	}
 }
 
-Measure* ConfigParser::GetMeasure(const std::wstring& name)
+void ConfigParser::AddMeter(Meter* meter)
 {
-	std::unordered_map<std::wstring, Measure*>::const_iterator iter = m_Measures.find(StrToUpper(name));
-	if (iter != m_Measures.end())
+	if (meter)
 	{
-		return (*iter).second;
+		m_Symbols.AddMeter(meter->GetOriginalName(), meter);
+		++m_SymbolsVersion;
 	}
-
-	return nullptr;
 }
 
 std::vector<Gdiplus::REAL> ConfigParser::ReadFloats(LPCTSTR section, LPCTSTR key)
@@ -885,7 +1116,7 @@ int ConfigParser::ReadInt(LPCTSTR section, LPCTSTR key, int defValue)
 		if (*string == L'(')
 		{
 			double dblValue;
-			const WCHAR* errMsg = MathParser::CheckedParse(string, &dblValue);
+			const WCHAR* errMsg = CheckedParseFormula(result, &dblValue);
 			if (!errMsg)
 			{
 				return (int)dblValue;
@@ -917,7 +1148,7 @@ uint32_t ConfigParser::ReadUInt(LPCTSTR section, LPCTSTR key, uint32_t defValue)
 		if (*string == L'(')
 		{
 			double dblValue;
-			const WCHAR* errMsg = MathParser::CheckedParse(string, &dblValue);
+			const WCHAR* errMsg = CheckedParseFormula(result, &dblValue);
 			if (!errMsg)
 			{
 				return (uint32_t)dblValue;
@@ -949,7 +1180,7 @@ uint64_t ConfigParser::ReadUInt64(LPCTSTR section, LPCTSTR key, uint64_t defValu
 		if (*string == L'(')
 		{
 			double dblValue;
-			const WCHAR* errMsg = MathParser::CheckedParse(string, &dblValue);
+			const WCHAR* errMsg = CheckedParseFormula(result, &dblValue);
 			if (!errMsg)
 			{
 				return (uint64_t)dblValue;
@@ -981,7 +1212,7 @@ double ConfigParser::ReadFloat(LPCTSTR section, LPCTSTR key, double defValue)
 		const WCHAR* string = result.c_str();
 		if (*string == L'(')
 		{
-			const WCHAR* errMsg = MathParser::CheckedParse(string, &value);
+			const WCHAR* errMsg = CheckedParseFormula(result, &value);
 			if (!errMsg)
 			{
 				return value;
@@ -1010,7 +1241,7 @@ bool ConfigParser::ParseFormula(const std::wstring& formula, double* resultValue
 	if (!formula.empty() && formula[0] == L'(' && formula[formula.size() - 1] == L')')
 	{
 		const WCHAR* string = formula.c_str();
-		const WCHAR* errMsg = MathParser::CheckedParse(string, resultValue);
+		const WCHAR* errMsg = CheckedParseFormula(formula, resultValue);
 		if (errMsg != nullptr)
 		{
 			LogErrorF(m_Skin, L"Formula: %s: %s", errMsg, string);
@@ -1023,6 +1254,39 @@ bool ConfigParser::ParseFormula(const std::wstring& formula, double* resultValue
 	return false;
 }
 
+/*
+** Same as MathParser::CheckedParse, but the compiled formula is cached so that formulas which are
+** read repeatedly (e.g. with DynamicVariables=1) are only tokenized once.
+**
+*/
+const WCHAR* ConfigParser::CheckedParseFormula(const std::wstring& formula, double* resultValue)
+{
+	auto iter = m_Formulas.find(formula);
+	if (iter == m_Formulas.end())
+	{
+		MathParser::Program program;
+		const WCHAR* errMsg = MathParser::Check(formula.c_str());
+		if (!errMsg)
+		{
+			errMsg = MathParser::Compile(formula.c_str(), &program);
+		}
+
+		if (errMsg)
+		{
+			return errMsg;
+		}
+
+		if (m_Formulas.size() >= MAX_CACHED_FORMULAS)
+		{
+			m_Formulas.clear();
+		}
+
+		iter = m_Formulas.emplace(formula, std::move(program)).first;
+	}
+
+	return MathParser::Evaluate(iter->second, resultValue);
+}
+
 ARGB ConfigParser::ReadColor(LPCTSTR section, LPCTSTR key, ARGB defValue)
 {
 	const std::wstring& result = ReadString(section, key, L"");
@@ -1387,6 +1651,7 @@ void ConfigParser::ReadIniFile(const std::wstring& iniFile, LPCTSTR skinSection,
 	if (depth > 100)	// Is 100 enough to assume the include loop never ends?
 	{
 		GetRainmeter().ShowMessage(nullptr, GetString(ID_STR_INCLUDEINFINITELOOP), MB_OK | MB_ICONERROR);
+		m_ReadError = true;
 		return;
 	}
 
@@ -1394,79 +1659,59 @@ void ConfigParser::ReadIniFile(const std::wstring& iniFile, LPCTSTR skinSection,
 	if (_waccess(iniFile.c_str(), 0) == -1)
 	{
 		LogErrorF(m_Skin, L"Unable to read file: %s", iniFile.c_str());
+		m_ReadError = true;
 		return;
 	}
 
-	// Avoid "IniFileMapping"
-	std::wstring iniRead = System::GetTemporaryFile(iniFile);
-	bool temporary = (!iniRead.empty() && (iniRead.size() != 1 || iniRead[0] != L'?'));
+	if (GetRainmeter().GetDebug()) LogDebugF(m_Skin, L"Reading file: %s", iniFile.c_str());
 
-	if (temporary)
+	// The file is parsed directly instead of with the profile functions, which also avoids
+	// "IniFileMapping".
+	IniParser ini;
+	if (m_TrackedFiles)
 	{
-		if (GetRainmeter().GetDebug()) LogDebugF(m_Skin, L"Reading file: %s (Temp: %s)", iniFile.c_str(), iniRead.c_str());
+		// The size and write time are read before the contents so that a concurrent change is
+		// detected later by the hash.
+		SkinCache::File file = { iniFile };
+		if (!SkinCache::GetFileInfo(file) || !ini.ReadFile(iniFile.c_str(), &file.hash))
+		{
+			LogErrorF(m_Skin, L"Unable to read file: %s", iniFile.c_str());
+			m_ReadError = true;
+			return;
+		}
+
+		m_TrackedFiles->push_back(file);
 	}
-	else
+	else if (!ini.ReadFile(iniFile.c_str()))
 	{
-		if (GetRainmeter().GetDebug()) LogDebugF(m_Skin, L"Reading file: %s", iniFile.c_str());
-		iniRead = iniFile;
+		LogErrorF(m_Skin, L"Unable to read file: %s", iniFile.c_str());
+		m_ReadError = true;
+		return;
 	}
 
 	// Get all the sections (i.e. different meters)
-	std::list<std::wstring> sections;
+	std::vector<std::pair<std::wstring, const IniParser::Section*>> sections;
 	std::unordered_set<std::wstring> unique;
 	std::wstring key, value;  // buffer
 
-	DWORD itemsSize = MAX_LINE_LENGTH;
-	WCHAR* items = new WCHAR[itemsSize];
-	WCHAR* pos = nullptr;
-	WCHAR* epos = nullptr;
-
 	if (skinSection == nullptr)
 	{
-		// Get all the sections
-		do
+		const std::vector<IniParser::Section>& iniSections = ini.GetSections();
+		for (auto iter = iniSections.cbegin(); iter != iniSections.cend(); ++iter)
 		{
-			items[0] = 0;
-			DWORD res = GetPrivateProfileSectionNames(items, itemsSize, iniRead.c_str());
-			if (res == 0)		// File not found
-			{
-				delete [] items;
-				if (temporary) System::RemoveFile(iniRead);
-				return;
-			}
-			if (res < itemsSize - 2)		// Fits in the buffer
-			{
-				epos = items + res;
-				break;
-			}
+			if (iter->nameLength == 0) continue;
 
-			delete [] items;
-			itemsSize *= 2;
-			items = new WCHAR[itemsSize];
-		}
-		while (true);
-
-		// Read the sections
-		pos = items;
-		while (pos < epos)
-		{
-			if (*pos)
+			value.assign(iter->name, iter->nameLength);  // section name
+			StrToUpperC(key.assign(value));
+			if (unique.insert(key).second)
 			{
-				value = pos;  // section name
-				StrToUpperC(key.assign(value));
-				if (unique.insert(key).second)
+				if (m_FoundSections.insert(key).second)
 				{
-					if (m_FoundSections.insert(key).second)
-					{
-						m_Sections.insert(m_SectionInsertPos, value);
-					}
-					sections.push_back(value);
+					m_Sections.insert(m_SectionInsertPos, value);
 				}
-				pos += value.size() + 1;
-			}
-			else  // Empty string
-			{
-				++pos;
+
+				// Like GetPrivateProfileSection(), only the first section with the name is read.
+				sections.emplace_back(value, &(*iter));
 			}
 		}
 	}
@@ -1476,8 +1721,8 @@ void ConfigParser::ReadIniFile(const std::wstring& iniFile, LPCTSTR skinSection,
 		const std::wstring strRainmeter = L"Rainmeter";
 		const std::wstring strFolder = skinSection;
 
-		sections.push_back(strRainmeter);
-		sections.push_back(strFolder);
+		sections.emplace_back(strRainmeter, ini.FindSection(strRainmeter.c_str()));
+		sections.emplace_back(strFolder, ini.FindSection(strFolder.c_str()));
 
 		if (depth == 0)  // Add once
 		{
@@ -1489,120 +1734,161 @@ void ConfigParser::ReadIniFile(const std::wstring& iniFile, LPCTSTR skinSection,
 	// Read the keys and values
 	for (auto it = sections.cbegin(); it != sections.cend(); ++it)
 	{
+		if (!it->second) continue;
+
 		unique.clear();
 
-		const WCHAR* sectionName = (*it).c_str();
+		const WCHAR* sectionName = it->first.c_str();
 		bool isVariables = (_wcsicmp(sectionName, L"Variables") == 0);
 		bool isMetadata = (skinSection == nullptr && !isVariables && _wcsicmp(sectionName, L"Metadata") == 0);
 		bool resetInsertPos = true;
 
 		// Read all "key=value" from the section
-		do
+		const std::vector<IniParser::Key>& keys = it->second->keys;
+		for (auto kt = keys.cbegin(); kt != keys.cend(); ++kt)
 		{
-			items[0] = 0;
-			DWORD res = GetPrivateProfileSection(sectionName, items, itemsSize, iniRead.c_str());
-			if (res < itemsSize - 2)		// Fits in the buffer
-			{
-				epos = items + res;
-				break;
-			}
-
-			delete [] items;
-			itemsSize *= 2;
-			items = new WCHAR[itemsSize];
-		}
-		while (true);
+			if (kt->nameLength == 0) continue;
 
-		pos = items;
-		while (pos < epos)
-		{
-			if (*pos)
+			StrToUpperC(key.assign(kt->name, kt->nameLength));
+			if (unique.insert(key).second)
 			{
-				size_t len = wcslen(pos);
-				WCHAR* sep = wmemchr(pos, L'=', len);
-				if (sep != nullptr && sep != pos)
+				const WCHAR* sep = kt->value;
+				size_t clen = kt->valueLength;
+
+				// Trim surrounded quotes from value
+				if (clen >= 2 && (sep[0] == L'"' || sep[0] == L'\'') && sep[clen - 1] == sep[0])
 				{
-					size_t clen = sep - pos;  // key's length
+					clen -= 2;
+					++sep;
+				}
 
-					StrToUpperC(key.assign(pos, clen));
-					if (unique.insert(key).second)
+				if (wcsncmp(key.c_str(), L"@INCLUDE", 8) == 0)
+				{
+					if (clen > 0)
 					{
-						++sep;
-						clen = len - (clen + 1);  // value's length
-
-						// Trim surrounded quotes from value
-						if (clen >= 2 && (sep[0] == L'"' || sep[0] == L'\'') && sep[clen - 1] == sep[0])
+						value.assign(sep, clen);
+						ReadVariables();
+						ReplaceVariables(value);
+						if (!PathUtil::IsAbsolute(value))
 						{
-							clen -= 2;
-							++sep;
+							// Relative to the ini folder
+							value.insert(0, PathUtil::GetFolderFromFilePath(iniFile));
 						}
 
-						if (wcsncmp(key.c_str(), L"@INCLUDE", 8) == 0)
+						if (resetInsertPos)
 						{
-							if (clen > 0)
+							if (it + 1 == sections.cend())  // Special case: @include was used in the last section of the current file
 							{
-								value.assign(sep, clen);
-								ReadVariables();
-								ReplaceVariables(value);
-								if (!PathUtil::IsAbsolute(value))
-								{
-									// Relative to the ini folder
-									value.insert(0, PathUtil::GetFolderFromFilePath(iniFile));
-								}
-
-								if (resetInsertPos)
+								// Set the insertion place to the last
+								m_SectionInsertPos = m_Sections.end();
+								resetInsertPos = false;
+							}
+							else
+							{
+								// Find the appropriate insertion place
+								for (auto jt = m_Sections.cbegin(); jt != m_Sections.cend(); ++jt)
 								{
-									auto jt = it;
-									if (++jt == sections.end())  // Special case: @include was used in the last section of the current file
+									if (_wcsicmp((*jt).c_str(), sectionName) == 0)
 									{
-										// Set the insertion place to the last
-										m_SectionInsertPos = m_Sections.end();
+										m_SectionInsertPos = ++jt;
 										resetInsertPos = false;
-									}
-									else
-									{
-										// Find the appropriate insertion place
-										for (jt = m_Sections.cbegin(); jt != m_Sections.cend(); ++jt)
-										{
-											if (_wcsicmp((*jt).c_str(), sectionName) == 0)
-											{
-												m_SectionInsertPos = ++jt;
-												resetInsertPos = false;
-												break;
-											}
-										}
+										break;
 									}
 								}
-
-								ReadIniFile(value, skinSection, depth + 1);
 							}
 						}
-						else
-						{
-							if (!isMetadata)  // Uncache Metadata's key-value pair in the skin
-							{
-								value.assign(sep, clen);
-								SetValue((*it), key, value);
 
-								if (isVariables)
-								{
-									m_ListVariables.push_back(key);
-								}
-							}
+						ReadIniFile(value, skinSection, depth + 1);
+					}
+				}
+				else
+				{
+					if (!isMetadata)  // Uncache Metadata's key-value pair in the skin
+					{
+						value.assign(sep, clen);
+						SetValue(it->first, key, value);
+
+						if (isVariables)
+						{
+							m_ListVariables.push_back(key);
 						}
 					}
 				}
-				pos += len + 1;
-			}
-			else  // Empty string
-			{
-				++pos;
 			}
 		}
 	}
+}
+
+/*
+** Reads the skin file from the snapshot in the cache folder if the snapshot is still valid.
+** Otherwise the file is read with ReadIniFile() and a new snapshot is saved.
+**
+*/
+void ConfigParser::ReadCachedIniFile(const std::wstring& iniFile)
+{
+	const std::wstring cacheFile = SkinCache::GetCacheFile(GetRainmeter().GetSettingsPath() + L"Cache\\", iniFile);
+	const ULONGLONG key = GetCacheKey(iniFile);
+
+	SkinCache::Snapshot snapshot;
+	if (SkinCache::Load(cacheFile, key, snapshot))
+	{
+		if (GetRainmeter().GetDebug()) LogDebugF(m_Skin, L"Reading cached file: %s", iniFile.c_str());
+
+		m_Sections.swap(snapshot.sections);
+		m_SectionInsertPos = m_Sections.end();
+		m_ListVariables.swap(snapshot.variables);
+
+		m_Values.reserve(snapshot.values.size());
+		for (auto& value : snapshot.values)
+		{
+			m_Values[value.first].swap(value.second);
+		}
+		return;
+	}
+
+	snapshot = SkinCache::Snapshot();
+	snapshot.key = key;
+
+	m_TrackedFiles = &snapshot.files;
+	m_ReadError = false;
+	ReadIniFile(iniFile);
+	m_TrackedFiles = nullptr;
+
+	if (!m_ReadError)
+	{
+		snapshot.sections = m_Sections;
+		snapshot.values.assign(m_Values.cbegin(), m_Values.cend());
+		snapshot.variables = m_ListVariables;
+		SkinCache::Save(cacheFile, snapshot);
+	}
+}
+
+/*
+** Returns a key for the skin cache. The key covers everything that the result of ReadIniFile()
+** depends on besides the files themselves, i.e. the variables that @Include paths can use.
+**
+*/
+ULONGLONG ConfigParser::GetCacheKey(const std::wstring& iniFile)
+{
+	ContentHash hash;
+	hash.Add(iniFile);
+
+	auto addVariables = [&](const std::unordered_map<std::wstring, std::wstring>& variables)
+	{
+		// Sorted so that the key does not depend on the order of the hash table.
+		const std::map<std::wstring, std::wstring> sorted(variables.cbegin(), variables.cend());
+		hash.Add((int)sorted.size());
+		for (const auto& variable : sorted)
+		{
+			hash.Add(variable.first);
+			hash.Add(variable.second);
+		}
+	};
 
-	delete [] items;
-	if (temporary) System::RemoveFile(iniRead);
+	addVariables(m_BuiltInVariables);
+	addVariables(c_MonitorVariables);
+	addVariables(m_Variables);
+	return hash.Get();
 }
 
 /*
@@ -19,6 +19,10 @@
 #include <cstdint>
 #include <ole2.h>  // For Gdiplus.h.
 #include <gdiplus.h>
+#include "../Common/MathParser.h"
+#include "ContentHash.h"
+#include "SkinCache.h"
+#include "SymbolTable.h"
 
 class Rainmeter;
 class Skin;
@@ -47,7 +51,13 @@ public:
 	void Initialize(const std::wstring& filename, Skin* skin = nullptr, LPCTSTR skinSection = nullptr, const std::wstring* resourcePath = nullptr);
 
 	void AddMeasure(Measure* pMeasure);
-	Measure* GetMeasure(const std::wstring& name);
+	void AddMeter(Meter* meter);
+	void ClearSymbols() { m_Symbols.Clear(); ++m_SymbolsVersion; }
+
+	Measure* GetMeasure(const std::wstring& name) { return m_Symbols.GetMeasure(name.c_str(), name.length()); }
+	Measure* GetMeasure(const WCHAR* name, size_t length) { return m_Symbols.GetMeasure(name, length); }
+	Meter* GetMeter(const std::wstring& name) { return m_Symbols.GetMeter(name.c_str(), name.length()); }
+	Meter* GetMeter(const WCHAR* name, size_t length) { return m_Symbols.GetMeter(name, length); }
 
 	const std::wstring* GetVariable(const std::wstring& strVariable);
 	void SetVariable(std::wstring strVariable, const std::wstring& strValue);
@@ -55,6 +65,15 @@ public:
 
 	const std::unordered_map<std::wstring, std::wstring>& GetVariables() { return m_Variables; }
 
+	// Incremented whenever the value of a variable changes.
+	UINT GetVariablesVersion() { return m_VariablesVersion; }
+
+	void StartReferenceTracking(std::vector<Measure*>* measures);
+	bool StopReferenceTracking();
+
+	void StartOptionHashing(ContentHash* hash) { m_OptionHash = hash; }
+	void StopOptionHashing() { m_OptionHash = nullptr; }
+
 	const std::wstring& GetValue(const std::wstring& strSection, const std::wstring& strKey, const std::wstring& strDefault);
 	void SetValue(const std::wstring& strSection, const std::wstring& strKey, const std::wstring& strValue);
 	void DeleteValue(const std::wstring& strSection, const std::wstring& strKey);
@@ -100,19 +119,85 @@ public:
 	static Gdiplus::Rect ParseRect(LPCTSTR string);
 	static RECT ParseRECT(LPCTSTR string);
 
-	static void ClearMultiMonitorVariables() { c_MonitorVariables.clear(); }
+	static void ClearMultiMonitorVariables() { c_MonitorVariables.clear(); ++c_MonitorVariablesVersion; }
 	static void UpdateWorkareaVariables() { SetMultiMonitorVariables(false); }
 
 private:
+	// A [Section:selector] reference with the section and selector already resolved.
+	struct SectionVariable
+	{
+		enum class Type
+		{
+			MeterX,
+			MeterY,
+			MeterW,
+			MeterH,
+			Raw,
+			Percentual,
+			Max,
+			Min,
+			EscapeRegExp,
+			EncodeUrl,
+			TimeStamp
+		};
+
+		Type type;
+		Meter* meter;
+		Measure* measure;
+		int scale;
+		int decimals;		// -1 if not specified
+	};
+
+	// A string with [Measure] and [Section:selector] references compiled into the text without
+	// the references and the positions at which their values are inserted.
+	struct MeasureTemplate
+	{
+		struct Reference
+		{
+			size_t position;
+			Measure* measure;		// [Measure] if set, otherwise a section variable
+			SectionVariable variable;
+		};
+
+		std::wstring text;
+		std::vector<Reference> references;
+	};
+
+	// The cached result of the substitutions for an option value stored in m_Values.
+	struct OptionTemplate
+	{
+		std::wstring source;
+		std::wstring section;		// Only set if #CURRENTSECTION# was used
+		bool usesCurrentSection;
+		bool variablesReplaced;
+		UINT variablesVersion;
+		UINT monitorVariablesVersion;
+		std::wstring value;		// With the variables replaced
+
+		bool measuresCompiled;
+		UINT symbolsVersion;
+		MeasureTemplate measures;
+	};
+
 	void SetBuiltInVariables(const std::wstring& filename, const std::wstring* resourcePath, Skin* skin);
 
 	void ReadVariables();
 
 	void ReadIniFile(const std::wstring& iniFile, LPCTSTR skinSection = nullptr, int depth = 0);
+	void ReadCachedIniFile(const std::wstring& iniFile);
+	ULONGLONG GetCacheKey(const std::wstring& iniFile);
 
 	void SetAutoSelectedMonitorVariables(Skin* skin);
 
-	bool GetSectionVariable(std::wstring& strVariable, std::wstring& strValue);
+	bool ReplaceCached(const std::wstring& source, const std::wstring& section, bool bReplaceMeasures, std::wstring& result);
+
+	void CompileMeasures(const std::wstring& str, MeasureTemplate& compiled);
+	bool RenderMeasures(const MeasureTemplate& compiled, std::wstring& result);
+
+	bool ParseSectionVariable(std::wstring strVariable, SectionVariable& variable);
+	void GetSectionVariableValue(const SectionVariable& variable, std::wstring& strValue);
+
+	const WCHAR* CheckedParseFormula(const std::wstring& formula, double* resultValue);
 
 	static void SetVariable(std::unordered_map<std::wstring, std::wstring>& variables, const std::wstring& strVariable, const std::wstring& strValue);
 	static void SetVariable(std::unordered_map<std::wstring, std::wstring>& variables, const WCHAR* strVariable, const WCHAR* strValue);
@@ -124,7 +209,7 @@ private:
 	static std::wstring StrToUpper(const WCHAR* str) { std::wstring strTmp(str); StrToUpperC(strTmp); return strTmp; }
 	static std::wstring& StrToUpperC(std::wstring& str) { _wcsupr(&str[0]); return str; }
 
-	std::unordered_map<std::wstring, Measure*> m_Measures;
+	SymbolTable m_Symbols;		// Measure and meter names
 
 	std::vector<std::wstring> m_StyleTemplate;
 
@@ -134,19 +219,36 @@ private:
 
 	std::wstring* m_CurrentSection;
 
+	UINT m_VariablesVersion;
+	UINT m_SymbolsVersion;
+	bool m_CurrentSectionUsed;
+
+	std::vector<Measure*>* m_TrackedMeasures;
+	bool m_TrackedOther;
+
+	ContentHash* m_OptionHash;		// Receives the keys and results of ReadString() if set
+
 	std::list<std::wstring> m_Sections;		// Ordered section
 	std::unordered_map<std::wstring, std::wstring> m_Values;
 
+	std::unordered_map<std::wstring, MathParser::Program> m_Formulas;	// Compiled formula cache
+	std::unordered_map<const std::wstring*, OptionTemplate> m_OptionTemplates;	// Keyed by the value in m_Values
+	std::wstring m_SectionVariableValue;	// buffer
+
 	std::unordered_set<std::wstring> m_FoundSections;
 	std::list<std::wstring> m_ListVariables;
 	std::list<std::wstring>::const_iterator m_SectionInsertPos;
 
+	std::vector<SkinCache::File>* m_TrackedFiles;	// Receives the files read by ReadIniFile() if set
+	bool m_ReadError;
+
 	std::unordered_map<std::wstring, std::wstring> m_BuiltInVariables;
 	std::unordered_map<std::wstring, std::wstring> m_Variables;
 
 	Skin* m_Skin;
 
 	static std::unordered_map<std::wstring, std::wstring> c_MonitorVariables;
+	static UINT c_MonitorVariablesVersion;
 };
 
 #endif
@@ -99,4 +99,70 @@ public:
 		parser.SetValue(L"A", L"String", L"#Var#");
 		Assert::AreNotEqual(parser.ReadString(L"A", L"String", L"").c_str(), L"BuiltIn");
 	}
+
+	TEST_METHOD(TestCachedReplacements)
+	{
+		ConfigParser parser;
+		parser.Initialize(L"");  // TODO: Better way to initialize without file.
+
+		parser.SetValue(L"A", L"String", L"#A#-#B#");
+		Assert::AreEqual(parser.ReadString(L"A", L"String", L"").c_str(), L"#A#-#B#");
+		Assert::IsFalse(parser.GetLastReplaced());
+
+		// New and changed variables and changed values are used on the next read.
+		parser.SetVariable(L"A", L"");
+		Assert::AreEqual(parser.ReadString(L"A", L"String", L"").c_str(), L"-#B#");
+		Assert::IsTrue(parser.GetLastReplaced());
+
+		parser.SetVariable(L"B", L"b");
+		Assert::AreEqual(parser.ReadString(L"A", L"String", L"").c_str(), L"-b");
+
+		parser.SetValue(L"A", L"String", L"#B##B#");
+		Assert::AreEqual(parser.ReadString(L"A", L"String", L"").c_str(), L"bb");
+
+		parser.SetValue(L"A", L"Escaped", L"[*Measure*]");
+		Assert::AreEqual(parser.ReadString(L"A", L"Escaped", L"").c_str(), L"[Measure]");
+		Assert::IsFalse(parser.GetLastReplaced());
+
+		// A value shared with MeterStyle is replaced for each section.
+		parser.SetValue(L"Style", L"Text", L"(#CURRENTSECTION#)");
+		parser.SetStyleTemplate(L"Style");
+		Assert::AreEqual(parser.ReadString(L"Meter1", L"Text", L"").c_str(), L"(Meter1)");
+		Assert::AreEqual(parser.ReadString(L"Meter2", L"Text", L"").c_str(), L"(Meter2)");
+		parser.ClearStyleTemplate();
+	}
+
+	TEST_METHOD(TestOptionHashing)
+	{
+		ConfigParser parser;
+		parser.Initialize(L"");  // TODO: Better way to initialize without file.
+
+		parser.SetVariable(L"Color", L"255,0,0");
+		parser.SetValue(L"A", L"FontColor", L"#Color#");
+
+		auto hashOptions = [&parser]()
+		{
+			ContentHash hash;
+			parser.StartOptionHashing(&hash);
+			parser.ReadString(L"A", L"FontColor", L"");
+			parser.ReadInt(L"A", L"FontSize", 10);
+			parser.StopOptionHashing();
+			return hash.Get();
+		};
+
+		const ULONGLONG hash1 = hashOptions();
+		Assert::AreEqual(hash1, hashOptions());
+
+		// The resolved value is hashed, not the raw option.
+		parser.SetVariable(L"Color", L"0,255,0");
+		const ULONGLONG hash2 = hashOptions();
+		Assert::AreNotEqual(hash1, hash2);
+
+		// Values read after StopOptionHashing() are not hashed.
+		ContentHash hash;
+		parser.StartOptionHashing(&hash);
+		parser.StopOptionHashing();
+		parser.ReadString(L"A", L"FontColor", L"");
+		Assert::AreEqual(ContentHash().Get(), hash.Get());
+	}
 };
@@ -0,0 +1,47 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#ifndef RM_LIBRARY_CONTENTHASH_H_
+#define RM_LIBRARY_CONTENTHASH_H_
+
+#include <Windows.h>
+#include <string>
+
+// Incremental 64-bit FNV-1a hash used to detect whether the content of a section has changed.
+class ContentHash
+{
+public:
+	ContentHash() : m_Hash(14695981039346656037ULL) {}
+
+	void Add(const void* data, size_t size)
+	{
+		const BYTE* bytes = (const BYTE*)data;
+		for (size_t i = 0; i < size; ++i)
+		{
+			m_Hash ^= bytes[i];
+			m_Hash *= 1099511628211ULL;
+		}
+	}
+
+	// The length is included so that e.g. "ab" + "c" and "a" + "bc" hash differently.
+	void Add(const WCHAR* str, size_t length)
+	{
+		Add((const void*)str, length * sizeof(WCHAR));
+		Add(&length, sizeof(length));
+	}
+
+	void Add(const std::wstring& str) { Add(str.c_str(), str.length()); }
+	void Add(double value) { Add(&value, sizeof(value)); }
+	void Add(int value) { Add(&value, sizeof(value)); }
+
+	ULONGLONG Get() const { return m_Hash; }
+
+private:
+	ULONGLONG m_Hash;
+};
+
+#endif
@@ -0,0 +1,135 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "DependencyGraph.h"
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+DependencyGraph::DependencyGraph() :
+	m_Cycle(1),
+	m_Built(false)
+{
+}
+
+DependencyGraph::~DependencyGraph()
+{
+}
+
+/*
+** Removes all edges and sets the number of nodes.
+**
+*/
+void DependencyGraph::Reset(size_t count)
+{
+	m_Nodes.clear();
+	m_Nodes.resize(count, Node());
+	m_Order.clear();
+	m_Built = false;
+}
+
+void DependencyGraph::AddEdge(size_t from, size_t to)
+{
+	if (from == to)
+	{
+		// A node that uses its own value is never in a stable state.
+		m_Nodes[to].alwaysUpdate = true;
+		m_Nodes[to].circular = true;
+		return;
+	}
+
+	m_Nodes[from].dependents.push_back(to);
+}
+
+/*
+** Sorts the nodes topologically. When several nodes are ready, the one with the lowest index is
+** taken first so that the original order is kept as far as possible. If no node is ready, the
+** remaining nodes are part of (or depend on) a circular reference. In that case, the node with
+** the lowest index is taken anyway and marked as always updated. Only the nodes below orderedCount
+** are added to the order.
+**
+*/
+void DependencyGraph::Build(size_t orderedCount)
+{
+	const size_t count = m_Nodes.size();
+
+	std::vector<size_t> inDegree(count, 0);
+	for (auto& node : m_Nodes)
+	{
+		std::sort(node.dependents.begin(), node.dependents.end());
+		node.dependents.erase(
+			std::unique(node.dependents.begin(), node.dependents.end()), node.dependents.end());
+
+		for (size_t dependent : node.dependents)
+		{
+			++inDegree[dependent];
+		}
+	}
+
+	std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> ready;
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (inDegree[i] == 0)
+		{
+			ready.push(i);
+		}
+	}
+
+	std::vector<bool> ordered(count, false);
+	size_t orderedNodes = 0;
+	size_t next = 0;  // Lowest index that might not be ordered yet
+
+	m_Order.clear();
+	m_Order.reserve(min(orderedCount, count));
+	while (orderedNodes < count)
+	{
+		size_t i;
+		if (!ready.empty())
+		{
+			i = ready.top();
+			ready.pop();
+			if (ordered[i]) continue;
+		}
+		else
+		{
+			while (ordered[next]) ++next;
+			i = next;
+			m_Nodes[i].alwaysUpdate = true;
+			m_Nodes[i].circular = true;
+		}
+
+		ordered[i] = true;
+		++orderedNodes;
+		if (i < orderedCount)
+		{
+			m_Order.push_back(i);
+		}
+
+		for (size_t dependent : m_Nodes[i].dependents)
+		{
+			if (--inDegree[dependent] == 0)
+			{
+				ready.push(dependent);
+			}
+		}
+	}
+
+	m_Built = true;
+}
+
+/*
+** Marks the dependents of the given node to be updated in the current update cycle.
+**
+*/
+void DependencyGraph::SetChanged(size_t node)
+{
+	for (size_t dependent : m_Nodes[node].dependents)
+	{
+		m_Nodes[dependent].dirtyCycle = m_Cycle;
+	}
+}
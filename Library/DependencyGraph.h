@@ -0,0 +1,66 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#ifndef RM_LIBRARY_DEPENDENCYGRAPH_H_
+#define RM_LIBRARY_DEPENDENCYGRAPH_H_
+
+#include <vector>
+
+// Directed graph of the sections of a skin. An edge from A to B means that B uses the value of A.
+// Nodes are identified by their index. After Build(), GetOrder() returns the nodes so that each
+// node comes after the nodes it depends on. Ties (and nodes that cannot be ordered due to
+// circular references) keep the order in which the nodes were added. The order can be limited to
+// the first nodes (e.g. the measures of a skin but not its meters).
+//
+// During an update cycle, a node needs to be updated only if it is always updated or if one of
+// its dependencies has been marked as changed in the same cycle.
+class DependencyGraph
+{
+public:
+	DependencyGraph();
+	~DependencyGraph();
+
+	DependencyGraph(const DependencyGraph& other) = delete;
+	DependencyGraph& operator=(DependencyGraph other) = delete;
+
+	void Reset(size_t count);
+
+	void AddEdge(size_t from, size_t to);
+	void SetAlwaysUpdate(size_t node) { m_Nodes[node].alwaysUpdate = true; }
+
+	void Build() { Build(m_Nodes.size()); }
+	void Build(size_t orderedCount);
+	bool IsBuilt() const { return m_Built; }
+
+	size_t GetCount() const { return m_Nodes.size(); }
+	const std::vector<size_t>& GetOrder() const { return m_Order; }
+
+	bool IsAlwaysUpdated(size_t node) const { return m_Nodes[node].alwaysUpdate; }
+	bool IsCircular(size_t node) const { return m_Nodes[node].circular; }
+	bool HasDependents(size_t node) const { return !m_Nodes[node].dependents.empty(); }
+	const std::vector<size_t>& GetDependents(size_t node) const { return m_Nodes[node].dependents; }
+
+	void BeginUpdate() { ++m_Cycle; }
+	void SetChanged(size_t node);
+	bool IsDirty(size_t node) const { return m_Nodes[node].alwaysUpdate || m_Nodes[node].dirtyCycle == m_Cycle; }
+
+private:
+	struct Node
+	{
+		std::vector<size_t> dependents;
+		size_t dirtyCycle;
+		bool alwaysUpdate;
+		bool circular;
+	};
+
+	std::vector<Node> m_Nodes;
+	std::vector<size_t> m_Order;
+	size_t m_Cycle;
+	bool m_Built;
+};
+
+#endif
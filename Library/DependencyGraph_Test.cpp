@@ -0,0 +1,92 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "DependencyGraph.h"
+#include "../Common/UnitTest.h"
+
+TEST_CLASS(Library_DependencyGraph_Test)
+{
+public:
+	TEST_METHOD(TestOrder)
+	{
+		DependencyGraph graph;
+		graph.Reset(5);
+		graph.AddEdge(3, 0);  // 0 uses 3
+		graph.AddEdge(3, 0);
+		graph.AddEdge(1, 2);
+		graph.AddEdge(0, 4);
+		graph.Build();
+
+		const std::vector<size_t> expected = { 1, 2, 3, 0, 4 };
+		Assert::IsTrue(graph.GetOrder() == expected);
+		Assert::AreEqual((size_t)1, graph.GetDependents(3).size());
+		Assert::IsFalse(graph.IsCircular(0));
+		Assert::IsFalse(graph.IsAlwaysUpdated(0));
+	}
+
+	TEST_METHOD(TestCircular)
+	{
+		DependencyGraph graph;
+		graph.Reset(4);
+		graph.AddEdge(1, 2);
+		graph.AddEdge(2, 1);
+		graph.AddEdge(3, 3);
+		graph.AddEdge(2, 0);
+		graph.Build();
+
+		Assert::AreEqual((size_t)4, graph.GetOrder().size());
+		Assert::IsTrue(graph.IsCircular(3));
+		Assert::IsTrue(graph.IsAlwaysUpdated(3));
+		Assert::IsTrue(graph.IsCircular(0) || graph.IsCircular(1) || graph.IsCircular(2));
+	}
+
+	TEST_METHOD(TestCircularWithUnordered)
+	{
+		// Measures 0 and 1 use each other and meter 2 is ready first.
+		DependencyGraph graph;
+		graph.Reset(3);
+		graph.AddEdge(0, 1);
+		graph.AddEdge(1, 0);
+		graph.Build(2);
+
+		const std::vector<size_t> expected = { 0, 1 };
+		Assert::IsTrue(graph.GetOrder() == expected);
+		Assert::IsTrue(graph.IsCircular(0));
+		Assert::IsFalse(graph.IsCircular(2));
+
+		// Meters that use the measures are not ordered either.
+		graph.Reset(4);
+		graph.AddEdge(1, 0);
+		graph.AddEdge(0, 1);
+		graph.AddEdge(0, 3);
+		graph.Build(2);
+		Assert::IsTrue(graph.GetOrder() == expected);
+	}
+
+	TEST_METHOD(TestDirty)
+	{
+		DependencyGraph graph;
+		graph.Reset(4);
+		graph.AddEdge(0, 1);
+		graph.AddEdge(1, 2);
+		graph.SetAlwaysUpdate(0);
+		graph.Build();
+
+		graph.BeginUpdate();
+		Assert::IsTrue(graph.IsDirty(0));
+		Assert::IsFalse(graph.IsDirty(1));
+		graph.SetChanged(0);
+		Assert::IsTrue(graph.IsDirty(1));
+		Assert::IsFalse(graph.IsDirty(2));
+		Assert::IsFalse(graph.IsDirty(3));
+
+		// Changes are not carried over to the next update cycle.
+		graph.BeginUpdate();
+		Assert::IsFalse(graph.IsDirty(1));
+	}
+};
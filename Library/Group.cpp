@@ -9,12 +9,23 @@
 #include "Group.h"
 #include "ConfigParser.h"
 
+UINT Group::c_Version = 0;
+
+Group::~Group()
+{
+	if (!m_Groups.empty())
+	{
+		++c_Version;
+	}
+}
+
 void Group::InitializeGroup(const std::wstring& groups)
 {
 	if (wcscmp(groups.c_str(), m_OldGroups.c_str()) != 0)
 	{
 		m_OldGroups = groups;
 		m_Groups.clear();
+		++c_Version;
 
 		if (!groups.empty())
 		{
@@ -32,13 +43,13 @@ bool Group::BelongsToGroup(const std::wstring& group) const
 	return (m_Groups.find(VerifyGroup(group)) != m_Groups.end());
 }
 
-std::wstring& Group::CreateGroup(std::wstring& str) const
+std::wstring& Group::CreateGroup(std::wstring& str)
 {
 	_wcsupr(&str[0]);
 	return str;
 }
 
-std::wstring Group::VerifyGroup(const std::wstring& str) const
+std::wstring Group::VerifyGroup(const std::wstring& str)
 {
 	std::wstring strTmp;
 
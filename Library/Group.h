@@ -8,31 +8,85 @@
 #ifndef __GROUP_H__
 #define __GROUP_H__
 
+#include <Windows.h>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 class __declspec(novtable) Group
 {
 public:
-	virtual ~Group() {}
+	virtual ~Group();
 
 	Group(const Group& other) = delete;
 	Group& operator=(Group other) = delete;
 
 	bool BelongsToGroup(const std::wstring& group) const;
 
+	// The normalized (trimmed and uppercase) names of the groups.
+	const std::unordered_set<std::wstring>& GetGroups() const { return m_Groups; }
+
+	static std::wstring VerifyGroup(const std::wstring& str);
+
+	// Incremented whenever the groups of any object change or an object with groups is deleted.
+	static UINT GetVersion() { return c_Version; }
+
 protected:
 	Group() {}
 
 	void InitializeGroup(const std::wstring& groups);
 
 private:
-	std::wstring& CreateGroup(std::wstring& str) const;
-	std::wstring VerifyGroup(const std::wstring& str) const;
+	static std::wstring& CreateGroup(std::wstring& str);
 
 	std::unordered_set<std::wstring> m_Groups;
 	std::wstring m_OldGroups;
 
+	static UINT c_Version;
+};
+
+// Maps the group names to the members of each group so that a group can be processed without
+// checking every object. The index is rebuilt by the owner with Clear() and Add() when
+// IsCurrent() returns false.
+template <class T>
+class GroupIndex
+{
+public:
+	GroupIndex() : m_Version(Group::GetVersion() - 1) {}
+
+	bool IsCurrent() const { return m_Version == Group::GetVersion(); }
+
+	// Makes the index rebuild on the next lookup, e.g. when a member is added or removed without
+	// changing any groups.
+	void Invalidate() { m_Version = Group::GetVersion() - 1; }
+
+	void Clear()
+	{
+		m_Members.clear();
+		m_Version = Group::GetVersion();
+	}
+
+	// The members of each group are kept in the order they were added.
+	void Add(T* member)
+	{
+		for (const auto& group : member->GetGroups())
+		{
+			m_Members[group].push_back(member);
+		}
+	}
+
+	const std::vector<T*>& Get(const std::wstring& group) const
+	{
+		static const std::vector<T*> s_Empty;
+
+		auto iter = m_Members.find(Group::VerifyGroup(group));
+		return (iter != m_Members.end()) ? iter->second : s_Empty;
+	}
+
+private:
+	std::unordered_map<std::wstring, std::vector<T*>> m_Members;
+	UINT m_Version;
 };
 
 #endif
@@ -0,0 +1,84 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "Group.h"
+#include "../Common/UnitTest.h"
+
+namespace {
+
+class TestMember : public Group
+{
+public:
+	TestMember(const std::wstring& groups) { InitializeGroup(groups); }
+
+	void SetGroups(const std::wstring& groups) { InitializeGroup(groups); }
+};
+
+}  // namespace
+
+TEST_CLASS(Library_Group_Test)
+{
+public:
+	TEST_METHOD(TestBelongsToGroup)
+	{
+		TestMember member(L"First | second");
+		Assert::IsTrue(member.BelongsToGroup(L"FIRST"));
+		Assert::IsTrue(member.BelongsToGroup(L" Second\t"));
+		Assert::IsFalse(member.BelongsToGroup(L"Third"));
+		Assert::AreEqual((size_t)2, member.GetGroups().size());
+	}
+
+	TEST_METHOD(TestIndex)
+	{
+		TestMember a(L"Odd|All");
+		TestMember b(L"All");
+		TestMember c(L"Odd|All");
+
+		GroupIndex<TestMember> index;
+		Assert::IsFalse(index.IsCurrent());
+
+		auto build = [&]()
+		{
+			index.Clear();
+			index.Add(&a);
+			index.Add(&b);
+			index.Add(&c);
+		};
+		build();
+		Assert::IsTrue(index.IsCurrent());
+
+		const std::vector<TestMember*> all = { &a, &b, &c };
+		Assert::IsTrue(index.Get(L"all") == all);
+
+		const std::vector<TestMember*> odd = { &a, &c };
+		Assert::IsTrue(index.Get(L" ODD ") == odd);
+		Assert::IsTrue(index.Get(L"None").empty());
+
+		// Setting the same groups again does not invalidate the index.
+		b.SetGroups(L"All");
+		Assert::IsTrue(index.IsCurrent());
+
+		b.SetGroups(L"All|Odd");
+		Assert::IsFalse(index.IsCurrent());
+		build();
+		const std::vector<TestMember*> odd2 = { &a, &b, &c };
+		Assert::IsTrue(index.Get(L"Odd") == odd2);
+
+		// Deleting a member with groups invalidates the index.
+		{
+			TestMember d(L"Other");
+			build();
+		}
+		Assert::IsFalse(index.IsCurrent());
+
+		// Removing a member without deleting it is up to the owner of the index.
+		build();
+		index.Invalidate();
+		Assert::IsFalse(index.IsCurrent());
+	}
+};
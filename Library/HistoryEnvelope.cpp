@@ -0,0 +1,86 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "HistoryEnvelope.h"
+
+HistoryEnvelope::HistoryEnvelope() :
+	m_ValuesPerColumn(),
+	m_History(),
+	m_Count(),
+	m_LatestColumn()
+{
+}
+
+void HistoryEnvelope::Update(const MeasureHistory& history, size_t columns, size_t valuesPerColumn)
+{
+	if (columns == 0 || valuesPerColumn == 0)
+	{
+		m_Columns.clear();
+		m_History = nullptr;
+		return;
+	}
+
+	const UINT count = history.GetCount();
+	const long long latest = (count == 0) ? 0 : (count - 1) / valuesPerColumn;
+
+	// The values move by the difference in counts so only the columns from the one that held the
+	// latest value at the previous update need to be computed again.
+	long long first = latest - (long long)columns + 1;
+	if (&history == m_History && columns == m_Columns.size() && valuesPerColumn == m_ValuesPerColumn &&
+		count - m_Count < columns * valuesPerColumn)
+	{
+		first = max(first, m_LatestColumn);
+	}
+	else
+	{
+		m_Columns.resize(columns);
+		m_ValuesPerColumn = valuesPerColumn;
+		m_History = &history;
+	}
+
+	m_Count = count;
+	m_LatestColumn = latest;
+	for (long long column = first; column <= latest; ++column)
+	{
+		Summarize(history, column);
+	}
+}
+
+/*
+** Computes the column from the values in the history. The values before the first one and beyond
+** the capacity of the history are zero.
+**
+*/
+void HistoryEnvelope::Summarize(const MeasureHistory& history, long long column)
+{
+	const long long latestValue = (long long)m_Count - 1;
+	const long long start = column * (long long)m_ValuesPerColumn;
+	const long long end = min(start + (long long)m_ValuesPerColumn - 1, latestValue);
+
+	Column& summary = m_Columns[GetIndex(column)];
+	for (long long i = start; i <= end; ++i)
+	{
+		const size_t age = (size_t)(latestValue - i);
+		const double value = (age < history.GetCapacity()) ? history.Get(age) : 0.0;
+		if (i == start)
+		{
+			summary.first = summary.min = summary.max = value;
+		}
+		else
+		{
+			summary.min = min(summary.min, value);
+			summary.max = max(summary.max, value);
+		}
+		summary.last = value;
+	}
+
+	if (start > end)
+	{
+		summary.first = summary.last = summary.min = summary.max = 0.0;
+	}
+}
@@ -0,0 +1,60 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#ifndef RM_LIBRARY_HISTORYENVELOPE_H_
+#define RM_LIBRARY_HISTORYENVELOPE_H_
+
+#include <Windows.h>
+#include <vector>
+#include "MeasureHistory.h"
+
+// Summary of the latest values of a measure history in columns of a fixed number of values. Each
+// column keeps the first, last, minimum and maximum of its values, which is enough to draw the
+// values as a line that looks the same as drawing every value in a column one pixel wide. The
+// columns are aligned to the count of the history so that appending values changes only the
+// latest columns.
+class HistoryEnvelope
+{
+public:
+	struct Column
+	{
+		double first;		// Oldest value of the column
+		double last;
+		double min;
+		double max;
+	};
+
+	HistoryEnvelope();
+
+	size_t GetSize() const { return m_Columns.size(); }
+
+	// Brings the columns up to date with the history. Only the columns of the values appended
+	// since the previous call and the latest column are computed again unless the history, the
+	// number of columns or the number of values per column has changed.
+	void Update(const MeasureHistory& history, size_t columns, size_t valuesPerColumn);
+
+	// Returns the column age columns ago. The latest column may cover fewer values than the
+	// others. The age must be less than the size.
+	const Column& Get(size_t age) const { return m_Columns[GetIndex(m_LatestColumn - (long long)age)]; }
+
+private:
+	size_t GetIndex(long long column) const
+	{
+		const long long size = (long long)m_Columns.size();
+		return (size_t)((column % size + size) % size);
+	}
+
+	void Summarize(const MeasureHistory& history, long long column);
+
+	std::vector<Column> m_Columns;		// Indexed by the column number modulo the size
+	size_t m_ValuesPerColumn;
+	const MeasureHistory* m_History;
+	UINT m_Count;						// Count of |m_History| at the previous update
+	long long m_LatestColumn;			// Number of the column of the latest value
+};
+
+#endif
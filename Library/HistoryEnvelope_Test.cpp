@@ -0,0 +1,98 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "HistoryEnvelope.h"
+#include "../Common/UnitTest.h"
+
+TEST_CLASS(Library_HistoryEnvelope_Test)
+{
+public:
+	TEST_METHOD(TestColumns)
+	{
+		MeasureHistory history;
+		history.Reserve(8);
+
+		HistoryEnvelope envelope;
+		envelope.Update(history, 3, 2);
+		Assert::AreEqual((size_t)3, envelope.GetSize());
+		Assert::AreEqual(0.0, envelope.Get(0).max);
+
+		// The latest column holds only the latest value until it is full.
+		history.Push(5.0);
+		history.Push(1.0);
+		history.Push(3.0);
+		envelope.Update(history, 3, 2);
+		Assert::AreEqual(3.0, envelope.Get(0).first);
+		Assert::AreEqual(3.0, envelope.Get(0).min);
+		Assert::AreEqual(3.0, envelope.Get(0).max);
+		Assert::AreEqual(5.0, envelope.Get(1).first);
+		Assert::AreEqual(1.0, envelope.Get(1).last);
+		Assert::AreEqual(1.0, envelope.Get(1).min);
+		Assert::AreEqual(5.0, envelope.Get(1).max);
+		Assert::AreEqual(0.0, envelope.Get(2).max);
+
+		history.Push(4.0);
+		envelope.Update(history, 3, 2);
+		Assert::AreEqual(3.0, envelope.Get(0).first);
+		Assert::AreEqual(4.0, envelope.Get(0).last);
+		Assert::AreEqual(4.0, envelope.Get(0).max);
+		Assert::AreEqual(5.0, envelope.Get(1).max);
+
+		// A new column starts and the oldest one is dropped.
+		history.Push(-2.0);
+		envelope.Update(history, 3, 2);
+		Assert::AreEqual(-2.0, envelope.Get(0).min);
+		Assert::AreEqual(4.0, envelope.Get(1).max);
+		Assert::AreEqual(5.0, envelope.Get(2).max);
+	}
+
+	TEST_METHOD(TestUpdate)
+	{
+		MeasureHistory history;
+		history.Reserve(64);
+
+		// Compare the incremental updates against a new envelope in each step.
+		HistoryEnvelope envelope;
+		for (int tick = 0; tick < 200; ++tick)
+		{
+			history.Push(tick, (double)((tick * 37) % 23));
+			if (tick % 3 == 0)
+			{
+				// Replaces the latest value.
+				history.Push(tick, (double)(tick % 5));
+			}
+
+			if (tick % 7 != 0)
+			{
+				envelope.Update(history, 10, 3);
+			}
+
+			if (tick == 150)
+			{
+				history.Clear();
+			}
+
+			HistoryEnvelope expected;
+			expected.Update(history, 10, 3);
+			envelope.Update(history, 10, 3);
+			for (size_t age = 0; age < 10; ++age)
+			{
+				Assert::AreEqual(expected.Get(age).first, envelope.Get(age).first);
+				Assert::AreEqual(expected.Get(age).last, envelope.Get(age).last);
+				Assert::AreEqual(expected.Get(age).min, envelope.Get(age).min);
+				Assert::AreEqual(expected.Get(age).max, envelope.Get(age).max);
+			}
+		}
+
+		// Changing the layout computes all columns again.
+		envelope.Update(history, 4, 1);
+		Assert::AreEqual((size_t)4, envelope.GetSize());
+		Assert::AreEqual(history.Get(0), envelope.Get(0).max);
+		Assert::AreEqual(history.Get(3), envelope.Get(3).min);
+	}
+};
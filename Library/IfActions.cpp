@@ -10,8 +10,36 @@
 #include "IfActions.h"
 #include "Rainmeter.h"
 #include "../Common/MathParser.h"
-#include "pcre/config.h"
-#include "pcre/pcre.h"
+#include "../Common/RegExpCache.h"
+
+namespace {
+
+struct ConditionContext
+{
+	Measure& measure;
+	IfState& state;
+};
+
+bool ResolveConditionMeasure(const WCHAR* str, int len, int* slot, void* context)
+{
+	auto conditionContext = (ConditionContext*)context;
+	Measure* measure = Measure::GetCurrentMeasure(conditionContext->measure.GetSkin(), str, len);
+	if (measure)
+	{
+		*slot = (int)conditionContext->state.measures.size();
+		conditionContext->state.measures.push_back(measure);
+		return true;
+	}
+
+	return false;
+}
+
+double GetConditionMeasureValue(int slot, void* context)
+{
+	return ((IfState*)context)->measures[slot]->GetValue();
+}
+
+}  // namespace
 
 IfActions::IfActions() :
 	m_AboveValue(0.0f),
@@ -36,13 +64,13 @@ IfActions::~IfActions()
 
 void IfActions::ReadOptions(ConfigParser& parser, const WCHAR* section)
 {
-	m_AboveAction = parser.ReadString(section, L"IfAboveAction", L"", false);
+	m_AboveAction.Set(parser.ReadString(section, L"IfAboveAction", L"", false));
 	m_AboveValue = parser.ReadFloat(section, L"IfAboveValue", 0.0f);
 
-	m_BelowAction = parser.ReadString(section, L"IfBelowAction", L"", false);
+	m_BelowAction.Set(parser.ReadString(section, L"IfBelowAction", L"", false));
 	m_BelowValue = parser.ReadFloat(section, L"IfBelowValue", 0.0f);
 
-	m_EqualAction = parser.ReadString(section, L"IfEqualAction", L"", false);
+	m_EqualAction.Set(parser.ReadString(section, L"IfEqualAction", L"", false));
 	m_EqualValue = (int64_t)parser.ReadFloat(section, L"IfEqualValue", 0.0f);
 }
 
@@ -143,14 +171,14 @@ void IfActions::ReadConditionOptions(ConfigParser& parser, const WCHAR* section)
 void IfActions::DoIfActions(Measure& measure, double value)
 {
 	// IfEqual
-	if (!m_EqualAction.empty())
+	if (!m_EqualAction.IsEmpty())
 	{
 		if ((int64_t)value == m_EqualValue)
 		{
 			if (!m_EqualCommitted)
 			{
 				m_EqualCommitted = true;		// To avoid infinite loop from !Update
-				GetRainmeter().ExecuteCommand(m_EqualAction.c_str(), measure.GetSkin());
+				GetRainmeter().ExecuteAction(m_EqualAction, measure.GetSkin());
 			}
 		}
 		else
@@ -160,14 +188,14 @@ void IfActions::DoIfActions(Measure& measure, double value)
 	}
 
 	// IfAbove
-	if (!m_AboveAction.empty())
+	if (!m_AboveAction.IsEmpty())
 	{
 		if (value > m_AboveValue)
 		{
 			if (!m_AboveCommitted)
 			{
 				m_AboveCommitted = true;		// To avoid infinite loop from !Update
-				GetRainmeter().ExecuteCommand(m_AboveAction.c_str(), measure.GetSkin());
+				GetRainmeter().ExecuteAction(m_AboveAction, measure.GetSkin());
 			}
 		}
 		else
@@ -177,14 +205,14 @@ void IfActions::DoIfActions(Measure& measure, double value)
 	}
 
 	// IfBelow
-	if (!m_BelowAction.empty())
+	if (!m_BelowAction.IsEmpty())
 	{
 		if (value < m_BelowValue)
 		{
 			if (!m_BelowCommitted)
 			{
 				m_BelowCommitted = true;		// To avoid infinite loop from !Update
-				GetRainmeter().ExecuteCommand(m_BelowAction.c_str(), measure.GetSkin());
+				GetRainmeter().ExecuteAction(m_BelowAction, measure.GetSkin());
 			}
 		}
 		else
@@ -198,11 +226,24 @@ void IfActions::DoIfActions(Measure& measure, double value)
 	for (auto& item : m_Conditions)
 	{
 		++i;
-		if (!item.value.empty() && (!item.tAction.empty() || !item.fAction.empty()))
+		if (!item.value.empty() && (!item.tAction.IsEmpty() || !item.fAction.IsEmpty()))
 		{
+			const WCHAR* errMsg = nullptr;
+			if (!item.compiled)
+			{
+				ConditionContext context = { measure, item };
+				item.measures.clear();
+				errMsg = MathParser::Compile(
+					item.value.c_str(), &item.program, ResolveConditionMeasure, &context);
+				item.compiled = (errMsg == nullptr);
+			}
+
 			double result = 0.0f;
-			const WCHAR* errMsg = MathParser::Parse(
-				item.value.c_str(), &result, measure.GetCurrentMeasureValue, &measure);
+			if (errMsg == nullptr)
+			{
+				errMsg = MathParser::Evaluate(item.program, &result, GetConditionMeasureValue, &item);
+			}
+
 			if (errMsg != nullptr)
 			{
 				if (!item.parseError)
@@ -229,7 +270,7 @@ void IfActions::DoIfActions(Measure& measure, double value)
 					if (m_ConditionMode || !item.tCommitted)
 					{
 						item.tCommitted = true;
-						GetRainmeter().ExecuteCommand(item.tAction.c_str(), measure.GetSkin());
+						GetRainmeter().ExecuteAction(item.tAction, measure.GetSkin());
 					}
 				}
 				else if (result == 0.0f)	// "False"
@@ -239,7 +280,7 @@ void IfActions::DoIfActions(Measure& measure, double value)
 					if (m_ConditionMode || !item.fCommitted)
 					{
 						item.fCommitted = true;
-						GetRainmeter().ExecuteCommand(item.fAction.c_str(), measure.GetSkin());
+						GetRainmeter().ExecuteAction(item.fAction, measure.GetSkin());
 					}
 				}
 			}
@@ -251,18 +292,10 @@ void IfActions::DoIfActions(Measure& measure, double value)
 	for (auto& item : m_Matches)
 	{
 		++i;
-		if (!item.value.empty() && (!item.tAction.empty() || !item.fAction.empty()))
+		if (!item.value.empty() && (!item.tAction.IsEmpty() || !item.fAction.IsEmpty()))
 		{
 			const char* error;
-			int errorOffset;
-
-			pcre16* re = pcre16_compile(
-				(PCRE_SPTR16)item.value.c_str(),
-				PCRE_UTF16,
-				&error,
-				&errorOffset,
-				nullptr);
-
+			auto re = GetRegExpCache().Get(item.value, PCRE_UTF16, &error);
 			if (!re)
 			{
 				if (!item.parseError)
@@ -286,10 +319,8 @@ void IfActions::DoIfActions(Measure& measure, double value)
 				const WCHAR* str = measure.GetStringValue();
 				int strLen = str ? wcslen(str) : 0;
 				int ovector[300];
-				int rc = pcre16_exec(
-					re,
-					nullptr,
-					(PCRE_SPTR16)str,
+				int rc = re->Exec(
+					str,
 					(int)strLen,
 					0,
 					0,
@@ -303,7 +334,7 @@ void IfActions::DoIfActions(Measure& measure, double value)
 					if (m_MatchMode || !item.tCommitted)
 					{
 						item.tCommitted = true;
-						GetRainmeter().ExecuteCommand(item.tAction.c_str(), measure.GetSkin());
+						GetRainmeter().ExecuteAction(item.tAction, measure.GetSkin());
 					}
 				}
 				else			// Not Match
@@ -313,15 +344,37 @@ void IfActions::DoIfActions(Measure& measure, double value)
 					if (m_MatchMode || !item.fCommitted)
 					{
 						item.fCommitted = true;
-						GetRainmeter().ExecuteCommand(item.fAction.c_str(), measure.GetSkin());
+						GetRainmeter().ExecuteAction(item.fAction, measure.GetSkin());
 					}
 				}
 			}
+		}
+	}
+}
 
-			// Release memory used for the compiled pattern
-			pcre16_free(re);
+/*
+** Appends the measures referenced in the IfConditions. Returns false if the actions may need to
+** be executed even when none of the measures changes (i.e. IfConditionMode=1 or IfMatchMode=1) or
+** if a condition has not been compiled yet.
+**
+*/
+bool IfActions::GetConditionMeasures(std::vector<Measure*>& measures) const
+{
+	bool result = !(m_ConditionMode && !m_Conditions.empty()) && !(m_MatchMode && !m_Matches.empty());
+
+	for (const auto& item : m_Conditions)
+	{
+		if (item.compiled)
+		{
+			measures.insert(measures.end(), item.measures.begin(), item.measures.end());
+		}
+		else if (!item.value.empty())
+		{
+			result = false;
 		}
 	}
+
+	return result;
 }
 
 void IfActions::SetState(double& value)
@@ -11,6 +11,8 @@
 #include <windows.h>
 #include <string>
 #include <vector>
+#include "../Common/MathParser.h"
+#include "CommandHandler.h"
 
 class ConfigParser;
 class Measure;
@@ -26,24 +28,32 @@ public:
 		fAction(),
 		parseError(false),
 		tCommitted(false),
-		fCommitted(false)
+		fCommitted(false),
+		compiled(false)
 	{
 		Set(value, trueAction, falseAction);
 	}
 
 	inline void Set(std::wstring value, std::wstring trueAction, std::wstring falseAction)
 	{
+		if (value != this->value) compiled = false;
+
 		this->value = value;
-		this->tAction = trueAction;
-		this->fAction = falseAction;
+		this->tAction.Set(trueAction);
+		this->fAction.Set(falseAction);
 	}
 
 	std::wstring value;			// IfCondition/IfMatch
-	std::wstring tAction;		// IfTrueAction/IfMatchAction
-	std::wstring fAction;		// IfFalseAction/IfNotMatchAction
+	ActionProgram tAction;		// IfTrueAction/IfMatchAction
+	ActionProgram fAction;		// IfFalseAction/IfNotMatchAction
 	bool parseError;
 	bool tCommitted;
 	bool fCommitted;
+
+	// Compiled IfCondition and the measures it references
+	MathParser::Program program;
+	std::vector<Measure*> measures;
+	bool compiled;
 };
 
 class IfActions
@@ -60,14 +70,16 @@ public:
 	void DoIfActions(Measure& measure, double value);
 	void SetState(double& value);
 
+	bool GetConditionMeasures(std::vector<Measure*>& measures) const;
+
 private:
 	double m_AboveValue;
 	double m_BelowValue;
 	int64_t m_EqualValue;
 
-	std::wstring m_AboveAction;
-	std::wstring m_BelowAction;
-	std::wstring m_EqualAction;
+	ActionProgram m_AboveAction;
+	ActionProgram m_BelowAction;
+	ActionProgram m_EqualAction;
 
 	bool m_AboveCommitted;
 	bool m_BelowCommitted;
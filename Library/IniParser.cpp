@@ -0,0 +1,209 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "IniParser.h"
+#include "ContentHash.h"
+
+namespace {
+
+bool IsBlank(WCHAR ch)
+{
+	return ch == L' ' || ch == L'\t' || ch == L'\v' || ch == L'\f';
+}
+
+void Trim(const WCHAR*& start, const WCHAR*& end)
+{
+	while (start < end && IsBlank(*start)) ++start;
+	while (end > start && IsBlank(end[-1])) --end;
+}
+
+}  // namespace
+
+IniParser::IniParser()
+{
+}
+
+IniParser::~IniParser()
+{
+}
+
+/*
+** Maps the file to memory and parses it. Returns false if the file could not be read. If hash is
+** given, it receives the ContentHash of the raw file contents.
+**
+*/
+bool IniParser::ReadFile(const WCHAR* path, ULONGLONG* hash)
+{
+	m_Text.clear();
+	m_Sections.clear();
+
+	HANDLE file = CreateFile(
+		path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	bool result = false;
+
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(file, &size) && size.HighPart == 0)
+	{
+		if (size.LowPart == 0)
+		{
+			// Empty files cannot be mapped.
+			if (hash) *hash = ContentHash().Get();
+			result = true;
+		}
+		else if (HANDLE mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr))
+		{
+			if (const BYTE* data = (const BYTE*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0))
+			{
+				if (hash)
+				{
+					ContentHash contentHash;
+					contentHash.Add(data, size.LowPart);
+					*hash = contentHash.Get();
+				}
+
+				result = Parse(data, size.LowPart);
+				UnmapViewOfFile(data);
+			}
+
+			CloseHandle(mapping);
+		}
+	}
+
+	CloseHandle(file);
+	return result;
+}
+
+/*
+** Parses the contents of an INI file. Returns false if the text could not be decoded.
+**
+*/
+bool IniParser::Parse(const BYTE* data, size_t size)
+{
+	m_Text.clear();
+	m_Sections.clear();
+
+	if (!Decode(data, size)) return false;
+
+	ParseText();
+	return true;
+}
+
+/*
+** Returns the first section with the given name (case-insensitive) or nullptr if not found.
+**
+*/
+const IniParser::Section* IniParser::FindSection(const WCHAR* name) const
+{
+	const size_t length = wcslen(name);
+	for (auto iter = m_Sections.cbegin(); iter != m_Sections.cend(); ++iter)
+	{
+		if (iter->nameLength == length && _wcsnicmp(iter->name, name, length) == 0)
+		{
+			return &(*iter);
+		}
+	}
+
+	return nullptr;
+}
+
+bool IniParser::Decode(const BYTE* data, size_t size)
+{
+	if (size >= 2 && ((data[0] == 0xFF && data[1] == 0xFE) || (data[0] == 0xFE && data[1] == 0xFF)))
+	{
+		// UTF-16LE or UTF-16BE.
+		const int low = (data[0] == 0xFF) ? 0 : 1;
+		const size_t length = (size - 2) / 2;
+		m_Text.resize(length);
+
+		const BYTE* chars = data + 2;
+		for (size_t i = 0; i < length; ++i, chars += 2)
+		{
+			m_Text[i] = (WCHAR)(chars[low] | (chars[1 - low] << 8));
+		}
+		return true;
+	}
+
+	UINT codePage = CP_ACP;
+	if (size >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF)
+	{
+		codePage = CP_UTF8;
+		data += 3;
+		size -= 3;
+	}
+
+	if (size == 0) return true;
+	if (size > INT_MAX) return false;
+
+	const int length = MultiByteToWideChar(codePage, 0, (LPCSTR)data, (int)size, nullptr, 0);
+	if (length <= 0) return false;
+
+	m_Text.resize(length);
+	MultiByteToWideChar(codePage, 0, (LPCSTR)data, (int)size, &m_Text[0], length);
+	return true;
+}
+
+void IniParser::ParseText()
+{
+	const WCHAR* pos = m_Text.c_str();
+	const WCHAR* const textEnd = pos + m_Text.length();
+
+	Section* section = nullptr;
+
+	while (pos < textEnd)
+	{
+		// Find the end of the line. A NUL character also ends the line like with the profile
+		// functions.
+		const WCHAR* lineEnd = pos;
+		while (lineEnd < textEnd && *lineEnd != L'\n' && *lineEnd != L'\r' && *lineEnd != L'\0') ++lineEnd;
+
+		const WCHAR* start = pos;
+		const WCHAR* end = lineEnd;
+
+		pos = lineEnd;
+		while (pos < textEnd && (*pos == L'\n' || *pos == L'\r' || *pos == L'\0')) ++pos;
+
+		Trim(start, end);
+		if (start == end) continue;
+
+		if (*start == L'[')
+		{
+			// The section name ends at the last ']' on the line.
+			const WCHAR* nameEnd = end;
+			while (nameEnd > start && nameEnd[-1] != L']') --nameEnd;
+			if (nameEnd > start + 1)
+			{
+				const WCHAR* nameStart = start + 1;
+				--nameEnd;
+				Trim(nameStart, nameEnd);
+
+				m_Sections.emplace_back();
+				section = &m_Sections.back();
+				section->name = nameStart;
+				section->nameLength = nameEnd - nameStart;
+				continue;
+			}
+		}
+
+		// Keys before the first section and comments are ignored.
+		if (!section || *start == L';') continue;
+
+		const WCHAR* sep = wmemchr(start, L'=', end - start);
+		if (!sep) continue;
+
+		const WCHAR* nameEnd = sep;
+		const WCHAR* valueStart = sep + 1;
+		Trim(start, nameEnd);
+		Trim(valueStart, end);
+
+		Key key = { start, (size_t)(nameEnd - start), valueStart, (size_t)(end - valueStart) };
+		section->keys.push_back(key);
+	}
+}
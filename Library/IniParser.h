@@ -0,0 +1,61 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#ifndef RM_LIBRARY_INIPARSER_H_
+#define RM_LIBRARY_INIPARSER_H_
+
+#include <Windows.h>
+#include <string>
+#include <vector>
+
+// Parses an INI file in one pass the same way as GetPrivateProfileSectionNames() and
+// GetPrivateProfileSection() do: whitespace around section names, keys and values is trimmed,
+// lines starting with ';' are comments, and lines without '=' are ignored. Sections with the same
+// name are all listed but FindSection() returns the first one, like the profile functions.
+//
+// The file is decoded as UTF-16LE or UTF-16BE (with BOM), UTF-8 (with BOM), or in the ANSI
+// code page. The names and values point to the decoded text and are valid until the next call to
+// Parse() or ReadFile().
+class IniParser
+{
+public:
+	struct Key
+	{
+		const WCHAR* name;
+		size_t nameLength;
+		const WCHAR* value;
+		size_t valueLength;
+	};
+
+	struct Section
+	{
+		const WCHAR* name;
+		size_t nameLength;
+		std::vector<Key> keys;
+	};
+
+	IniParser();
+	~IniParser();
+
+	IniParser(const IniParser& other) = delete;
+	IniParser& operator=(IniParser other) = delete;
+
+	bool ReadFile(const WCHAR* path, ULONGLONG* hash = nullptr);
+	bool Parse(const BYTE* data, size_t size);
+
+	const std::vector<Section>& GetSections() const { return m_Sections; }
+	const Section* FindSection(const WCHAR* name) const;
+
+private:
+	bool Decode(const BYTE* data, size_t size);
+	void ParseText();
+
+	std::wstring m_Text;
+	std::vector<Section> m_Sections;
+};
+
+#endif
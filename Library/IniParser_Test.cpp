@@ -0,0 +1,96 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "IniParser.h"
+#include "../Common/UnitTest.h"
+
+namespace {
+
+std::wstring GetName(const IniParser::Section& section)
+{
+	return std::wstring(section.name, section.nameLength);
+}
+
+std::wstring GetKey(const IniParser::Section& section, size_t index)
+{
+	const IniParser::Key& key = section.keys[index];
+	return std::wstring(key.name, key.nameLength) + L'=' + std::wstring(key.value, key.valueLength);
+}
+
+}  // namespace
+
+TEST_CLASS(Library_IniParser_Test)
+{
+public:
+	TEST_METHOD(TestParse)
+	{
+		const char text[] =
+			"Ignored=1\r\n"
+			"[Rainmeter]\r\n"
+			"Update = 1000 \r\n"
+			"  ; Comment=1\r\n"
+			"NoValue\r\n"
+			"=NoKey\n"
+			"\t[ Meter ] trailing\n"
+			"Text=a=b\r"
+			"Empty=\r\n"
+			"[Rainmeter]\r\n"
+			"Update=500\r\n"
+			"[Broken\r\n"
+			"Last=\"quoted\"";
+
+		IniParser ini;
+		Assert::IsTrue(ini.Parse((const BYTE*)text, sizeof(text) - 1));
+
+		const auto& sections = ini.GetSections();
+		Assert::AreEqual((size_t)3, sections.size());
+		Assert::AreEqual(L"Rainmeter", GetName(sections[0]).c_str());
+		Assert::AreEqual(L"Meter", GetName(sections[1]).c_str());
+		Assert::AreEqual(L"Rainmeter", GetName(sections[2]).c_str());
+
+		Assert::AreEqual((size_t)2, sections[0].keys.size());
+		Assert::AreEqual(L"Update=1000", GetKey(sections[0], 0).c_str());
+		Assert::AreEqual(L"=NoKey", GetKey(sections[0], 1).c_str());
+
+		Assert::AreEqual((size_t)2, sections[1].keys.size());
+		Assert::AreEqual(L"Text=a=b", GetKey(sections[1], 0).c_str());
+		Assert::AreEqual(L"Empty=", GetKey(sections[1], 1).c_str());
+
+		Assert::AreEqual((size_t)2, sections[2].keys.size());
+		Assert::AreEqual(L"Last=\"quoted\"", GetKey(sections[2], 1).c_str());
+
+		// The first section with the name is found.
+		Assert::IsTrue(ini.FindSection(L"RAINMETER") == &sections[0]);
+		Assert::IsTrue(ini.FindSection(L"meter") == &sections[1]);
+		Assert::IsTrue(ini.FindSection(L"Missing") == nullptr);
+	}
+
+	TEST_METHOD(TestEncodings)
+	{
+		const BYTE utf16le[] = { 0xFF, 0xFE, '[', 0, 'A', 0, ']', 0, '\n', 0, 'K', 0, '=', 0, 0xE9, 0, 0x3B, 0xD8, 0x00, 0xDE };
+		const BYTE utf16be[] = { 0xFE, 0xFF, 0, '[', 0, 'A', 0, ']', 0, '\n', 0, 'K', 0, '=', 0, 0xE9, 0xD8, 0x3B, 0xDE, 0x00 };
+		const BYTE utf8[] = { 0xEF, 0xBB, 0xBF, '[', 'A', ']', '\n', 'K', '=', 0xC3, 0xA9, 0xF0, 0x9E, 0xB8, 0x80 };
+		const std::wstring expected = L"K=é\xD83B\xDE00";
+
+		const BYTE* texts[] = { utf16le, utf16be, utf8 };
+		const size_t sizes[] = { sizeof(utf16le), sizeof(utf16be), sizeof(utf8) };
+		for (int i = 0; i < 3; ++i)
+		{
+			IniParser ini;
+			Assert::IsTrue(ini.Parse(texts[i], sizes[i]));
+			const IniParser::Section* section = ini.FindSection(L"A");
+			Assert::IsNotNull(section);
+			Assert::AreEqual((size_t)1, section->keys.size());
+			Assert::AreEqual(expected.c_str(), GetKey(*section, 0).c_str());
+		}
+
+		IniParser ini;
+		Assert::IsTrue(ini.Parse(nullptr, 0));
+		Assert::IsTrue(ini.GetSections().empty());
+	}
+};
@@ -0,0 +1,185 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "LogLimiter.h"
+#include "ContentHash.h"
+
+namespace {
+
+const int LEVEL_WARNING = 2;
+
+}  // namespace
+
+LogLimiter::LogLimiter() :
+	m_RepeatInterval(DEFAULT_REPEAT_INTERVAL),
+	m_Rate(DEFAULT_RATE),
+	m_Burst(DEFAULT_BURST),
+	m_NextFlush(0ULL)
+{
+}
+
+void LogLimiter::SetRepeatInterval(ULONGLONG interval)
+{
+	m_RepeatInterval = interval;
+}
+
+void LogLimiter::SetRate(UINT rate, UINT burst)
+{
+	m_Rate = rate;
+	m_Burst = max(burst, 1U);
+}
+
+bool LogLimiter::Check(int level, const WCHAR* source, const WCHAR* message, ULONGLONG now, std::vector<Record>& records)
+{
+	if (now >= m_NextFlush)
+	{
+		Flush(now, records);
+	}
+
+	ContentHash sourceHash;
+	sourceHash.Add(source, wcslen(source));
+
+	if (m_RepeatInterval > 0)
+	{
+		ContentHash hash = sourceHash;
+		hash.Add(message, wcslen(message));
+
+		auto iter = m_Repeats.find(hash.Get());
+		if (iter != m_Repeats.end())
+		{
+			Repeat& repeat = iter->second;
+			if (now < repeat.end)
+			{
+				++repeat.count;
+				return false;
+			}
+
+			// The interval has passed but the flush has not run yet.
+			AddRepeatRecord(repeat, records);
+			repeat.count = 0;
+			repeat.end = now + m_RepeatInterval;
+		}
+		else if (m_Repeats.size() < MAX_REPEATS)
+		{
+			Repeat repeat = {level, source, message, 0, now + m_RepeatInterval};
+			m_Repeats.emplace(hash.Get(), std::move(repeat));
+		}
+	}
+
+	if (m_Rate > 0)
+	{
+		auto iter = m_Buckets.find(sourceHash.Get());
+		if (iter == m_Buckets.end())
+		{
+			Bucket bucket = {source, (double)m_Burst, now, 0};
+			iter = m_Buckets.emplace(sourceHash.Get(), std::move(bucket)).first;
+		}
+
+		Bucket& bucket = iter->second;
+		Refill(bucket, now);
+		if (bucket.tokens < 1.0)
+		{
+			++bucket.dropped;
+			return false;
+		}
+
+		bucket.tokens -= 1.0;
+		AddDroppedRecord(bucket, records);
+	}
+
+	return true;
+}
+
+void LogLimiter::Flush(ULONGLONG now, std::vector<Record>& records)
+{
+	m_NextFlush = now + FLUSH_INTERVAL;
+
+	for (auto iter = m_Repeats.begin(); iter != m_Repeats.end(); )
+	{
+		if (now >= iter->second.end)
+		{
+			AddRepeatRecord(iter->second, records);
+			iter = m_Repeats.erase(iter);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+
+	for (auto iter = m_Buckets.begin(); iter != m_Buckets.end(); )
+	{
+		Bucket& bucket = iter->second;
+		Refill(bucket, now);
+		if (bucket.dropped > 0 && bucket.tokens >= 1.0)
+		{
+			AddDroppedRecord(bucket, records);
+		}
+
+		// Full buckets behave like new ones, so they need not be kept.
+		if (bucket.dropped == 0 && bucket.tokens >= (double)m_Burst)
+		{
+			iter = m_Buckets.erase(iter);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+}
+
+void LogLimiter::FlushAll(std::vector<Record>& records)
+{
+	for (const auto& repeat : m_Repeats)
+	{
+		AddRepeatRecord(repeat.second, records);
+	}
+
+	for (auto& bucket : m_Buckets)
+	{
+		AddDroppedRecord(bucket.second, records);
+	}
+
+	m_Repeats.clear();
+	m_Buckets.clear();
+}
+
+void LogLimiter::Refill(Bucket& bucket, ULONGLONG now)
+{
+	if (now > bucket.time)
+	{
+		bucket.tokens += (double)(now - bucket.time) * m_Rate / 1000.0;
+		bucket.tokens = min(bucket.tokens, (double)m_Burst);
+		bucket.time = now;
+	}
+}
+
+void LogLimiter::AddRepeatRecord(const Repeat& repeat, std::vector<Record>& records)
+{
+	if (repeat.count == 0) return;
+
+	Record record = {repeat.level, repeat.source};
+	record.message = L"Repeated ";
+	record.message += std::to_wstring(repeat.count);
+	record.message += (repeat.count == 1) ? L" more time: " : L" more times: ";
+	record.message += repeat.message;
+	records.push_back(std::move(record));
+}
+
+void LogLimiter::AddDroppedRecord(Bucket& bucket, std::vector<Record>& records)
+{
+	if (bucket.dropped == 0) return;
+
+	Record record = {LEVEL_WARNING, bucket.source};
+	record.message = L"Suppressed ";
+	record.message += std::to_wstring(bucket.dropped);
+	record.message += (bucket.dropped == 1) ? L" message" : L" messages";
+	records.push_back(std::move(record));
+
+	bucket.dropped = 0;
+}
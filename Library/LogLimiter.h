@@ -0,0 +1,101 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#ifndef RM_LIBRARY_LOGLIMITER_H_
+#define RM_LIBRARY_LOGLIMITER_H_
+
+#include <Windows.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Decides which log messages are actually logged so that a skin logging the same error on every
+// update cannot flood the log.
+//
+// A message that is logged again by the same source within the repeat interval is only counted.
+// When the interval has passed, a single record with the count is logged instead. In addition,
+// each source has a token bucket that allows |burst| messages at once and |rate| messages per
+// second on average. Messages beyond that are dropped and reported as a count later.
+//
+// Not thread-safe. Times are in milliseconds, e.g. from GetTickCount64().
+class LogLimiter
+{
+public:
+	// A summary of suppressed messages to be logged.
+	struct Record
+	{
+		int level;
+		std::wstring source;
+		std::wstring message;
+	};
+
+	LogLimiter();
+
+	LogLimiter(const LogLimiter& other) = delete;
+	LogLimiter& operator=(LogLimiter other) = delete;
+
+	// Zero disables the collapsing of repeated messages.
+	void SetRepeatInterval(ULONGLONG interval);
+
+	// Zero rate disables the rate limit.
+	void SetRate(UINT rate, UINT burst);
+
+	// Returns true if the message should be logged. Summaries that are due are appended to
+	// |records| and should be logged first.
+	bool Check(int level, const WCHAR* source, const WCHAR* message, ULONGLONG now, std::vector<Record>& records);
+
+	// Appends the summaries that are due to |records|. Should be called about every
+	// FLUSH_INTERVAL even if nothing is logged.
+	void Flush(ULONGLONG now, std::vector<Record>& records);
+
+	// Appends the summaries of all messages counted so far to |records|, e.g. on exit.
+	void FlushAll(std::vector<Record>& records);
+
+	size_t GetRepeatCount() const { return m_Repeats.size(); }
+	size_t GetBucketCount() const { return m_Buckets.size(); }
+
+	static const ULONGLONG DEFAULT_REPEAT_INTERVAL = 10000;
+	static const UINT DEFAULT_RATE = 20;
+	static const UINT DEFAULT_BURST = 100;
+
+	// Messages beyond this many distinct ones per interval are not checked for repeats.
+	static const size_t MAX_REPEATS = 1024;
+
+	static const ULONGLONG FLUSH_INTERVAL = 1000;
+
+private:
+	struct Repeat
+	{
+		int level;
+		std::wstring source;
+		std::wstring message;
+		UINT count;
+		ULONGLONG end;
+	};
+
+	struct Bucket
+	{
+		std::wstring source;
+		double tokens;
+		ULONGLONG time;
+		UINT dropped;
+	};
+
+	void Refill(Bucket& bucket, ULONGLONG now);
+	void AddRepeatRecord(const Repeat& repeat, std::vector<Record>& records);
+	void AddDroppedRecord(Bucket& bucket, std::vector<Record>& records);
+
+	std::unordered_map<ULONGLONG, Repeat> m_Repeats;
+	std::unordered_map<ULONGLONG, Bucket> m_Buckets;
+
+	ULONGLONG m_RepeatInterval;
+	UINT m_Rate;
+	UINT m_Burst;
+	ULONGLONG m_NextFlush;
+};
+
+#endif
@@ -0,0 +1,137 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "LogLimiter.h"
+#include "../Common/UnitTest.h"
+
+TEST_CLASS(Library_LogLimiter_Test)
+{
+public:
+	TEST_METHOD(TestRepeat)
+	{
+		LogLimiter limiter;
+		limiter.SetRepeatInterval(10000ULL);
+		limiter.SetRate(0, 0);
+
+		std::vector<LogLimiter::Record> records;
+		Assert::IsTrue(limiter.Check(1, L"A", L"Error", 0ULL, records));
+		Assert::IsTrue(limiter.Check(1, L"B", L"Error", 0ULL, records));
+		Assert::IsTrue(limiter.Check(1, L"A", L"Other", 0ULL, records));
+		for (ULONGLONG time = 1000ULL; time < 10000ULL; time += 1000ULL)
+		{
+			Assert::IsFalse(limiter.Check(1, L"A", L"Error", time, records));
+		}
+		Assert::IsTrue(records.empty());
+
+		// The count is reported once the interval has passed and the message is logged again.
+		Assert::IsTrue(limiter.Check(1, L"A", L"Error", 10000ULL, records));
+		Assert::AreEqual((size_t)1, records.size());
+		Assert::AreEqual(1, records[0].level);
+		Assert::AreEqual(std::wstring(L"A"), records[0].source);
+		Assert::AreEqual(std::wstring(L"Repeated 9 more times: Error"), records[0].message);
+
+		// Messages that were not repeated are forgotten without a record.
+		records.clear();
+		limiter.Flush(20000ULL, records);
+		Assert::IsTrue(records.empty());
+		Assert::AreEqual((size_t)0, limiter.GetRepeatCount());
+
+		limiter.SetRepeatInterval(0ULL);
+		Assert::IsTrue(limiter.Check(1, L"A", L"Error", 20000ULL, records));
+		Assert::IsTrue(limiter.Check(1, L"A", L"Error", 20000ULL, records));
+	}
+
+	TEST_METHOD(TestRepeatFlush)
+	{
+		LogLimiter limiter;
+		limiter.SetRepeatInterval(10000ULL);
+		limiter.SetRate(0, 0);
+
+		std::vector<LogLimiter::Record> records;
+		Assert::IsTrue(limiter.Check(1, L"A", L"Error", 0ULL, records));
+		Assert::IsFalse(limiter.Check(1, L"A", L"Error", 500ULL, records));
+
+		// Reported by the next check of another message after the interval.
+		Assert::IsTrue(limiter.Check(3, L"B", L"Notice", 12000ULL, records));
+		Assert::AreEqual((size_t)1, records.size());
+		Assert::AreEqual(std::wstring(L"Repeated 1 more time: Error"), records[0].message);
+		Assert::AreEqual((size_t)1, limiter.GetRepeatCount());
+	}
+
+	TEST_METHOD(TestFlushAll)
+	{
+		LogLimiter limiter;
+		limiter.SetRepeatInterval(10000ULL);
+		limiter.SetRate(1, 1);
+
+		std::vector<LogLimiter::Record> records;
+		Assert::IsTrue(limiter.Check(1, L"A", L"Error", 0ULL, records));
+		Assert::IsFalse(limiter.Check(1, L"A", L"Error", 100ULL, records));
+		Assert::IsFalse(limiter.Check(1, L"A", L"Other", 200ULL, records));
+		Assert::IsTrue(records.empty());
+
+		// Nothing is due yet, but everything counted is reported.
+		limiter.FlushAll(records);
+		Assert::AreEqual((size_t)2, records.size());
+		Assert::AreEqual(std::wstring(L"Repeated 1 more time: Error"), records[0].message);
+		Assert::AreEqual(std::wstring(L"Suppressed 1 message"), records[1].message);
+		Assert::AreEqual((size_t)0, limiter.GetRepeatCount());
+		Assert::AreEqual((size_t)0, limiter.GetBucketCount());
+	}
+
+	TEST_METHOD(TestRate)
+	{
+		LogLimiter limiter;
+		limiter.SetRepeatInterval(0ULL);
+		limiter.SetRate(2, 4);
+
+		std::vector<LogLimiter::Record> records;
+		for (int i = 0; i < 4; ++i)
+		{
+			Assert::IsTrue(limiter.Check(1, L"A", std::to_wstring(i).c_str(), 0ULL, records));
+		}
+		Assert::IsFalse(limiter.Check(1, L"A", L"4", 0ULL, records));
+		Assert::IsFalse(limiter.Check(1, L"A", L"5", 100ULL, records));
+
+		// Each source has its own bucket.
+		Assert::IsTrue(limiter.Check(1, L"B", L"0", 100ULL, records));
+		Assert::IsTrue(records.empty());
+
+		// One token is back after 500 ms.
+		Assert::IsTrue(limiter.Check(1, L"A", L"6", 500ULL, records));
+		Assert::AreEqual((size_t)1, records.size());
+		Assert::AreEqual(2, records[0].level);
+		Assert::AreEqual(std::wstring(L"A"), records[0].source);
+		Assert::AreEqual(std::wstring(L"Suppressed 2 messages"), records[0].message);
+		Assert::IsFalse(limiter.Check(1, L"A", L"7", 600ULL, records));
+
+		// Dropped messages are also reported by a flush, and full buckets are removed.
+		records.clear();
+		limiter.Flush(10000ULL, records);
+		Assert::AreEqual((size_t)1, records.size());
+		Assert::AreEqual(std::wstring(L"Suppressed 1 message"), records[0].message);
+		Assert::AreEqual((size_t)0, limiter.GetBucketCount());
+	}
+
+	TEST_METHOD(TestRepeatDoesNotUseTokens)
+	{
+		LogLimiter limiter;
+		limiter.SetRepeatInterval(10000ULL);
+		limiter.SetRate(1, 2);
+
+		std::vector<LogLimiter::Record> records;
+		Assert::IsTrue(limiter.Check(1, L"A", L"Error", 0ULL, records));
+		for (int i = 0; i < 100; ++i)
+		{
+			Assert::IsFalse(limiter.Check(1, L"A", L"Error", 0ULL, records));
+		}
+		Assert::IsTrue(limiter.Check(1, L"A", L"Other", 0ULL, records));
+		Assert::IsFalse(limiter.Check(1, L"A", L"Third", 0ULL, records));
+		Assert::IsTrue(records.empty());
+	}
+};
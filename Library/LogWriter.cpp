@@ -0,0 +1,215 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "LogWriter.h"
+
+LogWriter::LogWriter() :
+	m_Head(&m_Stub),
+	m_Tail(&m_Stub),
+	m_Queued(),
+	m_File(INVALID_HANDLE_VALUE),
+	m_Thread(),
+	m_WakeEvent(CreateEvent(nullptr, FALSE, FALSE, nullptr)),
+	m_Open(false),
+	m_Stop(false),
+	m_FileDeleted(false)
+{
+}
+
+LogWriter::~LogWriter()
+{
+	Close();
+
+	while (Node* node = Pop())
+	{
+		delete node;
+	}
+
+	CloseHandle(m_WakeEvent);
+}
+
+bool LogWriter::Open(const std::wstring& path)
+{
+	Close();
+
+	m_File = CreateFile(
+		path.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_File == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	m_Path = path;
+	m_Buffer.clear();
+
+	// Start a new file with a byte order mark.
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(m_File, &size) && size.QuadPart == 0)
+	{
+		m_Buffer = "\xEF\xBB\xBF";
+	}
+
+	m_Stop = false;
+	m_FileDeleted = false;
+	m_Thread = (HANDLE)_beginthreadex(nullptr, 0, WriterThreadProc, this, 0, nullptr);
+	if (!m_Thread)
+	{
+		CloseHandle(m_File);
+		m_File = INVALID_HANDLE_VALUE;
+		return false;
+	}
+
+	m_Open = true;
+	return true;
+}
+
+void LogWriter::Close()
+{
+	if (!m_Open) return;
+
+	m_Open = false;
+	m_Stop = true;
+	SetEvent(m_WakeEvent);
+
+	WaitForSingleObject(m_Thread, INFINITE);
+	CloseHandle(m_Thread);
+	m_Thread = nullptr;
+
+	if (m_File != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_File);
+		m_File = INVALID_HANDLE_VALUE;
+	}
+}
+
+void LogWriter::Write(std::wstring line)
+{
+	if (!m_Open) return;
+
+	Node* node = new Node();
+	node->line = std::move(line);
+	Push(node);
+
+	// The writer wakes up periodically anyway, so it is woken early only if a lot is waiting.
+	if (InterlockedIncrement(&m_Queued) == WAKE_COUNT)
+	{
+		SetEvent(m_WakeEvent);
+	}
+}
+
+unsigned __stdcall LogWriter::WriterThreadProc(void* param)
+{
+	((LogWriter*)param)->RunWriter();
+	return 0;
+}
+
+void LogWriter::RunWriter()
+{
+	while (true)
+	{
+		// Read the flag first so that the lines queued before Close() are written.
+		const bool stop = m_Stop;
+
+		WriteQueued();
+
+		if (stop) break;
+
+		WaitForSingleObject(m_WakeEvent, FLUSH_INTERVAL);
+	}
+}
+
+void LogWriter::WriteQueued()
+{
+	InterlockedExchange(&m_Queued, 0);
+
+	while (Node* node = Pop())
+	{
+		const std::wstring& line = node->line;
+		const int length = WideCharToMultiByte(CP_UTF8, 0, line.c_str(), (int)line.length(), nullptr, 0, nullptr, nullptr);
+		if (length > 0)
+		{
+			const size_t pos = m_Buffer.size();
+			m_Buffer.resize(pos + length);
+			WideCharToMultiByte(CP_UTF8, 0, line.c_str(), (int)line.length(), &m_Buffer[pos], length, nullptr, nullptr);
+		}
+		m_Buffer += "\r\n";
+
+		delete node;
+	}
+
+	if (m_File == INVALID_HANDLE_VALUE)
+	{
+		m_Buffer.clear();
+		return;
+	}
+
+	if (m_Buffer.empty()) return;
+
+	if (_waccess(m_Path.c_str(), 0) == -1)
+	{
+		// The file has been deleted manually.
+		CloseHandle(m_File);
+		m_File = INVALID_HANDLE_VALUE;
+		m_FileDeleted = true;
+	}
+	else
+	{
+		DWORD written;
+		WriteFile(m_File, m_Buffer.data(), (DWORD)m_Buffer.size(), &written, nullptr);
+	}
+
+	m_Buffer.clear();
+}
+
+void LogWriter::Push(Node* node)
+{
+	node->next = nullptr;
+	Node* prev = (Node*)InterlockedExchangePointer((PVOID volatile*)&m_Head, node);
+	prev->next = node;
+}
+
+/*
+** Called only by the consumer. Returns nullptr if the queue is empty or if the next node is being
+** pushed at the moment. In the latter case it is popped the next time.
+**
+*/
+LogWriter::Node* LogWriter::Pop()
+{
+	Node* tail = m_Tail;
+	Node* next = tail->next;
+
+	if (tail == &m_Stub)
+	{
+		if (!next) return nullptr;
+
+		m_Tail = next;
+		tail = next;
+		next = next->next;
+	}
+
+	if (next)
+	{
+		m_Tail = next;
+		return tail;
+	}
+
+	if (tail != m_Head) return nullptr;
+
+	// Put the stub back so that the last node can be popped.
+	Push(&m_Stub);
+
+	next = tail->next;
+	if (next)
+	{
+		m_Tail = next;
+		return tail;
+	}
+
+	return nullptr;
+}
@@ -0,0 +1,79 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#ifndef RM_LIBRARY_LOGWRITER_H_
+#define RM_LIBRARY_LOGWRITER_H_
+
+#include <Windows.h>
+#include <string>
+
+// Appends lines to a UTF-8 log file on a background thread. Write() only queues the line, so it
+// is cheap and can be called from any thread without taking a lock. The writer thread keeps the
+// file open and writes the queued lines in one go every FLUSH_INTERVAL milliseconds, or sooner
+// if many lines are waiting.
+//
+// The file is opened with FILE_SHARE_DELETE so that it can still be deleted manually. After that,
+// the queued lines are discarded and IsFileDeleted() returns true.
+class LogWriter
+{
+public:
+	LogWriter();
+	~LogWriter();
+
+	LogWriter(const LogWriter& other) = delete;
+	LogWriter& operator=(LogWriter other) = delete;
+
+	// Opens an existing file. Open() and Close() must not be called concurrently.
+	bool Open(const std::wstring& path);
+
+	// Writes the queued lines and closes the file.
+	void Close();
+
+	bool IsOpen() const { return m_Open; }
+	bool IsFileDeleted() const { return m_FileDeleted; }
+
+	// Queues a line. The line break is added by the writer.
+	void Write(std::wstring line);
+
+	static const DWORD FLUSH_INTERVAL = 1000;
+	static const LONG WAKE_COUNT = 512;
+
+private:
+	// Lines are queued in a linked list that producers append to with an atomic exchange and the
+	// writer thread consumes from the other end.
+	struct Node
+	{
+		Node* volatile next;
+		std::wstring line;
+
+		Node() : next() {}
+	};
+
+	static unsigned __stdcall WriterThreadProc(void* param);
+
+	void RunWriter();
+	void Push(Node* node);
+	Node* Pop();
+	void WriteQueued();
+
+	Node* volatile m_Head;  // Last pushed
+	Node* m_Tail;  // Next to pop
+	Node m_Stub;
+	volatile LONG m_Queued;
+
+	std::wstring m_Path;
+	HANDLE m_File;
+	HANDLE m_Thread;
+	HANDLE m_WakeEvent;
+	std::string m_Buffer;
+
+	volatile bool m_Open;
+	volatile bool m_Stop;
+	volatile bool m_FileDeleted;
+};
+
+#endif
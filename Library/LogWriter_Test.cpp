@@ -0,0 +1,142 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "LogWriter.h"
+#include "../Common/UnitTest.h"
+
+namespace {
+
+std::wstring CreateTestFile()
+{
+	WCHAR path[MAX_PATH];
+	GetTempPath(MAX_PATH, path);
+	wcscat_s(path, L"LogWriter_Test.log");
+
+	HANDLE file = CreateFile(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	CloseHandle(file);
+	return path;
+}
+
+std::string ReadTestFile(const std::wstring& path)
+{
+	std::string content;
+	HANDLE file = CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file != INVALID_HANDLE_VALUE)
+	{
+		char buffer[4096];
+		DWORD read;
+		while (ReadFile(file, buffer, sizeof(buffer), &read, nullptr) && read > 0)
+		{
+			content.append(buffer, read);
+		}
+		CloseHandle(file);
+	}
+	return content;
+}
+
+}  // namespace
+
+TEST_CLASS(Library_LogWriter_Test)
+{
+public:
+	TEST_METHOD(TestWrite)
+	{
+		const std::wstring path = CreateTestFile();
+
+		LogWriter writer;
+		writer.Write(L"Not open");
+		Assert::IsTrue(writer.Open(path));
+		writer.Write(L"First \x00E9");
+		writer.Close();
+		Assert::IsTrue(std::string("\xEF\xBB\xBF" "First \xC3\xA9\r\n") == ReadTestFile(path));
+
+		// Lines are appended without another byte order mark.
+		Assert::IsTrue(writer.Open(path));
+		writer.Write(L"Second");
+		writer.Close();
+		Assert::IsTrue(std::string("\xEF\xBB\xBF" "First \xC3\xA9\r\nSecond\r\n") == ReadTestFile(path));
+
+		DeleteFile(path.c_str());
+	}
+
+	TEST_METHOD(TestConcurrentWrite)
+	{
+		const std::wstring path = CreateTestFile();
+		const int THREADS = 4;
+		const int LINES = 5000;
+
+		LogWriter writer;
+		Assert::IsTrue(writer.Open(path));
+
+		struct Context
+		{
+			LogWriter* writer;
+			int id;
+		} contexts[THREADS];
+
+		auto threadProc = [](LPVOID param) -> DWORD
+		{
+			Context* context = (Context*)param;
+			for (int i = 0; i < LINES; ++i)
+			{
+				context->writer->Write(std::to_wstring(context->id) + L" " + std::to_wstring(i));
+			}
+			return 0;
+		};
+
+		HANDLE threads[THREADS];
+		for (int i = 0; i < THREADS; ++i)
+		{
+			contexts[i].writer = &writer;
+			contexts[i].id = i;
+			threads[i] = CreateThread(nullptr, 0, threadProc, &contexts[i], 0, nullptr);
+		}
+
+		for (int i = 0; i < THREADS; ++i)
+		{
+			WaitForSingleObject(threads[i], INFINITE);
+			CloseHandle(threads[i]);
+		}
+		writer.Close();
+
+		// Every line is written once and the lines of each thread are in order.
+		const std::string content = ReadTestFile(path);
+		int next[THREADS] = {};
+		size_t lines = 0;
+		for (size_t pos = 3; pos < content.size(); )
+		{
+			const size_t end = content.find("\r\n", pos);
+			Assert::IsTrue(end != std::string::npos);
+
+			int id, index;
+			Assert::AreEqual(2, sscanf(content.c_str() + pos, "%d %d", &id, &index));
+			Assert::AreEqual(next[id], index);
+			++next[id];
+			++lines;
+
+			pos = end + 2;
+		}
+		Assert::AreEqual((size_t)(THREADS * LINES), lines);
+
+		DeleteFile(path.c_str());
+	}
+
+	TEST_METHOD(TestFileDeleted)
+	{
+		const std::wstring path = CreateTestFile();
+
+		LogWriter writer;
+		Assert::IsTrue(writer.Open(path));
+		Assert::IsTrue(DeleteFile(path.c_str()) != FALSE);
+
+		writer.Write(L"Line");
+		writer.Close();
+		Assert::IsTrue(writer.IsFileDeleted());
+		Assert::AreEqual(-1, _waccess(path.c_str(), 0));
+	}
+};
@@ -16,23 +16,23 @@
 #include "resource.h"
 #include "Measure.h"
 
-namespace {
-
-const size_t MAX_LOG_ENTIRES = 20;
-
-}  // namespace
-
 Logger::Logger() :
-	m_LogToFile(false)
+	m_LogToFile(false),
+	m_EntryCount(0),
+	m_NextEntry(0)
 {
 	System::InitializeCriticalSection(&m_CsLog);
 	System::InitializeCriticalSection(&m_CsLogDelay);
+	System::InitializeCriticalSection(&m_CsLimiter);
 }
 
 Logger::~Logger()
 {
+	m_Writer.Close();
+
 	DeleteCriticalSection(&m_CsLog);
 	DeleteCriticalSection(&m_CsLogDelay);
+	DeleteCriticalSection(&m_CsLimiter);
 }
 
 Logger& Logger::GetInstance()
@@ -84,13 +84,68 @@ void Logger::DeleteLogFile()
 	}
 }
 
+void Logger::Flush()
+{
+	std::vector<LogLimiter::Record> records;
+
+	EnterCriticalSection(&m_CsLimiter);
+	m_Limiter.Flush(GetTickCount64(), records);
+	LeaveCriticalSection(&m_CsLimiter);
+
+	for (const auto& record : records)
+	{
+		LogEntry((Level)record.level, record.source.c_str(), record.message.c_str());
+	}
+}
+
+void Logger::Finalize()
+{
+	std::vector<LogLimiter::Record> records;
+
+	EnterCriticalSection(&m_CsLimiter);
+	m_Limiter.FlushAll(records);
+	LeaveCriticalSection(&m_CsLimiter);
+
+	for (const auto& record : records)
+	{
+		LogEntry((Level)record.level, record.source.c_str(), record.message.c_str());
+	}
+
+	EnterCriticalSection(&m_CsLog);
+	m_Writer.Close();
+	LeaveCriticalSection(&m_CsLog);
+}
+
 void Logger::SetLogToFile(bool logToFile)
 {
+	EnterCriticalSection(&m_CsLog);
+
 	m_LogToFile = logToFile;
+	if (!logToFile)
+	{
+		m_Writer.Close();
+	}
+	else if (!m_Writer.IsOpen())
+	{
+		// This fails if the file does not exist yet, in which case StartLogFile() creates it and
+		// calls this again.
+		m_Writer.Open(m_LogFilePath);
+	}
+
+	LeaveCriticalSection(&m_CsLog);
+
 	WritePrivateProfileString(
 		L"Rainmeter", L"Logging", logToFile ? L"1" : L"0", GetRainmeter().GetIniFile().c_str());
 }
 
+void Logger::SetLimits(ULONGLONG repeatInterval, UINT rate, UINT burst)
+{
+	EnterCriticalSection(&m_CsLimiter);
+	m_Limiter.SetRepeatInterval(repeatInterval);
+	m_Limiter.SetRate(rate, burst);
+	LeaveCriticalSection(&m_CsLimiter);
+}
+
 void Logger::LogInternal(Level level, std::chrono::system_clock::time_point timestamp, const WCHAR* source, const WCHAR* msg)
 {
 	auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(timestamp.time_since_epoch());
@@ -107,19 +162,43 @@ void Logger::LogInternal(Level level, std::chrono::system_clock::time_point time
 		time->tm_sec,
 		milliseconds.count() % 1000);
 
-	// Store up to MAX_LOG_ENTIRES entries.
-	Entry entry = {level, std::wstring(timestampSz, len), source, msg};
-	m_Entries.push_back(entry);
-	if (m_Entries.size() > MAX_LOG_ENTIRES)
+	// Store up to MAX_ENTRIES entries.
+	Entry& entry = m_Entries[m_NextEntry];
+	entry.level = level;
+	entry.timestamp.assign(timestampSz, len);
+	entry.source = source;
+	entry.message = msg;
+
+	m_NextEntry = (m_NextEntry + 1) % MAX_ENTRIES;
+	if (m_EntryCount < MAX_ENTRIES)
 	{
-		m_Entries.pop_front();
+		++m_EntryCount;
 	}
 
 	DialogAbout::AddLogItem(level, timestampSz, source, msg);
 	WriteToLogFile(entry);
 }
 
-void Logger::WriteToLogFile(Entry& entry)
+std::vector<Logger::Entry> Logger::GetEntries()
+{
+	std::vector<Entry> entries;
+
+	EnterCriticalSection(&m_CsLog);
+
+	entries.reserve(m_EntryCount);
+	size_t index = (m_NextEntry + MAX_ENTRIES - m_EntryCount) % MAX_ENTRIES;
+	for (size_t i = 0; i < m_EntryCount; ++i)
+	{
+		entries.push_back(m_Entries[index]);
+		index = (index + 1) % MAX_ENTRIES;
+	}
+
+	LeaveCriticalSection(&m_CsLog);
+
+	return entries;
+}
+
+void Logger::WriteToLogFile(const Entry& entry)
 {
 #ifndef _DEBUG
 	if (!m_LogToFile) return;
@@ -131,38 +210,53 @@ void Logger::WriteToLogFile(Entry& entry)
 		(entry.level == Level::Notice) ? L"NOTE" :
 		L"DBUG";
 
-	std::wstring message = levelSz;
+	std::wstring message;
+	message.reserve(entry.timestamp.length() + entry.source.length() + entry.message.length() + 16);
+	message = levelSz;
 	message += L" (";
 	message.append(entry.timestamp);
 	message += L") ";
 	message += entry.source;
 	message += L": ";
 	message += entry.message;
-	message += L'\n';
 
 #ifdef _DEBUG
-	_RPTW0(_CRT_WARN, message.c_str());
+	_RPTW1(_CRT_WARN, L"%s\n", message.c_str());
 	if (!m_LogToFile) return;
 #endif
 
-	const WCHAR* filePath = m_LogFilePath.c_str();
-	if (_waccess(filePath, 0) == -1)
+	if (m_Writer.IsFileDeleted())
 	{
 		// The file has been deleted manually.
 		StopLogFile();
 	}
 	else
 	{
-		FILE* file = _wfopen(filePath, L"a+, ccs=UTF-8");
-		if (file)
-		{
-			fputws(message.c_str(), file);
-			fclose(file);
-		}
+		m_Writer.Write(std::move(message));
 	}
 }
 
 void Logger::Log(Level level, const WCHAR* source, const WCHAR* msg)
+{
+	std::vector<LogLimiter::Record> records;
+
+	EnterCriticalSection(&m_CsLimiter);
+	const bool log = m_Limiter.Check((int)level, source, msg, GetTickCount64(), records);
+	LeaveCriticalSection(&m_CsLimiter);
+
+	// Summaries of the suppressed messages.
+	for (const auto& record : records)
+	{
+		LogEntry((Level)record.level, record.source.c_str(), record.message.c_str());
+	}
+
+	if (log)
+	{
+		LogEntry(level, source, msg);
+	}
+}
+
+void Logger::LogEntry(Level level, const WCHAR* source, const WCHAR* msg)
 {
 	struct DelayedEntry
 	{
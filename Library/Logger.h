@@ -12,7 +12,10 @@
 #include <cstdarg>
 #include <string>
 #include <list>
+#include <vector>
 #include <chrono>
+#include "LogLimiter.h"
+#include "LogWriter.h"
 
 class Section;
 class Skin;
@@ -46,9 +49,21 @@ public:
 	void StopLogFile();
 	void DeleteLogFile();
 
+	// Logs the summaries of the collapsed and suppressed messages that are due. Called
+	// periodically so that they are logged even if nothing else is.
+	void Flush();
+
+	// Logs the remaining summaries and writes the lines still queued for the log file. Called on
+	// exit.
+	void Finalize();
+
 	bool IsLogToFile() { return m_LogToFile; }
 	void SetLogToFile(bool logToFile);
 
+	// Sets how repeated messages are collapsed and how many messages a single source may log.
+	// See LogLimiter.
+	void SetLimits(ULONGLONG repeatInterval, UINT rate, UINT burst);
+
 	void Log(Level level, const WCHAR* source, const WCHAR* msg);
 	void LogVF(Level level, const WCHAR* source, const WCHAR* format, va_list args);
 	void LogSkinVF(Logger::Level level, Skin* skin, const WCHAR* format, va_list args);
@@ -58,13 +73,17 @@ public:
 
 	const std::wstring& GetLogFilePath() { return m_LogFilePath; }
 
-	const std::list<Entry>& GetEntries() { return m_Entries; }
+	// Returns a copy of the most recent entries, oldest first.
+	std::vector<Entry> GetEntries();
+
+	static const size_t MAX_ENTRIES = 20;
 
 private:
+	void LogEntry(Level level, const WCHAR* source, const WCHAR* msg);
 	void LogInternal(Level level, std::chrono::system_clock::time_point timestamp, const WCHAR* source, const WCHAR* msg);
 
-	// Appends |entry| to the log file.
-	void WriteToLogFile(Entry& entry);
+	// Queues |entry| for the log file.
+	void WriteToLogFile(const Entry& entry);
 
 	Logger();
 	~Logger();
@@ -75,10 +94,18 @@ private:
 	bool m_LogToFile;
 	std::wstring m_LogFilePath;
 
-	std::list<Entry> m_Entries;
+	LogWriter m_Writer;
+	LogLimiter m_Limiter;
+
+	// Fixed ring of the most recent entries. The slots are reused so that their strings keep
+	// their capacity.
+	Entry m_Entries[MAX_ENTRIES];
+	size_t m_EntryCount;
+	size_t m_NextEntry;
 
 	CRITICAL_SECTION m_CsLog;
 	CRITICAL_SECTION m_CsLogDelay;
+	CRITICAL_SECTION m_CsLimiter;
 };
 
 // Convenience functions.
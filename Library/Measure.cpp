@@ -30,8 +30,8 @@
 #include "Rainmeter.h"
 #include "Error.h"
 #include "Util.h"
-#include "pcre/config.h"
-#include "pcre/pcre.h"
+#include "../Common/RegExpCache.h"
+#include "../Common/StringUtil.h"
 
 #define OVECCOUNT 300	// Should be a multiple of 3
 
@@ -65,15 +65,17 @@ Measure::Measure(Skin* skin, const WCHAR* name) : Section(skin, name),
 	m_MaxValue(1.0),
 	m_Value(),
 	m_RegExpSubstitute(false),
-	m_MedianPos(),
-	m_AveragePos(),
+	m_MedianSize(),
 	m_AverageSize(),
+	m_ExponentialAverageSize(),
 	m_Disabled(false),
 	m_Paused(false),
 	m_Initialized(false),
 	m_OldValue(),
-	m_ValueAssigned(false)
+	m_ValueAssigned(false),
+	m_NextFormattedValue()
 {
+	ClearFormattedValues();
 }
 
 Measure::~Measure()
@@ -97,7 +99,7 @@ void Measure::Initialize()
 */
 void Measure::ReadOptions(ConfigParser& parser, const WCHAR* section)
 {
-	bool oldOnChangeActionEmpty = m_OnChangeAction.empty();
+	bool oldOnChangeActionEmpty = m_OnChangeAction.IsEmpty();
 
 	Section::ReadOptions(parser, section);
 
@@ -107,6 +109,9 @@ void Measure::ReadOptions(ConfigParser& parser, const WCHAR* section)
 		m_Substitute.clear();
 	}
 
+	// The formatted values may have been substituted with the old options.
+	ClearFormattedValues();
+
 	m_Invert = parser.ReadBool(section, L"InvertMeasure", false);
 
 	m_Disabled = parser.ReadBool(section, L"Disabled", false);
@@ -124,10 +129,19 @@ void Measure::ReadOptions(ConfigParser& parser, const WCHAR* section)
 		m_IfActions.ReadConditionOptions(parser, section);
 	}
 
-	m_OnChangeAction = parser.ReadString(section, L"OnChangeAction", L"", false);
+	m_OnChangeAction.Set(parser.ReadString(section, L"OnChangeAction", L"", false));
 
+	m_MedianSize = parser.ReadUInt(section, L"MedianSize", 0);
 	m_AverageSize = parser.ReadUInt(section, L"AverageSize", 0);
 
+	const UINT exponentialAverageSize = parser.ReadUInt(section, L"ExponentialAverageSize", 0);
+	if (exponentialAverageSize != m_ExponentialAverageSize)
+	{
+		m_ExponentialAverageSize = exponentialAverageSize;
+		m_ExponentialAverage.SetSize(exponentialAverageSize);
+		m_ExponentialAverage.Clear();
+	}
+
 	m_RegExpSubstitute = parser.ReadBool(section, L"RegExpSubstitute", false);
 	std::wstring subs = parser.ReadString(section, L"Substitute", L"");
 	if (!subs.empty())
@@ -146,7 +160,7 @@ void Measure::ReadOptions(ConfigParser& parser, const WCHAR* section)
 	}
 
 	if (m_Initialized &&
-		oldOnChangeActionEmpty && !m_OnChangeAction.empty())
+		oldOnChangeActionEmpty && !m_OnChangeAction.IsEmpty())
 	{
 		DoChangeAction(false);
 	}
@@ -239,14 +253,8 @@ const WCHAR* Measure::CheckSubstitute(const WCHAR* buffer)
 		for (size_t i = 0, isize = m_Substitute.size(); i < isize; i += 2)
 		{
 			const char* error;
-			int errorOffset;
 			int offset = 0;
-			pcre16* re = pcre16_compile(
-				(PCRE_SPTR16)m_Substitute[i].c_str(),
-				PCRE_UTF16,
-				&error,
-				&errorOffset,
-				nullptr);  // Use default character tables.
+			auto re = GetRegExpCache().Get(m_Substitute[i], PCRE_UTF16, &error);
 			if (!re)
 			{
 				MakePlainSubstitute(str, i);
@@ -257,10 +265,8 @@ const WCHAR* Measure::CheckSubstitute(const WCHAR* buffer)
 				do
 				{
 					const int options = str.empty() ? 0 : PCRE_NOTEMPTY;
-					const int rc = pcre16_exec(
-						re,
-						nullptr,
-						(PCRE_SPTR16)str.c_str(),
+					const int rc = re->Exec(
+						str.c_str(),
 						(int)str.length(),
 						offset,
 						options,               // Empty string is not a valid match
@@ -304,8 +310,6 @@ const WCHAR* Measure::CheckSubstitute(const WCHAR* buffer)
 					offset = start + (int)result.length();
 				}
 				while (true);
-
-				pcre16_free(re);
 			}
 		}
 	}
@@ -415,6 +419,20 @@ std::wstring Measure::ExtractWord(std::wstring& buffer)
 }
 
 bool Measure::Update(bool rereadOptions)
+{
+	if (!BeginUpdate(rereadOptions)) return false;
+
+	CalculateValue();
+	EndUpdate(rereadOptions);
+	return true;
+}
+
+/*
+** First step of Update(). Returns true if the value needs to be calculated with CalculateValue()
+** followed by EndUpdate().
+**
+*/
+bool Measure::BeginUpdate(bool rereadOptions)
 {
 	if (rereadOptions)
 	{
@@ -427,80 +445,88 @@ bool Measure::Update(bool rereadOptions)
 	if (!m_Disabled)
 	{
 		// Only update the counter if the divider
-		if (!UpdateCounter()) return false;
-
-		// Call derived method to update value
-		UpdateValue();
-
-		if (m_AverageSize > 0)
-		{
-			size_t averageValuesSize = m_AverageValues.size();
+		return UpdateCounter();
+	}
+	else
+	{
+		// Disabled measures have 0 as value
+		m_Value = 0.0;
 
-			if (m_AverageSize != averageValuesSize)
-			{
-				m_AverageValues.resize(m_AverageSize, m_Value);
-				averageValuesSize = m_AverageValues.size();
-				if (m_AveragePos >= averageValuesSize) m_AveragePos = 0;
-			}
-			m_AverageValues[m_AveragePos] = m_Value;
+		m_IfActions.SetState(m_Value);
 
-			++m_AveragePos;
-			m_AveragePos %= averageValuesSize;
+		return false;
+	}
+}
 
-			// Calculate the average value
-			double value = 0;
-			for (size_t i = 0; i < averageValuesSize; ++i)
-			{
-				value += m_AverageValues[i];
-			}
-			m_Value = value / (double)averageValuesSize;
-		}
+/*
+** Second step of Update(). This may be called on a worker thread if IsThreadSafe() is true so it
+** must not use anything but the state of this measure.
+**
+*/
+void Measure::CalculateValue()
+{
+	// Call derived method to update value
+	UpdateValue();
 
-		// If we're logging the maximum value of the measure, check if
-		// the new value is greater than the old one, and update if necessary.
-		if (m_LogMaxValue)
+	// The median filter removes spikes before the value is averaged.
+	if (m_MedianSize > 0)
+	{
+		if (m_MedianSize != m_Median.GetSize())
 		{
-			if (m_MedianValues.empty())
-			{
-				m_MedianValues.resize(MEDIAN_SIZE, 0);
-			}
-
-			m_MedianValues[m_MedianPos] = m_Value;
-			++m_MedianPos;
-			m_MedianPos %= MEDIAN_SIZE;
-
-			auto medianArray = m_MedianValues;
-			std::sort(&medianArray.data()[0], &medianArray.data()[MEDIAN_SIZE]);  // Workaround for "Debug" build mode
-
-			double medianValue = medianArray[MEDIAN_SIZE / 2];
-			m_MaxValue = max(m_MaxValue, medianValue);
-			m_MinValue = min(m_MinValue, medianValue);
+			m_Median.Resize(m_MedianSize, m_Value);
 		}
 
-		m_ValueAssigned = true;
+		m_Value = m_Median.Add(m_Value);
+	}
 
-		// For the conditional options to work with the current measure value when using
-		// [MeasureName], we need to read the options after m_Value has been changed.
-		if (rereadOptions)
+	if (m_AverageSize > 0)
+	{
+		if (m_AverageSize != m_Average.GetSize())
 		{
-			m_IfActions.ReadConditionOptions(m_Skin->GetParser(), GetName());
+			m_Average.Resize(m_AverageSize, m_Value);
 		}
 
-		if (m_Skin)
+		m_Value = m_Average.Add(m_Value);
+	}
+
+	if (m_ExponentialAverageSize > 0)
+	{
+		m_Value = m_ExponentialAverage.Add(m_Value);
+	}
+
+	// If we're logging the maximum value of the measure, check if
+	// the new value is greater than the old one, and update if necessary.
+	if (m_LogMaxValue)
+	{
+		if (m_LogMaxMedian.GetSize() == 0)
 		{
-			m_IfActions.DoIfActions(*this, m_Value);
+			m_LogMaxMedian.Resize(MEDIAN_SIZE, 0.0);
 		}
 
-		return true;
+		const double medianValue = m_LogMaxMedian.Add(m_Value);
+		m_MaxValue = max(m_MaxValue, medianValue);
+		m_MinValue = min(m_MinValue, medianValue);
 	}
-	else
-	{
-		// Disabled measures have 0 as value
-		m_Value = 0.0;
 
-		m_IfActions.SetState(m_Value);
+	m_ValueAssigned = true;
+}
 
-		return false;
+/*
+** Last step of Update().
+**
+*/
+void Measure::EndUpdate(bool rereadOptions)
+{
+	// For the conditional options to work with the current measure value when using
+	// [MeasureName], we need to read the options after m_Value has been changed.
+	if (rereadOptions)
+	{
+		m_IfActions.ReadConditionOptions(m_Skin->GetParser(), GetName());
+	}
+
+	if (m_Skin)
+	{
+		m_IfActions.DoIfActions(*this, m_Value);
 	}
 }
 
@@ -582,52 +608,86 @@ const WCHAR* Measure::GetStringOrFormattedValue(AUTOSCALE autoScale, double scal
 */
 const WCHAR* Measure::GetFormattedValue(AUTOSCALE autoScale, double scale, int decimals, bool percentual)
 {
-	static WCHAR buffer[128];
-	WCHAR format[32];
-
+	// Only the options that affect the text are part of the key.
+	double value;
 	if (percentual)
 	{
-		double val = 100.0 * GetRelativeValue();
+		value = 100.0 * GetRelativeValue();
+		autoScale = AUTOSCALE_OFF;
+		scale = 1.0;
+	}
+	else
+	{
+		value = GetValue();
+		if (autoScale != AUTOSCALE_OFF)
+		{
+			scale = 1.0;
+		}
+	}
 
-		_snwprintf_s(format, _TRUNCATE, L"%%.%if", decimals);
-		_snwprintf_s(buffer, _TRUNCATE, format, val);
+	// Several meters often format the same value in the same way during an update. The value
+	// itself is compared as it depends on InvertMeasure and the logged minimum and maximum too.
+	for (size_t i = 0; i < _countof(m_FormattedValues); ++i)
+	{
+		const FormattedValue& formatted = m_FormattedValues[i];
+		if (formatted.valid && formatted.value == value && formatted.scale == scale &&
+			formatted.decimals == decimals && formatted.autoScale == autoScale &&
+			formatted.percentual == percentual)
+		{
+			return formatted.text.c_str();
+		}
+	}
+
+	WCHAR buffer[128];
+
+	if (percentual)
+	{
+		StringUtil::FormatDecimal(buffer, _countof(buffer), value, decimals);
 	}
 	else if (autoScale != AUTOSCALE_OFF)
 	{
-		GetScaledValue(autoScale, decimals, GetValue(), buffer, _countof(buffer));
+		GetScaledValue(autoScale, decimals, value, buffer, _countof(buffer));
 	}
 	else
 	{
-		double val = GetValue() / scale;
+		double val = value / scale;
 
 		if (decimals == -1)
 		{
-			int len = _snwprintf_s(buffer, _TRUNCATE, L"%.5f", val);
+			int len = StringUtil::FormatDecimal(buffer, _countof(buffer), val, 5);
 			RemoveTrailingZero(buffer, len);
 		}
 		else
 		{
-			_snwprintf_s(format, _TRUNCATE, L"%%.%if", decimals);
-			_snwprintf_s(buffer, _TRUNCATE, format, val);
+			StringUtil::FormatDecimal(buffer, _countof(buffer), val, decimals);
 		}
 	}
 
-	return CheckSubstitute(buffer);
+	FormattedValue& formatted = m_FormattedValues[m_NextFormattedValue];
+	m_NextFormattedValue = (m_NextFormattedValue + 1) % _countof(m_FormattedValues);
+
+	formatted.value = value;
+	formatted.scale = scale;
+	formatted.decimals = decimals;
+	formatted.autoScale = autoScale;
+	formatted.percentual = percentual;
+	formatted.valid = true;
+	formatted.text = CheckSubstitute(buffer);
+	return formatted.text.c_str();
 }
 
-void Measure::GetScaledValue(AUTOSCALE autoScale, int decimals, double theValue, WCHAR* buffer, size_t sizeInWords)
+void Measure::ClearFormattedValues()
 {
-	WCHAR format[32];
-	double value = 0;
-
-	if (decimals == 0)
+	for (size_t i = 0; i < _countof(m_FormattedValues); ++i)
 	{
-		wcsncpy_s(format, L"%.0f", _TRUNCATE);
-	}
-	else
-	{
-		_snwprintf_s(format, _TRUNCATE, L"%%.%if", decimals);
+		m_FormattedValues[i].valid = false;
 	}
+}
+
+void Measure::GetScaledValue(AUTOSCALE autoScale, int decimals, double theValue, WCHAR* buffer, size_t sizeInWords)
+{
+	const WCHAR* unit;
+	double value = 0;
 
 	const double* tblScale =
 		g_TblScale[(autoScale == AUTOSCALE_1000 || autoScale == AUTOSCALE_1000K) ? AUTOSCALE_INDEX_1000 : AUTOSCALE_INDEX_1024];
@@ -635,29 +695,33 @@ void Measure::GetScaledValue(AUTOSCALE autoScale, int decimals, double theValue,
 	if (theValue >= tblScale[0])
 	{
 		value = theValue / tblScale[0];
-		wcsncat_s(format, L" T", _TRUNCATE);
+		unit = L" T";
 	}
 	else if (theValue >= tblScale[1])
 	{
 		value = theValue / tblScale[1];
-		wcsncat_s(format, L" G", _TRUNCATE);
+		unit = L" G";
 	}
 	else if (theValue >= tblScale[2])
 	{
 		value = theValue / tblScale[2];
-		wcsncat_s(format, L" M", _TRUNCATE);
+		unit = L" M";
 	}
 	else if (autoScale == AUTOSCALE_1024K || autoScale == AUTOSCALE_1000K || theValue >= tblScale[3])
 	{
 		value = theValue / tblScale[3];
-		wcsncat_s(format, L" k", _TRUNCATE);
+		unit = L" k";
 	}
 	else
 	{
 		value = theValue;
-		wcsncat_s(format, L" ", _TRUNCATE);
+		unit = L" ";
+	}
+
+	if (StringUtil::FormatDecimal(buffer, sizeInWords, value, decimals) >= 0)
+	{
+		wcsncat_s(buffer, sizeInWords, unit, _TRUNCATE);
 	}
-	_snwprintf_s(buffer, sizeInWords, _TRUNCATE, format, value);
 }
 
 void Measure::RemoveTrailingZero(WCHAR* str, int strLen)
@@ -688,7 +752,7 @@ void Measure::RemoveTrailingZero(WCHAR* str, int strLen)
 */
 void Measure::DoChangeAction(bool execute)
 {
-	if (!m_OnChangeAction.empty() && m_ValueAssigned)
+	if (!m_OnChangeAction.IsEmpty() && m_ValueAssigned)
 	{
 		double newValue = GetValue();
 		const WCHAR* newStringValue = GetStringValue();
@@ -705,7 +769,7 @@ void Measure::DoChangeAction(bool execute)
 		{
 			if (m_OldValue->IsChanged(newValue, newStringValue))
 			{
-				GetRainmeter().ExecuteCommand(m_OnChangeAction.c_str(), m_Skin);
+				GetRainmeter().ExecuteAction(m_OnChangeAction, m_Skin);
 			}
 		}
 		else
@@ -715,6 +779,18 @@ void Measure::DoChangeAction(bool execute)
 	}
 }
 
+/*
+** Appends the measures that are used to calculate the value of this measure or to evaluate its
+** IfConditions. Returns false if the value can also change without any of these measures
+** changing (e.g. system measures), in which case the measure must be updated on every cycle.
+**
+*/
+bool Measure::GetDependencies(std::vector<Measure*>& measures)
+{
+	const bool derived = GetInputMeasures(measures);
+	return m_IfActions.GetConditionMeasures(measures) && derived;
+}
+
 /*
 ** Creates the given measure. This is the factory method for the measures.
 ** If new measures are implemented this method needs to be updated.
@@ -823,19 +899,18 @@ void Measure::Command(const std::wstring& command)
 ** Returns the number value of a measure, used by IfCondition's.
 **
 */
+Measure* Measure::GetCurrentMeasure(Skin* skin, const WCHAR* str, int len)
+{
+	return skin->GetParser().GetMeasure(str, (size_t)len);
+}
+
 bool Measure::GetCurrentMeasureValue(const WCHAR* str, int len, double* value, void* context)
 {
 	auto measure = (Measure*)context;
-	const std::vector<Measure*>& measures = measure->m_Skin->GetMeasures();
-
-	for (const auto& iter : measures)
+	if (Measure* current = GetCurrentMeasure(measure->m_Skin, str, len))
 	{
-		if (iter->GetOriginalName().length() == len &&
-			_wcsnicmp(str, iter->GetName(), len) == 0)
-		{
-			*value = iter->GetValue();
-			return true;
-		}
+		*value = current->GetValue();
+		return true;
 	}
 
 	return false;
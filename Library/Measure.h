@@ -12,6 +12,8 @@
 #include <vector>
 #include <string>
 #include "IfActions.h"
+#include "MeasureHistory.h"
+#include "RunningStats.h"
 #include "Util.h"
 #include "Section.h"
 
@@ -53,6 +55,12 @@ public:
 
 	virtual void Initialize();
 	bool Update(bool rereadOptions = false);
+	bool BeginUpdate(bool rereadOptions);
+	void CalculateValue();
+	void EndUpdate(bool rereadOptions);
+
+	// If true, CalculateValue() can be called on a worker thread concurrently with other measures.
+	virtual bool IsThreadSafe() { return false; }
 
 	void Disable();
 	void Enable();
@@ -70,6 +78,9 @@ public:
 	double GetMinValue() { return m_MinValue; }
 	double GetMaxValue() { return m_MaxValue; }
 
+	// Values recorded by the meters with the given UpdateDivider that graph this measure.
+	MeasureHistory& GetHistory(int updateDivider) { return m_Histories.Get(updateDivider); }
+
 	virtual const WCHAR* GetStringValue();
 	const WCHAR* GetStringOrFormattedValue(AUTOSCALE autoScale, double scale, int decimals, bool percentual);
 	const WCHAR* GetFormattedValue(AUTOSCALE autoScale, double scale, int decimals, bool percentual);
@@ -77,10 +88,13 @@ public:
 	static void GetScaledValue(AUTOSCALE autoScale, int decimals, double theValue, WCHAR* buffer, size_t sizeInWords);
 	static void RemoveTrailingZero(WCHAR* str, int strLen);
 
-	const std::wstring& GetOnChangeAction() { return m_OnChangeAction; }
+	const std::wstring& GetOnChangeAction() { return m_OnChangeAction.GetText(); }
 	void DoChangeAction(bool execute = true);
 
+	bool GetDependencies(std::vector<Measure*>& measures);
+
 	static Measure* Create(const WCHAR* measure, Skin* skin, const WCHAR* name);
+	static Measure* GetCurrentMeasure(Skin* skin, const WCHAR* str, int len);
 	static bool GetCurrentMeasureValue(const WCHAR* str, int len, double* value, void* context);
 
 protected:
@@ -88,6 +102,10 @@ protected:
 
 	virtual void ReadOptions(ConfigParser& parser, const WCHAR* section);
 	virtual void UpdateValue() = 0;
+	virtual bool GetInputMeasures(std::vector<Measure*>& measures) { return false; }
+
+	// True if the value is filtered over several updates.
+	bool IsSmoothed() { return m_MedianSize > 0 || m_AverageSize > 0 || m_ExponentialAverageSize > 0; }
 
 	bool ParseSubstitute(std::wstring buffer);
 	std::wstring ExtractWord(std::wstring& buffer);
@@ -103,21 +121,45 @@ protected:
 	std::vector<std::wstring> m_Substitute;	// Vec of substitute strings
 	bool m_RegExpSubstitute;
 
-	std::vector<double> m_MedianValues;	// The values for the median filtering
-	UINT m_MedianPos;				// Position in the median array, where the new value is placed
+	RunningMedian m_LogMaxMedian;	// The values for the median filtering of the logged maximum & minimum
+
+	RunningMedian m_Median;
+	UINT m_MedianSize;
 
-	std::vector<double> m_AverageValues;
-	UINT m_AveragePos;
+	RunningAverage m_Average;
 	UINT m_AverageSize;
 
+	ExponentialAverage m_ExponentialAverage;
+	UINT m_ExponentialAverageSize;
+
+	MeasureHistorySet m_Histories;
+
 	IfActions m_IfActions;
 	bool m_Disabled;				// Status of the measure
 	bool m_Paused;
 	bool m_Initialized;
 
-	std::wstring m_OnChangeAction;
+	ActionProgram m_OnChangeAction;
 	MeasureValueSet* m_OldValue;
 	bool m_ValueAssigned;
+
+private:
+	// A value formatted by GetFormattedValue(). The text includes substitutions.
+	struct FormattedValue
+	{
+		double value;
+		double scale;
+		int decimals;
+		AUTOSCALE autoScale;
+		bool percentual;
+		bool valid;
+		std::wstring text;
+	};
+
+	void ClearFormattedValues();
+
+	FormattedValue m_FormattedValues[4];
+	UINT m_NextFormattedValue;
 };
 
 #endif
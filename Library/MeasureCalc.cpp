@@ -23,6 +23,7 @@ std::mt19937& GetRandomEngine()
 
 MeasureCalc::MeasureCalc(Skin* skin, const WCHAR* name) : Measure(skin, name),
 	m_ParseError(false),
+	m_Volatile(false),
 	m_LowBound(DEFAULT_LOWER_BOUND),
 	m_HighBound(DEFAULT_UPPER_BOUND),
 	m_UpdateRandom(false),
@@ -40,7 +41,7 @@ MeasureCalc::~MeasureCalc()
 */
 void MeasureCalc::UpdateValue()
 {
-	const WCHAR* errMsg = MathParser::Parse(m_Formula.c_str(), &m_Value, GetMeasureValue, this);
+	const WCHAR* errMsg = MathParser::Evaluate(m_Program, &m_Value, GetSlotValue, this);
 	if (errMsg != nullptr)
 	{
 		if (!m_ParseError)
@@ -55,6 +56,17 @@ void MeasureCalc::UpdateValue()
 	}
 }
 
+/*
+** The value of the calculation depends only on the referenced measures unless the formula uses
+** Counter or Random, or the value is filtered over several updates.
+**
+*/
+bool MeasureCalc::GetInputMeasures(std::vector<Measure*>& measures)
+{
+	measures.insert(measures.end(), m_ProgramMeasures.begin(), m_ProgramMeasures.end());
+	return !m_Volatile && !IsSmoothed();
+}
+
 /*
 ** Read the options specified in the ini file.
 **
@@ -111,10 +123,19 @@ void MeasureCalc::ReadOptions(ConfigParser& parser, const WCHAR* section)
 		}
 
 		const WCHAR* errMsg = MathParser::Check(m_Formula.c_str());
+		if (errMsg == nullptr)
+		{
+			// Measure names are resolved here so that UpdateValue() does no string work.
+			m_ProgramMeasures.clear();
+			m_Volatile = false;
+			errMsg = MathParser::Compile(m_Formula.c_str(), &m_Program, ResolveName, this);
+		}
+
 		if (errMsg != nullptr)
 		{
 			LogErrorF(this, L"Calc: %s", errMsg);
 			m_Formula.clear();
+			m_Program.Clear();
 		}
 	}
 }
@@ -153,36 +174,49 @@ void MeasureCalc::FormulaReplace()
 	while (pos != std::wstring::npos);
 }
 
-bool MeasureCalc::GetMeasureValue(const WCHAR* str, int len, double* value, void* context)
+bool MeasureCalc::ResolveName(const WCHAR* str, int len, int* slot, void* context)
 {
 	auto calc = (MeasureCalc*)context;
-	const std::vector<Measure*>& measures = calc->m_Skin->GetMeasures();
 
-	std::vector<Measure*>::const_iterator iter = measures.begin();
-	for ( ; iter != measures.end(); ++iter)
+	if (Measure* measure = GetCurrentMeasure(calc->m_Skin, str, len))
 	{
-		if ((*iter)->GetOriginalName().length() == len &&
-			_wcsnicmp(str, (*iter)->GetName(), len) == 0)
-		{
-			*value = (*iter)->GetValue();
-			return true;
-		}
+		*slot = (int)calc->m_ProgramMeasures.size();
+		calc->m_ProgramMeasures.push_back(measure);
+		return true;
 	}
 
 	if (_wcsnicmp(str, L"counter", len) == 0)
 	{
-		*value = calc->m_Skin->GetUpdateCounter();
+		*slot = SLOT_COUNTER;
+		calc->m_Volatile = true;
 		return true;
 	}
 	else if (_wcsnicmp(str, L"random", len) == 0)
 	{
-		*value = calc->GetRandom();
+		*slot = SLOT_RANDOM;
+		calc->m_Volatile = true;
 		return true;
 	}
 
 	return false;
 }
 
+double MeasureCalc::GetSlotValue(int slot, void* context)
+{
+	auto calc = (MeasureCalc*)context;
+
+	switch (slot)
+	{
+	case SLOT_COUNTER:
+		return calc->m_Skin->GetUpdateCounter();
+
+	case SLOT_RANDOM:
+		return calc->GetRandom();
+	}
+
+	return calc->m_ProgramMeasures[slot]->GetValue();
+}
+
 int MeasureCalc::GetRandom()
 {
 	if (m_LowBound == m_HighBound || m_LowBound > m_HighBound)
@@ -9,6 +9,7 @@
 #define __MEASURECALC_H__
 
 #include "Measure.h"
+#include "../Common/MathParser.h"
 
 class MeasureCalc : public Measure
 {
@@ -24,9 +25,17 @@ public:
 protected:
 	virtual void ReadOptions(ConfigParser& parser, const WCHAR* section);
 	virtual void UpdateValue();
+	virtual bool GetInputMeasures(std::vector<Measure*>& measures);
 
 private:
-	static bool GetMeasureValue(const WCHAR* str, int len, double* value, void* context);
+	enum SLOT
+	{
+		SLOT_COUNTER = -1,
+		SLOT_RANDOM = -2
+	};
+
+	static bool ResolveName(const WCHAR* str, int len, int* slot, void* context);
+	static double GetSlotValue(int slot, void* context);
 
 	void FormulaReplace();
 	int GetRandom();
@@ -34,6 +43,10 @@ private:
 	std::wstring m_Formula;
 	bool m_ParseError;
 
+	MathParser::Program m_Program;
+	std::vector<Measure*> m_ProgramMeasures;	// Measures referenced by m_Program
+	bool m_Volatile;							// If true, m_Program uses Counter or Random
+
 	int m_LowBound;
 	int m_HighBound;
 
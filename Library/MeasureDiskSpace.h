@@ -20,6 +20,7 @@ public:
 	MeasureDiskSpace& operator=(MeasureDiskSpace other) = delete;
 
 	virtual UINT GetTypeID() { return TypeID<MeasureDiskSpace>(); }
+	virtual bool IsThreadSafe() { return true; }
 
 	virtual const WCHAR* GetStringValue();
 
@@ -0,0 +1,190 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "MeasureHistory.h"
+
+MeasureHistory::MeasureHistory() :
+	m_Pos(),
+	m_Pass(),
+	m_Pushed(false),
+	m_Count()
+{
+}
+
+void MeasureHistory::Reserve(size_t depth, bool summaries)
+{
+	const size_t oldSize = m_Values.size();
+	const size_t size = (depth + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+	const bool enableSummaries = summaries && m_BlockMax.empty();
+
+	if (size > oldSize)
+	{
+		// Move the values to the end of the new buffer from the oldest to the latest so that the
+		// next value is written at the start.
+		std::vector<double> values(size, 0.0);
+		for (size_t age = 0; age < oldSize; ++age)
+		{
+			values[size - 1 - age] = Get(age);
+		}
+
+		m_Values.swap(values);
+		m_Pos = 0;
+	}
+	else if (!enableSummaries)
+	{
+		return;
+	}
+
+	if (enableSummaries || !m_BlockMax.empty())
+	{
+		const size_t blocks = m_Values.size() / BLOCK_SIZE;
+		m_BlockMin.resize(blocks);
+		m_BlockMax.resize(blocks);
+		for (size_t i = 0; i < blocks; ++i)
+		{
+			SummarizeBlock(i);
+		}
+	}
+}
+
+void MeasureHistory::Clear()
+{
+	std::fill(m_Values.begin(), m_Values.end(), 0.0);
+	std::fill(m_BlockMin.begin(), m_BlockMin.end(), 0.0);
+	std::fill(m_BlockMax.begin(), m_BlockMax.end(), 0.0);
+	m_Pos = 0;
+	m_Pushed = false;
+	m_Count += (UINT)m_Values.size();
+}
+
+void MeasureHistory::Push(double value)
+{
+	if (m_Values.empty()) return;
+
+	Write(m_Pos, value);
+	m_Pos = (m_Pos + 1) % m_Values.size();
+	++m_Count;
+}
+
+void MeasureHistory::Push(UINT pass, double value)
+{
+	if (m_Values.empty()) return;
+
+	if (m_Pushed && pass == m_Pass)
+	{
+		const size_t latest = (m_Pos + m_Values.size() - 1) % m_Values.size();
+		m_Values[latest] = value;
+		if (!m_BlockMax.empty())
+		{
+			SummarizeBlock(latest / BLOCK_SIZE);
+		}
+	}
+	else
+	{
+		Push(value);
+		m_Pass = pass;
+		m_Pushed = true;
+	}
+}
+
+/*
+** The summary of a block covers the whole block, except in the block of the latest value where
+** it only covers the values from the start of the block to the latest value. The rest of that
+** block holds the oldest values, which are checked one by one.
+**
+*/
+void MeasureHistory::GetRange(size_t count, double& minValue, double& maxValue) const
+{
+	minValue = 0.0;
+	maxValue = 0.0;
+
+	const size_t size = m_Values.size();
+	if (count == 0 || size == 0) return;
+
+	const size_t latest = (m_Pos + size - 1) % size;
+	minValue = maxValue = m_Values[latest];
+
+	if (m_BlockMax.empty())
+	{
+		for (size_t age = 1; age < count; ++age)
+		{
+			const double value = Get(age);
+			minValue = min(minValue, value);
+			maxValue = max(maxValue, value);
+		}
+		return;
+	}
+
+	// Walk back from the latest value one block at a time.
+	const size_t latestBlock = latest / BLOCK_SIZE;
+	size_t index = latest;
+	while (count > 0)
+	{
+		const size_t block = index / BLOCK_SIZE;
+		const size_t start = block * BLOCK_SIZE;
+		const size_t available = index - start + 1;
+		const bool summarized = (block == latestBlock) ? (index == latest) : (available == BLOCK_SIZE);
+
+		if (summarized && available <= count)
+		{
+			minValue = min(minValue, m_BlockMin[block]);
+			maxValue = max(maxValue, m_BlockMax[block]);
+			count -= available;
+		}
+		else
+		{
+			const size_t n = min(available, count);
+			for (size_t i = index + 1 - n; i <= index; ++i)
+			{
+				minValue = min(minValue, m_Values[i]);
+				maxValue = max(maxValue, m_Values[i]);
+			}
+			count -= n;
+		}
+
+		index = (start == 0) ? size - 1 : start - 1;
+	}
+}
+
+void MeasureHistory::Write(size_t index, double value)
+{
+	m_Values[index] = value;
+
+	if (!m_BlockMax.empty())
+	{
+		const size_t block = index / BLOCK_SIZE;
+		if (index % BLOCK_SIZE == 0)
+		{
+			m_BlockMin[block] = value;
+			m_BlockMax[block] = value;
+		}
+		else
+		{
+			m_BlockMin[block] = min(m_BlockMin[block], value);
+			m_BlockMax[block] = max(m_BlockMax[block], value);
+		}
+	}
+}
+
+void MeasureHistory::SummarizeBlock(size_t block)
+{
+	const size_t start = block * BLOCK_SIZE;
+	const size_t latest = (m_Pos + m_Values.size() - 1) % m_Values.size();
+	const size_t end = (latest / BLOCK_SIZE == block) ? latest + 1 : start + BLOCK_SIZE;
+
+	double minValue = m_Values[start];
+	double maxValue = m_Values[start];
+	for (size_t i = start + 1; i < end; ++i)
+	{
+		minValue = min(minValue, m_Values[i]);
+		maxValue = max(maxValue, m_Values[i]);
+	}
+
+	m_BlockMin[block] = minValue;
+	m_BlockMax[block] = maxValue;
+}
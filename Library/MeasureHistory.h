@@ -0,0 +1,79 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#ifndef RM_LIBRARY_MEASUREHISTORY_H_
+#define RM_LIBRARY_MEASUREHISTORY_H_
+
+#include <Windows.h>
+#include <map>
+#include <vector>
+
+// Ring buffer of the latest values of a measure. Every meter that graphs the measure reads from the
+// same history, which is as deep as the deepest meter needs. The values and the optional per-block
+// minimum and maximum are kept in separate arrays so that the range of the latest values can be
+// found without scanning all of them.
+class MeasureHistory
+{
+public:
+	static const size_t BLOCK_SIZE = 32;
+
+	MeasureHistory();
+
+	size_t GetCapacity() const { return m_Values.size(); }
+	bool HasSummaries() const { return !m_BlockMax.empty(); }
+
+	// Returns the number of values appended so far. Clear() counts as appending a zero to every
+	// slot so that the values between two calls are always shifted by the difference.
+	UINT GetCount() const { return m_Count; }
+
+	// Makes room for at least depth values. The latest values are kept and the new slots are
+	// zero. The capacity is never reduced and the summaries, once enabled, are kept up to date.
+	void Reserve(size_t depth, bool summaries = false);
+
+	// Sets all values to zero.
+	void Clear();
+
+	// Appends a value. If pass is the same as in the previous call, the latest value is replaced
+	// instead so that meters sharing the history record each pass over the meters only once.
+	void Push(double value);
+	void Push(UINT pass, double value);
+
+	// Returns the value pushed age updates ago. The age must be less than the capacity.
+	double Get(size_t age) const
+	{
+		const size_t size = m_Values.size();
+		return m_Values[(m_Pos + size - 1 - age) % size];
+	}
+
+	// Finds the range of the latest count values. The count must not exceed the capacity.
+	void GetRange(size_t count, double& minValue, double& maxValue) const;
+
+private:
+	void Write(size_t index, double value);
+	void SummarizeBlock(size_t block);
+
+	std::vector<double> m_Values;
+	std::vector<double> m_BlockMin;
+	std::vector<double> m_BlockMax;
+	size_t m_Pos;			// Index of the next value
+	UINT m_Pass;
+	bool m_Pushed;
+	UINT m_Count;
+};
+
+// The histories of a measure, one for each update divider of the meters graphing it. Meters that
+// update at the same rate share a history and every meter records the values at its own rate.
+class MeasureHistorySet
+{
+public:
+	MeasureHistory& Get(int updateDivider) { return m_Histories[updateDivider]; }
+
+private:
+	std::map<int, MeasureHistory> m_Histories;
+};
+
+#endif
@@ -0,0 +1,168 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "MeasureHistory.h"
+#include "../Common/UnitTest.h"
+
+TEST_CLASS(Library_MeasureHistory_Test)
+{
+public:
+	TEST_METHOD(TestPush)
+	{
+		MeasureHistory history;
+		history.Push(1.0);  // Ignored without capacity
+		history.Reserve(3);
+		Assert::AreEqual((size_t)MeasureHistory::BLOCK_SIZE, history.GetCapacity());
+		Assert::AreEqual(0.0, history.Get(0));
+
+		history.Push(1, 1.0);
+		history.Push(1, 2.0);
+		history.Push(2, 3.0);
+		Assert::AreEqual(3.0, history.Get(0));
+		Assert::AreEqual(2.0, history.Get(1));
+		Assert::AreEqual(0.0, history.Get(2));
+
+		// Growing keeps the latest values.
+		history.Reserve(MeasureHistory::BLOCK_SIZE + 1);
+		Assert::AreEqual((size_t)MeasureHistory::BLOCK_SIZE * 2, history.GetCapacity());
+		Assert::AreEqual(3.0, history.Get(0));
+		Assert::AreEqual(2.0, history.Get(1));
+		history.Push(2, 4.0);
+		Assert::AreEqual(4.0, history.Get(0));
+		history.Push(3, 5.0);
+		Assert::AreEqual(5.0, history.Get(0));
+		Assert::AreEqual(4.0, history.Get(1));
+		Assert::AreEqual(2.0, history.Get(2));
+
+		// The capacity is never reduced.
+		history.Reserve(1);
+		Assert::AreEqual((size_t)MeasureHistory::BLOCK_SIZE * 2, history.GetCapacity());
+
+		history.Clear();
+		Assert::AreEqual(0.0, history.Get(0));
+		Assert::AreEqual(0.0, history.Get(1));
+	}
+
+	TEST_METHOD(TestUpdateDividers)
+	{
+		// A meter with UpdateDivider=1 and two meters with UpdateDivider=3 graph the same measure.
+		MeasureHistorySet histories;
+		histories.Get(1).Reserve(10);
+		histories.Get(3).Reserve(10);
+		for (UINT pass = 0; pass < 9; ++pass)
+		{
+			const double value = (double)pass;
+			histories.Get(1).Push(pass, value);
+			if (pass % 3 == 0)
+			{
+				histories.Get(3).Push(pass, value);
+				histories.Get(3).Push(pass, value);
+			}
+		}
+
+		Assert::AreEqual(9U, histories.Get(1).GetCount());
+		Assert::AreEqual(8.0, histories.Get(1).Get(0));
+		Assert::AreEqual(7.0, histories.Get(1).Get(1));
+
+		// The slower meters record their own samples once each.
+		Assert::AreEqual(3U, histories.Get(3).GetCount());
+		Assert::AreEqual(6.0, histories.Get(3).Get(0));
+		Assert::AreEqual(3.0, histories.Get(3).Get(1));
+		Assert::AreEqual(0.0, histories.Get(3).Get(2));
+
+		// Separate passes (e.g. !UpdateMeter without a skin update) append values.
+		histories.Get(3).Push(9, 1.0);
+		histories.Get(3).Push(10, 2.0);
+		Assert::AreEqual(5U, histories.Get(3).GetCount());
+		Assert::AreEqual(2.0, histories.Get(3).Get(0));
+		Assert::AreEqual(1.0, histories.Get(3).Get(1));
+	}
+
+	TEST_METHOD(TestGetCount)
+	{
+		MeasureHistory history;
+		history.Push(1.0);  // Ignored without capacity
+		Assert::AreEqual(0U, history.GetCount());
+
+		history.Reserve(3);
+		history.Push(1, 1.0);
+		history.Push(1, 2.0);  // Replaced
+		Assert::AreEqual(1U, history.GetCount());
+		history.Push(2, 3.0);
+		history.Push(4.0);
+		Assert::AreEqual(3U, history.GetCount());
+
+		// Growing does not append values.
+		history.Reserve(MeasureHistory::BLOCK_SIZE + 1);
+		Assert::AreEqual(3U, history.GetCount());
+
+		history.Clear();
+		Assert::AreEqual((UINT)(3 + MeasureHistory::BLOCK_SIZE * 2), history.GetCount());
+	}
+
+	TEST_METHOD(TestGetRange)
+	{
+		MeasureHistory plain;
+		MeasureHistory summarized;
+		plain.Reserve(100);
+		summarized.Reserve(50, true);
+		summarized.Reserve(100);
+		Assert::IsTrue(summarized.HasSummaries());
+		Assert::IsFalse(plain.HasSummaries());
+
+		std::vector<double> values;
+		int tick = 0;
+		unsigned int seed = 1;
+		for (int i = 0; i < 1000; ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			const double value = (double)((seed >> 8) % 10000) - 5000.0;
+			const bool sameTick = !values.empty() && seed % 3 == 0;
+			if (sameTick)
+			{
+				values.back() = value;
+			}
+			else
+			{
+				values.push_back(value);
+				++tick;
+			}
+
+			plain.Push(tick, value);
+			summarized.Push(tick, value);
+
+			if (i == 500)
+			{
+				// Enabling the summaries later works as well.
+				plain.Reserve(128, true);
+			}
+
+			for (size_t count = 1; count <= summarized.GetCapacity(); count += 7)
+			{
+				double minExpected = 0.0;
+				double maxExpected = 0.0;
+				for (size_t age = 0; age < count; ++age)
+				{
+					const double v = (age < values.size()) ? values[values.size() - 1 - age] : 0.0;
+					minExpected = (age == 0) ? v : min(minExpected, v);
+					maxExpected = (age == 0) ? v : max(maxExpected, v);
+					Assert::AreEqual(v, summarized.Get(age));
+				}
+
+				double minValue, maxValue;
+				summarized.GetRange(count, minValue, maxValue);
+				Assert::AreEqual(minExpected, minValue);
+				Assert::AreEqual(maxExpected, maxValue);
+
+				plain.GetRange(count, minValue, maxValue);
+				Assert::AreEqual(minExpected, minValue);
+				Assert::AreEqual(maxExpected, maxValue);
+			}
+		}
+	}
+};
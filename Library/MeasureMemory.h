@@ -20,6 +20,7 @@ public:
 	MeasureMemory& operator=(MeasureMemory other) = delete;
 
 	virtual UINT GetTypeID() { return TypeID<MeasureMemory>(); }
+	virtual bool IsThreadSafe() { return true; }
 
 protected:
 	virtual void ReadOptions(ConfigParser& parser, const WCHAR* section);
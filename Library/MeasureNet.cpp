@@ -318,7 +318,7 @@ void MeasureNet::ReadOptions(ConfigParser& parser, const WCHAR* section)
 		{
 			m_MaxValue = 1.0;
 			m_LogMaxValue = true;
-			m_MedianValues.clear();
+			m_LogMaxMedian.Clear();
 		}
 	}
 	else
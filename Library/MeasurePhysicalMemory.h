@@ -20,6 +20,7 @@ public:
 	MeasurePhysicalMemory& operator=(MeasurePhysicalMemory other) = delete;
 
 	virtual UINT GetTypeID() { return TypeID<MeasurePhysicalMemory>(); }
+	virtual bool IsThreadSafe() { return true; }
 
 protected:
 	virtual void ReadOptions(ConfigParser& parser, const WCHAR* section);
@@ -14,6 +14,7 @@
 
 MeasurePlugin::MeasurePlugin(Skin* skin, const WCHAR* name) : Measure(skin, name),
 	m_Plugin(),
+	m_Flags(),
 	m_ReloadFunc(),
 	m_ID(),
 	m_Update2(false),
@@ -69,8 +70,12 @@ void MeasurePlugin::UpdateValue()
 			}
 		}
 
-		// Reset to default
-		System::ResetWorkingDirectory();
+		// Reset to default. Thread-safe plugins may run concurrently and must not change it, so
+		// Skin::Update resets it once after the parallel update.
+		if (!IsThreadSafe())
+		{
+			System::ResetWorkingDirectory();
+		}
 	}
 }
 
@@ -135,6 +140,9 @@ void MeasurePlugin::ReadOptions(ConfigParser& parser, const WCHAR* section)
 	m_GetStringFunc = GetProcAddress(m_Plugin, "GetString");
 	m_ExecuteBangFunc = GetProcAddress(m_Plugin, "ExecuteBang");
 
+	FARPROC getPluginFlagsFunc = GetProcAddress(m_Plugin, "GetPluginFlags");
+	m_Flags = getPluginFlagsFunc ? ((GETPLUGINFLAGS)getPluginFlagsFunc)() : 0;
+
 	// Remove current directory from DLL search path
 	SetDllDirectory(L"");
 
@@ -174,7 +182,7 @@ void MeasurePlugin::ReadOptions(ConfigParser& parser, const WCHAR* section)
 		{
 			m_MaxValue = 1.0;
 			m_LogMaxValue = true;
-			m_MedianValues.clear();
+			m_LogMaxMedian.Clear();
 		}
 		else
 		{
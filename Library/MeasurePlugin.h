@@ -17,6 +17,7 @@ typedef UINT (*UPDATE)(UINT);
 typedef double (*UPDATE2)(UINT);
 typedef LPCTSTR (*GETSTRING)(UINT, UINT);
 typedef void (*EXECUTEBANG)(LPCWSTR, UINT);
+typedef UINT (*GETPLUGINFLAGS)();
 
 typedef void (*NEWINITIALIZE)(void*, void*);
 typedef void (*NEWRELOAD)(void*, void*, double*);
@@ -39,6 +40,8 @@ public:
 	virtual const WCHAR* GetStringValue();
 	virtual void Command(const std::wstring& command);
 
+	virtual bool IsThreadSafe() { return (m_Flags & RMPF_THREADSAFEUPDATE) != 0; }
+
 protected:
 	virtual void ReadOptions(ConfigParser& parser, const WCHAR* section);
 	virtual void UpdateValue();
@@ -47,6 +50,7 @@ private:
 	bool IsNewApi() { return m_ReloadFunc != nullptr; }
 
 	HMODULE m_Plugin;
+	UINT m_Flags;
 
 	void* m_ReloadFunc;
 
@@ -20,6 +20,7 @@ public:
 	MeasureRegistry& operator=(MeasureRegistry other) = delete;
 
 	virtual UINT GetTypeID() { return TypeID<MeasureRegistry>(); }
+	virtual bool IsThreadSafe() { return true; }
 
 	virtual const WCHAR* GetStringValue();
 
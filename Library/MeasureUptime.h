@@ -20,6 +20,7 @@ public:
 	MeasureUptime& operator=(MeasureUptime other) = delete;
 
 	virtual UINT GetTypeID() { return TypeID<MeasureUptime>(); }
+	virtual bool IsThreadSafe() { return true; }
 
 	virtual const WCHAR* GetStringValue();
 
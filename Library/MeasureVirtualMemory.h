@@ -20,6 +20,7 @@ public:
 	MeasureVirtualMemory& operator=(MeasureVirtualMemory other) = delete;
 
 	virtual UINT GetTypeID() { return TypeID<MeasureVirtualMemory>(); }
+	virtual bool IsThreadSafe() { return true; }
 
 protected:
 	virtual void ReadOptions(ConfigParser& parser, const WCHAR* section);
@@ -9,11 +9,13 @@
 #include "MeasureWebParser.h"
 #include "Rainmeter.h"
 #include "System.h"
+#include "WebFetcher.h"
 #include "pcre/config.h"
 #include "pcre/pcre.h"
 #include "../Common/CharacterEntityReference.h"
 #include "../Common/StringUtil.h"
 #include "../Common/FileUtil.h"
+#include "../Common/RegExpCache.h"
 
 void ShowError(MeasureWebParser* measure, WCHAR* description);
 
@@ -192,13 +194,16 @@ private:
 	std::wstring m_GlobalUserAgent;
 };
 
-BYTE* DownloadUrl(HINTERNET handle, std::wstring& url, std::wstring& headers, DWORD* dataSize, bool forceReload);
+std::shared_ptr<const WebFetcher::Data> DownloadUrl(HINTERNET handle, const std::wstring& url, const std::wstring& headers, bool forceReload);
 
 CRITICAL_SECTION g_CriticalSection;
 ProxyCachePool* g_ProxyCachePool = nullptr;
 UINT g_InstanceCount = 0;
 
-static std::vector<MeasureWebParser*> g_Measures;
+// Measures that reference another measure with [MeasureName] in the Url, keyed by the skin and
+// the lowercase name of the referenced measure.
+typedef std::pair<const Skin*, std::wstring> ParentKey;
+static std::map<ParentKey, std::vector<MeasureWebParser*>> g_Children;
 
 #define OVECCOUNT 300    // should be a multiple of 3
 
@@ -213,6 +218,16 @@ void SetupGlobalProxySetting()
 		GetPrivateProfileString(L"WebParser.dll", L"ProxyServer", nullptr, server, MAX_PATH, file);
 		GetPrivateProfileString(L"WebParser.dll", L"UserAgent", nullptr, agent, MAX_PATH, file);
 		g_ProxyCachePool = new ProxyCachePool(server, agent);
+
+		// Responses are shared by all WebParser measures for this many seconds. By default, each
+		// request is still sent but concurrent requests are coalesced and unchanged responses are
+		// revalidated with a conditional request.
+		const UINT cacheTime = GetPrivateProfileInt(L"WebParser.dll", L"CacheTime", (int)(WebFetcher::DEFAULT_TIME_TO_LIVE / 1000), file);
+		GetWebFetcher().SetTimeToLive(cacheTime * 1000ULL);
+
+		// Larger responses (in kilobytes, after decompression) are treated as fetch errors.
+		const UINT maxBodySize = GetPrivateProfileInt(L"WebParser.dll", L"MaxBodySize", WebFetcher::DEFAULT_MAX_BODY_SIZE / 1024, file);
+		GetWebFetcher().SetMaxBodySize(maxBodySize * (size_t)1024);
 	}
 }
 
@@ -220,6 +235,17 @@ void ClearGlobalProxySetting()
 {
 	delete g_ProxyCachePool;
 	g_ProxyCachePool = nullptr;
+
+	WebFetcher& fetcher = GetWebFetcher();
+	if (GetRainmeter().GetDebug())
+	{
+		const WebFetcher::Stats stats = fetcher.GetStats();
+		LogDebugF(
+			L"WebParser cache: %llu requests, %llu hits, %llu coalesced, %llu revalidated, %llu downloads, %llu errors",
+			stats.requests, stats.hits, stats.coalesced, stats.revalidated, stats.downloads, stats.errors);
+	}
+
+	fetcher.Clear();
 }
 
 void SetupProxySetting(ProxySetting& setting, const std::wstring proxyServer, const std::wstring userAgent)
@@ -245,8 +271,6 @@ void ClearProxySetting(ProxySetting& setting)
 }
 
 MeasureWebParser::MeasureWebParser(Skin* skin, const WCHAR* name) : Measure(skin, name),
-	m_ThreadHandle(),
-	m_DlThreadHandle(),
 	m_Codepage(),
 	m_StringIndex(),
 	m_StringIndex2(),
@@ -256,10 +280,10 @@ MeasureWebParser::MeasureWebParser(Skin* skin, const WCHAR* name) : Measure(skin
 	m_UpdateRate(),
 	m_UpdateCounter(),
 	m_Download(),
-	m_ForceReload()
+	m_ForceReload(),
+	m_Fetching(false),
+	m_Downloading(false)
 {
-	g_Measures.push_back(this);
-
 	if (g_InstanceCount == 0)
 	{
 		System::InitializeCriticalSection(&g_CriticalSection);
@@ -277,27 +301,13 @@ MeasureWebParser::MeasureWebParser(Skin* skin, const WCHAR* name) : Measure(skin
 
 MeasureWebParser::~MeasureWebParser()
 {
-	if (m_ThreadHandle)
-	{
-		// Thread is killed inside critical section so that itself is not inside one when it is terminated
-		EnterCriticalSection(&g_CriticalSection);
-
-		TerminateThread(m_ThreadHandle, 0);
-		m_ThreadHandle = nullptr;
-
-		LeaveCriticalSection(&g_CriticalSection);
-	}
-
-	if (m_DlThreadHandle)
-	{
-		// Thread is killed inside critical section so that itself is not inside one when it is terminated
-		EnterCriticalSection(&g_CriticalSection);
-
-		TerminateThread(m_DlThreadHandle, 0);
-		m_DlThreadHandle = nullptr;
+	// Once removed from the index, this measure is not updated by the parent measures anymore.
+	EnterCriticalSection(&g_CriticalSection);
+	SetParents(std::vector<std::wstring>());
+	LeaveCriticalSection(&g_CriticalSection);
 
-		LeaveCriticalSection(&g_CriticalSection);
-	}
+	// Requests in progress finish in the background without touching this measure.
+	GetWebTaskPool().Cancel(this);
 
 	if (m_DownloadFile.empty())  // cache mode
 	{
@@ -310,9 +320,6 @@ MeasureWebParser::~MeasureWebParser()
 
 	ClearProxySetting(m_Proxy);
 
-	auto iter = std::find(g_Measures.begin(), g_Measures.end(), this);
-	g_Measures.erase(iter);
-
 	--g_InstanceCount;
 	if (g_InstanceCount == 0)
 	{
@@ -350,6 +357,9 @@ void MeasureWebParser::ReadOptions(ConfigParser& parser, const WCHAR* section)
 
 	m_Url = url;
 
+	// Register with the measures referenced in the Url.
+	SetParents(GetParentNames(url));
+
 	m_Headers.clear();
 	size_t hNum = 1;
 	std::wstring hOption = L"Header";
@@ -417,17 +427,12 @@ void MeasureWebParser::UpdateValue()
 	if (m_Download && m_RegExp.empty() && m_Url.find(L'[') == std::wstring::npos)
 	{
 		// If RegExp is empty download the file that is pointed by the Url
-		if (m_DlThreadHandle == 0)
+		if (!m_Downloading)
 		{
 			if (m_UpdateCounter == 0)
 			{
-				// Launch a new thread to fetch the web data
-				unsigned int id;
-				HANDLE threadHandle = (HANDLE)_beginthreadex(nullptr, 0, NetworkDownloadThreadProc, this, 0, &id);
-				if (threadHandle)
-				{
-					m_DlThreadHandle = threadHandle;
-				}
+				// Queue a task to fetch the web data
+				StartTask(true);
 			}
 
 			m_UpdateCounter++;
@@ -454,17 +459,12 @@ void MeasureWebParser::UpdateValue()
 		if (m_Url.size() > 0 && m_Url.find(L'[') == std::wstring::npos)
 		{
 			// This is not a reference; need to update.
-			if (m_ThreadHandle == 0 && m_DlThreadHandle == 0)
+			if (!m_Fetching && !m_Downloading)
 			{
 				if (m_UpdateCounter == 0)
 				{
-					// Launch a new thread to fetch the web data
-					unsigned int id;
-					HANDLE threadHandle = (HANDLE)_beginthreadex(nullptr, 0, NetworkThreadProc, this, 0, &id);
-					if (threadHandle)
-					{
-						m_ThreadHandle = threadHandle;
-					}
+					// Queue a task to fetch the web data
+					StartTask(false);
 				}
 
 				m_UpdateCounter++;
@@ -495,17 +495,133 @@ const WCHAR* MeasureWebParser::GetStringValue()
 	return CheckSubstitute(s_ResultString.c_str());
 }
 
+/*
+** Queues a task to fetch and parse the page or to download the file.
+**
+*/
+void MeasureWebParser::StartTask(bool download)
+{
+	EnterCriticalSection(&g_CriticalSection);
+
+	bool& running = download ? m_Downloading : m_Fetching;
+	running = true;
+
+	// Tasks are limited per host so use the url that is going to be downloaded if it is known.
+	const std::wstring& url = (download && m_ResultString.find(L"://") != std::wstring::npos) ? m_ResultString : m_Url;
+	auto task = download ? NetworkDownloadTask : NetworkTask;
+	if (!GetWebTaskPool().Submit(this, url, [this, task](WebTaskPool::Context& context) { task(this, context); }))
+	{
+		running = false;
+	}
+
+	LeaveCriticalSection(&g_CriticalSection);
+}
+
+/*
+** Returns the lowercase names within the innermost brackets of the url, e.g. "parent" for both
+** "[Parent]" and "x[a[Parent]]".
+**
+*/
+std::vector<std::wstring> MeasureWebParser::GetParentNames(const std::wstring& url)
+{
+	std::vector<std::wstring> parents;
+	std::wstring::size_type start = std::wstring::npos;
+	for (std::wstring::size_type i = 0, isize = url.length(); i < isize; ++i)
+	{
+		if (url[i] == L'[')
+		{
+			start = i;
+		}
+		else if (url[i] == L']' && start != std::wstring::npos)
+		{
+			std::wstring parent(url, start + 1, i - start - 1);
+			StringUtil::ToLowerCase(parent);
+			if (std::find(parents.begin(), parents.end(), parent) == parents.end())
+			{
+				parents.push_back(parent);
+			}
+			start = std::wstring::npos;
+		}
+	}
+	return parents;
+}
+
+/*
+** Moves this measure to the children of the given measures. The caller must hold the critical
+** section.
+**
+*/
+void MeasureWebParser::SetParents(const std::vector<std::wstring>& parents)
+{
+	if (parents == m_Parents) return;
+
+	for (const auto& parent : m_Parents)
+	{
+		auto iter = g_Children.find(ParentKey(GetSkin(), parent));
+		if (iter != g_Children.end())
+		{
+			std::vector<MeasureWebParser*>& children = iter->second;
+			children.erase(std::find(children.begin(), children.end(), this));
+			if (children.empty())
+			{
+				g_Children.erase(iter);
+			}
+		}
+	}
+
+	for (const auto& parent : parents)
+	{
+		g_Children[ParentKey(GetSkin(), parent)].push_back(this);
+	}
+
+	m_Parents = parents;
+}
+
+/*
+** Returns the measures that reference this one. Children removed from the index after this are
+** deleted only after the calling task has left the measure.
+**
+*/
+std::vector<MeasureWebParser*> MeasureWebParser::GetChildren()
+{
+	std::wstring name = GetOriginalName();
+	StringUtil::ToLowerCase(name);
+
+	std::vector<MeasureWebParser*> children;
+
+	EnterCriticalSection(&g_CriticalSection);
+	auto iter = g_Children.find(ParentKey(GetSkin(), name));
+	if (iter != g_Children.end())
+	{
+		children = iter->second;
+	}
+	LeaveCriticalSection(&g_CriticalSection);
+
+	return children;
+}
+
 // Fetches the data from the net and parses the page
-unsigned __stdcall MeasureWebParser::NetworkThreadProc(void* pParam)
+void MeasureWebParser::NetworkTask(MeasureWebParser* measure, WebTaskPool::Context& context)
 {
-	auto* measure = (MeasureWebParser*)pParam;
-	DWORD dwSize = 0;
+	// The measure may be deleted while the request is in progress so it is accessed only within
+	// Enter() and Leave().
+	if (!context.Enter()) return;
 
 	if (GetRainmeter().GetDebug())
 	{
 		LogDebugF(measure, L"Fetching: %s", measure->m_Url.c_str());
 	}
-	BYTE* data = DownloadUrl(measure->m_Proxy.handle, measure->m_Url, measure->m_Headers, &dwSize, measure->m_ForceReload);
+
+	const HINTERNET handle = measure->m_Proxy.handle;
+	const std::wstring url = measure->m_Url;
+	const std::wstring headers = measure->m_Headers;
+	const bool forceReload = measure->m_ForceReload;
+	context.Leave();
+
+	std::shared_ptr<const WebFetcher::Data> data = DownloadUrl(handle, url, headers, forceReload);
+
+	if (!context.Enter()) return;
+
 	if (!data)
 	{
 		ShowError(measure, L"Fetch error");
@@ -517,6 +633,11 @@ unsigned __stdcall MeasureWebParser::NetworkThreadProc(void* pParam)
 	}
 	else
 	{
+		// The data is not null terminated and may be empty.
+		static const BYTE c_EmptyData[2] = { 0 };
+		const BYTE* rawData = data->empty() ? c_EmptyData : data->data();
+		const DWORD rawSize = (DWORD)data->size();
+
 		if (measure->m_Debug == 2)
 		{
 			// Dump to a file
@@ -524,7 +645,7 @@ unsigned __stdcall MeasureWebParser::NetworkThreadProc(void* pParam)
 			FILE* file = _wfopen(measure->m_DebugFileLocation.c_str(), L"wb");
 			if (file)
 			{
-				fwrite(data, sizeof(BYTE), dwSize, file);
+				fwrite(rawData, sizeof(BYTE), rawSize, file);
 				fclose(file);
 			}
 			else
@@ -533,17 +654,14 @@ unsigned __stdcall MeasureWebParser::NetworkThreadProc(void* pParam)
 			}
 		}
 
-		measure->ParseData(data, dwSize);
-
-		free(data);
+		measure->ParseData(rawData, rawSize);
 	}
 
 	EnterCriticalSection(&g_CriticalSection);
-	CloseHandle(measure->m_ThreadHandle);
-	measure->m_ThreadHandle = 0;
+	measure->m_Fetching = false;
 	LeaveCriticalSection(&g_CriticalSection);
 
-	return 0;   // thread completed successfully
+	context.Leave();
 }
 
 void MeasureWebParser::ParseData(const BYTE* rawData, DWORD rawSize, bool utf16Data)
@@ -559,11 +677,10 @@ void MeasureWebParser::ParseData(const BYTE* rawData, DWORD rawSize, bool utf16D
 	int rc;
 	bool doErrorAction = false;
 
-	// Compile the regular expression in the first argument
-	pcre16* re = pcre16_compile(
-		(PCRE_SPTR16)m_RegExp.c_str(),
-		PCRE_UTF16, &error, &erroffset, nullptr);
-	if (re != nullptr)
+	// Compile the regular expression in the first argument. Children parse every match of the parent
+	// with the same pattern so the compiled pattern is shared.
+	auto re = GetRegExpCache().Get(m_RegExp, PCRE_UTF16, &error, &erroffset);
+	if (re)
 	{
 		// Compilation succeeded: match the subject in the second argument
 		std::wstring buffer;
@@ -576,7 +693,7 @@ void MeasureWebParser::ParseData(const BYTE* rawData, DWORD rawSize, bool utf16D
 			dataLength = (DWORD)buffer.length();
 		}
 
-		rc = pcre16_exec(re, nullptr, (PCRE_SPTR16)data, dataLength, 0, 0, ovector, OVECCOUNT);
+		rc = re->Exec(data, (int)dataLength, 0, 0, ovector, OVECCOUNT);
 		if (rc >= 0)
 		{
 			if (rc == 0)
@@ -628,75 +745,66 @@ void MeasureWebParser::ParseData(const BYTE* rawData, DWORD rawSize, bool utf16D
 				}
 
 				// Update the references
-				auto i = g_Measures.begin();
 				std::wstring compareStr = L"[";
 				compareStr += GetOriginalName();
 				compareStr += L']';
-				for ( ; i != g_Measures.end(); ++i)
+
+				const std::vector<MeasureWebParser*> children = GetChildren();
+				for (auto i = children.begin(); i != children.end(); ++i)
 				{
-					if (GetSkin() == (*i)->GetSkin() &&
-						StringUtil::CaseInsensitiveFind((*i)->m_Url, compareStr) != std::wstring::npos)
+					if ((*i)->m_StringIndex < rc)
 					{
-						if ((*i)->m_StringIndex < rc)
+						const WCHAR* match = data + ovector[2 * (*i)->m_StringIndex];
+						int matchLen = ovector[2 * (*i)->m_StringIndex + 1] - ovector[2 * (*i)->m_StringIndex];
+						if (!(*i)->m_RegExp.empty())
 						{
-							const WCHAR* match = data + ovector[2 * (*i)->m_StringIndex];
-							int matchLen = ovector[2 * (*i)->m_StringIndex + 1] - ovector[2 * (*i)->m_StringIndex];
-							if (!(*i)->m_RegExp.empty())
-							{
-								// Change the index and parse the substring
-								int index = (*i)->m_StringIndex;
-								(*i)->m_StringIndex = (*i)->m_StringIndex2;
-								(*i)->ParseData((BYTE*)match, matchLen * 2, true);
-								(*i)->m_StringIndex = index;
-							}
-							else
-							{
-								// Set the result
-								EnterCriticalSection(&g_CriticalSection);
-
-								// Substitude the [measure] with result
-								(*i)->m_ResultString = (*i)->m_Url;
-								(*i)->m_ResultString.replace(
-									StringUtil::CaseInsensitiveFind((*i)->m_ResultString, compareStr),
-									compareStr.size(), match, matchLen);
-								CharacterEntityReference::Decode((*i)->m_ResultString, (*i)->m_DecodeCharacterReference);
-
-								// Start download threads for the references
-								if ((*i)->m_Download)
-								{
-									// Start the download thread
-									unsigned int id;
-									HANDLE threadHandle = (HANDLE)_beginthreadex(nullptr, 0, NetworkDownloadThreadProc, (*i), 0, &id);
-									if (threadHandle)
-									{
-										(*i)->m_DlThreadHandle = threadHandle;
-									}
-								}
-
-								LeaveCriticalSection(&g_CriticalSection);
-							}
+							// Change the index and parse the substring
+							int index = (*i)->m_StringIndex;
+							(*i)->m_StringIndex = (*i)->m_StringIndex2;
+							(*i)->ParseData((BYTE*)match, matchLen * 2, true);
+							(*i)->m_StringIndex = index;
 						}
 						else
 						{
-							if (m_LogSubstringErrors) LogWarningF(*i, L"Not enough substrings");
-
-							// Clear the old result
+							// Set the result
 							EnterCriticalSection(&g_CriticalSection);
-							(*i)->m_ResultString.clear();
+
+							// Substitude the [measure] with result
+							(*i)->m_ResultString = (*i)->m_Url;
+							(*i)->m_ResultString.replace(
+								StringUtil::CaseInsensitiveFind((*i)->m_ResultString, compareStr),
+								compareStr.size(), match, matchLen);
+							CharacterEntityReference::Decode((*i)->m_ResultString, (*i)->m_DecodeCharacterReference);
+
+							// Start download tasks for the references
 							if ((*i)->m_Download)
 							{
-								if ((*i)->m_DownloadFile.empty())  // cache mode
+								(*i)->StartTask(true);
+							}
+
+							LeaveCriticalSection(&g_CriticalSection);
+						}
+					}
+					else
+					{
+						if (m_LogSubstringErrors) LogWarningF(*i, L"Not enough substrings");
+
+						// Clear the old result
+						EnterCriticalSection(&g_CriticalSection);
+						(*i)->m_ResultString.clear();
+						if ((*i)->m_Download)
+						{
+							if ((*i)->m_DownloadFile.empty())  // cache mode
+							{
+								if (!(*i)->m_DownloadedFile.empty())
 								{
-									if (!(*i)->m_DownloadedFile.empty())
-									{
-										// Delete old downloaded file
-										DeleteFile((*i)->m_DownloadedFile.c_str());
-									}
+									// Delete old downloaded file
+									DeleteFile((*i)->m_DownloadedFile.c_str());
 								}
-								(*i)->m_DownloadedFile.clear();
 							}
-							LeaveCriticalSection(&g_CriticalSection);
+							(*i)->m_DownloadedFile.clear();
 						}
+						LeaveCriticalSection(&g_CriticalSection);
 					}
 				}
 			}
@@ -711,23 +819,12 @@ void MeasureWebParser::ParseData(const BYTE* rawData, DWORD rawSize, bool utf16D
 			m_ResultString = m_ErrorString;
 
 			// Update the references
-			auto i = g_Measures.begin();
-			std::wstring compareStr = L"[";
-			compareStr += GetOriginalName();
-			compareStr += L']';
-			for ( ; i != g_Measures.end(); ++i)
+			for (auto* child : GetChildren())
 			{
-				if ((StringUtil::CaseInsensitiveFind((*i)->m_Url, compareStr) != std::wstring::npos) &&
-					(GetSkin() == (*i)->GetSkin()))
-				{
-					(*i)->m_ResultString = (*i)->m_ErrorString;
-				}
+				child->m_ResultString = child->m_ErrorString;
 			}
 			LeaveCriticalSection(&g_CriticalSection);
 		}
-
-		// Release memory used for the compiled pattern
-		pcre16_free(re);
 	}
 	else
 	{
@@ -738,13 +835,8 @@ void MeasureWebParser::ParseData(const BYTE* rawData, DWORD rawSize, bool utf16D
 
 	if (m_Download)
 	{
-		// Start the download thread
-		unsigned int id;
-		HANDLE threadHandle = (HANDLE)_beginthreadex(nullptr, 0, NetworkDownloadThreadProc, this, 0, &id);
-		if (threadHandle)
-		{
-			m_DlThreadHandle = threadHandle;
-		}
+		// Start the download task
+		StartTask(true);
 	}
 
 	if (doErrorAction && !m_OnRegExpErrAction.empty())
@@ -758,9 +850,10 @@ void MeasureWebParser::ParseData(const BYTE* rawData, DWORD rawSize, bool utf16D
 }
 
 // Downloads file from the net
-unsigned __stdcall MeasureWebParser::NetworkDownloadThreadProc(void* pParam)
+void MeasureWebParser::NetworkDownloadTask(MeasureWebParser* measure, WebTaskPool::Context& context)
 {
-	auto* measure = (MeasureWebParser*)pParam;
+	if (!context.Enter()) return;
+
 	const bool download = !measure->m_DownloadFile.empty();
 	bool ready = false;
 
@@ -987,10 +1080,29 @@ unsigned __stdcall MeasureWebParser::NetworkDownloadThreadProc(void* pParam)
 				LogDebugF(measure, L"Downloading url '%s' to: %s", url.c_str(), fullpath.c_str());
 			}
 
+			// The measure is not accessed while downloading.
+			context.Leave();
+
 			HRESULT resultCoInitialize = CoInitialize(nullptr);  // requires before calling URLDownloadToFile function
 
 			// Download the file
 			HRESULT result = URLDownloadToFile(nullptr, url.c_str(), fullpath.c_str(), 0, nullptr);
+
+			if (SUCCEEDED(resultCoInitialize))
+			{
+				CoUninitialize();
+			}
+
+			if (!context.Enter())
+			{
+				if (!download)  // cache mode
+				{
+					// Nobody is going to use the file
+					DeleteFile(fullpath.c_str());
+				}
+				return;
+			}
+
 			if (result == S_OK)
 			{
 				EnterCriticalSection(&g_CriticalSection);
@@ -1042,11 +1154,6 @@ unsigned __stdcall MeasureWebParser::NetworkDownloadThreadProc(void* pParam)
 					GetRainmeter().DelayedExecuteCommand(measure->m_OnDownloadErrAction.c_str(), measure->GetSkin());
 				}
 			}
-
-			if (SUCCEEDED(resultCoInitialize))
-			{
-				CoUninitialize();
-			}
 		}
 		else
 		{
@@ -1083,18 +1190,17 @@ unsigned __stdcall MeasureWebParser::NetworkDownloadThreadProc(void* pParam)
 	}
 
 	EnterCriticalSection(&g_CriticalSection);
-	CloseHandle(measure->m_DlThreadHandle);
-	measure->m_DlThreadHandle = 0;
+	measure->m_Downloading = false;
 	LeaveCriticalSection(&g_CriticalSection);
 
-	return 0;   // thread completed successfully
+	context.Leave();
 }
 
 /*
-	Downloads the given url and returns the webpage as dynamically allocated string.
-	You need to free the returned string after use!
+	Downloads the given url. Requests other than for local files go through the shared WebFetcher
+	so measures fetching the same url share the response. Returns nullptr on error.
 */
-BYTE* DownloadUrl(HINTERNET handle, std::wstring& url, std::wstring& headers, DWORD* dataSize, bool forceReload)
+std::shared_ptr<const WebFetcher::Data> DownloadUrl(HINTERNET handle, const std::wstring& url, const std::wstring& headers, bool forceReload)
 {
 	if (_wcsnicmp(url.c_str(), L"file://", 7) == 0)  // Local file
 	{
@@ -1107,62 +1213,16 @@ BYTE* DownloadUrl(HINTERNET handle, std::wstring& url, std::wstring& headers, DW
 		}
 		
 		size_t fileSize = 0;
-		BYTE* buffer = FileUtil::ReadFullFile(path, &fileSize).release();
-		*dataSize = (DWORD)fileSize;
-
-		return buffer;
-	}
-
-	DWORD flags = INTERNET_FLAG_RESYNCHRONIZE;
-	if (forceReload)
-	{
-		flags = INTERNET_FLAG_RELOAD;
-	}
-
-	HINTERNET hUrlDump = InternetOpenUrl(handle, url.c_str(), headers.c_str(), -1L, flags, 0);
-	if (!hUrlDump)
-	{
-		return nullptr;
-	}
-
-	// Allocate buffer with 3 extra bytes for triple null termination in case the string is
-	// invalid (e.g. when incorrectly using the UTF-16LE codepage for the data).
-	const int CHUNK_SIZE = 8192;
-	DWORD bufferSize = CHUNK_SIZE;
-	BYTE* buffer = (BYTE*)malloc(bufferSize + 3);
-	*dataSize = 0;
-
-	// Read the data.
-	do
-	{
-		DWORD readSize;
-		if (!InternetReadFile(hUrlDump, buffer + *dataSize, bufferSize - *dataSize, &readSize))
+		std::unique_ptr<BYTE[]> buffer = FileUtil::ReadFullFile(path, &fileSize);
+		if (!buffer)
 		{
-			free(buffer);
-			InternetCloseHandle(hUrlDump);
 			return nullptr;
 		}
-		else if (readSize == 0)
-		{
-			// All data read.
-			break;
-		}
-
-		*dataSize += readSize;
 
-		bufferSize += CHUNK_SIZE;
-		buffer = (BYTE*)realloc(buffer, bufferSize + 3);
+		return std::make_shared<const WebFetcher::Data>(buffer.get(), buffer.get() + fileSize);
 	}
-	while (true);
-
-	InternetCloseHandle(hUrlDump);
 
-	// Triple null terminate the buffer.
-	buffer[*dataSize] = 0;
-	buffer[*dataSize + 1] = 0;
-	buffer[*dataSize + 2] = 0;
-
-	return buffer;
+	return GetWebFetcher().Fetch(handle, url, headers, forceReload);
 }
 
 /*
@@ -1213,30 +1273,15 @@ void MeasureWebParser::Command(const std::wstring& command)
 {
 	const WCHAR* args = command.c_str();
 
-	// Kill the threads (if any) and reset the update counter
+	// Cancel the tasks (if any) and reset the update counter
 	if (_wcsicmp(args, L"UPDATE") == 0)
 	{
-		if (m_ThreadHandle)
-		{
-			// Thread is killed inside critical section so that itself is not inside one when it is terminated
-			EnterCriticalSection(&g_CriticalSection);
-
-			TerminateThread(m_ThreadHandle, 0);
-			m_ThreadHandle = nullptr;
-
-			LeaveCriticalSection(&g_CriticalSection);
-		}
+		GetWebTaskPool().Cancel(this);
 
-		if (m_DlThreadHandle)
-		{
-			// Thread is killed inside critical section so that itself is not inside one when it is terminated
-			EnterCriticalSection(&g_CriticalSection);
-
-			TerminateThread(m_DlThreadHandle, 0);
-			m_DlThreadHandle = nullptr;
-
-			LeaveCriticalSection(&g_CriticalSection);
-		}
+		EnterCriticalSection(&g_CriticalSection);
+		m_Fetching = false;
+		m_Downloading = false;
+		LeaveCriticalSection(&g_CriticalSection);
 
 		m_UpdateCounter = 0;
 	}
@@ -1248,18 +1293,10 @@ void MeasureWebParser::Command(const std::wstring& command)
 		EnterCriticalSection(&g_CriticalSection);
 
 		// Update the references
-		auto i = g_Measures.begin();
-		std::wstring compareStr = L"[";
-		compareStr += GetOriginalName();
-		compareStr += L']';
-		for (; i != g_Measures.end(); ++i)
+		for (auto* child : GetChildren())
 		{
-			if ((StringUtil::CaseInsensitiveFind((*i)->m_Url, compareStr) != std::wstring::npos) &&
-				(GetSkin() == (*i)->GetSkin()))
-			{
-				(*i)->m_ResultString.clear();
-				(*i)->m_DownloadedFile.clear();
-			}
+			child->m_ResultString.clear();
+			child->m_DownloadedFile.clear();
 		}
 		LeaveCriticalSection(&g_CriticalSection);
 	}
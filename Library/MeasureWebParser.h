@@ -9,6 +9,7 @@
 #define RM_LIBRARY_MEASUREWEBPARSER_H_
 
 #include "Measure.h"
+#include "WebTaskPool.h"
 
 struct ProxySetting
 {
@@ -32,14 +33,19 @@ public:
 
 	const WCHAR* GetStringValue() override;
 
+	static std::vector<std::wstring> GetParentNames(const std::wstring& url);
+
 protected:
 	void ReadOptions(ConfigParser& parser, const WCHAR* section) override;
 	void UpdateValue() override;
 	void Command(const std::wstring& command) override;
 
 private:
-	static unsigned __stdcall NetworkThreadProc(void* pParam);
-	static unsigned __stdcall NetworkDownloadThreadProc(void* pParam);
+	static void NetworkTask(MeasureWebParser* measure, WebTaskPool::Context& context);
+	static void NetworkDownloadTask(MeasureWebParser* measure, WebTaskPool::Context& context);
+	void StartTask(bool download);
+	void SetParents(const std::vector<std::wstring>& parents);
+	std::vector<MeasureWebParser*> GetChildren();
 	void ParseData(const BYTE* rawData, DWORD rawSize, bool utf16Data = false);
 
 	std::wstring m_Url;
@@ -55,9 +61,8 @@ private:
 	std::wstring m_DownloadedFile;
 	std::wstring m_DebugFileLocation;
 	std::wstring m_Headers;
+	std::vector<std::wstring> m_Parents;
 	ProxySetting m_Proxy;
-	HANDLE m_ThreadHandle;
-	HANDLE m_DlThreadHandle;
 	int m_Codepage;
 	int m_StringIndex;
 	int m_StringIndex2;
@@ -67,6 +72,8 @@ private:
 	UINT m_UpdateCounter;
 	bool m_Download;
 	bool m_ForceReload;
+	bool m_Fetching;
+	bool m_Downloading;
 	bool m_LogSubstringErrors;
 };
 
@@ -0,0 +1,37 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "MeasureWebParser.h"
+#include "../Common/UnitTest.h"
+
+TEST_CLASS(Library_MeasureWebParser_Test)
+{
+public:
+	TEST_METHOD(TestGetParentNames)
+	{
+		typedef std::vector<std::wstring> Names;
+
+		Assert::IsTrue(MeasureWebParser::GetParentNames(L"http://example.com/") == Names());
+		Assert::IsTrue(MeasureWebParser::GetParentNames(L"[Parent]") == Names({ L"parent" }));
+		Assert::IsTrue(MeasureWebParser::GetParentNames(L"[A][b] [PARENT] [a]") == Names({ L"a", L"b", L"parent" }));
+
+		// Unmatched brackets are ignored.
+		Assert::IsTrue(MeasureWebParser::GetParentNames(L"x]y[Parent") == Names());
+		Assert::IsTrue(MeasureWebParser::GetParentNames(L"x]y[Parent]]") == Names({ L"parent" }));
+	}
+
+	TEST_METHOD(TestGetParentNamesNested)
+	{
+		typedef std::vector<std::wstring> Names;
+
+		// The names are taken from the innermost brackets.
+		Assert::IsTrue(MeasureWebParser::GetParentNames(L"[[Parent]]") == Names({ L"parent" }));
+		Assert::IsTrue(MeasureWebParser::GetParentNames(L"x[a[Parent]]") == Names({ L"parent" }));
+		Assert::IsTrue(MeasureWebParser::GetParentNames(L"[a[B]c[D]]") == Names({ L"b", L"d" }));
+	}
+};
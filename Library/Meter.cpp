@@ -47,7 +47,12 @@ Meter::Meter(Skin* skin, const WCHAR* name) : Section(skin, name),
 	m_SolidAngle(),
 	m_Padding(),
 	m_AntiAlias(false),
-	m_Initialized(false)
+	m_Initialized(false),
+	m_DrawnRect(),
+	m_Changed(false),
+	m_OptionsHash(),
+	m_CacheLayer(false),
+	m_LayerKey()
 {
 }
 
@@ -165,6 +170,62 @@ Gdiplus::Rect Meter::GetMeterRectPadding()
 	return meterRect;
 }
 
+/*
+** Reads the options and remembers a hash of their resolved values for CacheLayer=1.
+**
+*/
+void Meter::ReadOptions(ConfigParser& parser)
+{
+	ContentHash hash;
+	parser.StartOptionHashing(&hash);
+	ReadOptions(parser, GetName());
+	parser.StopOptionHashing();
+	parser.ClearStyleTemplate();
+
+	m_OptionsHash = hash.Get();
+}
+
+/*
+** Returns the area of the skin the meter draws to, including the bevel and the transformation.
+** Returns an empty rect if the meter is hidden.
+**
+*/
+Gdiplus::Rect Meter::GetDrawRect()
+{
+	if (m_Hidden) return Rect();
+
+	// The bevel is drawn 2 pixels outside the meter. The same margin also covers antialiasing.
+	Rect rect(GetX() - 2, GetY() - 2, m_W + 4, m_H + 4);
+
+	if (m_Transformation && !m_Transformation->IsIdentity())
+	{
+		PointF points[4] =
+		{
+			PointF((REAL)rect.GetLeft(), (REAL)rect.GetTop()),
+			PointF((REAL)rect.GetRight(), (REAL)rect.GetTop()),
+			PointF((REAL)rect.GetLeft(), (REAL)rect.GetBottom()),
+			PointF((REAL)rect.GetRight(), (REAL)rect.GetBottom())
+		};
+		m_Transformation->TransformPoints(points, _countof(points));
+
+		REAL left = points[0].X, top = points[0].Y, right = points[0].X, bottom = points[0].Y;
+		for (size_t i = 1; i < _countof(points); ++i)
+		{
+			left = min(left, points[i].X);
+			top = min(top, points[i].Y);
+			right = max(right, points[i].X);
+			bottom = max(bottom, points[i].Y);
+		}
+
+		rect.X = (INT)floor(left) - 1;
+		rect.Y = (INT)floor(top) - 1;
+		rect.Width = (INT)ceil(right) + 1 - rect.X;
+		rect.Height = (INT)ceil(bottom) + 1 - rect.Y;
+	}
+
+	return rect;
+}
+
 /*
 ** Checks if the given point is inside the meter.
 ** This function doesn't check Hidden state, so check it before calling this function if needed.
@@ -344,6 +405,12 @@ void Meter::ReadOptions(ConfigParser& parser, const WCHAR* section)
 
 	m_AntiAlias = parser.ReadBool(section, L"AntiAlias", false);
 
+	m_CacheLayer = parser.ReadBool(section, L"CacheLayer", false);
+	if (!m_CacheLayer)
+	{
+		m_Layer.reset();
+	}
+
 	std::vector<Gdiplus::REAL> matrix = parser.ReadFloats(section, L"TransformationMatrix");
 	if (matrix.size() == 6)
 	{
@@ -365,6 +432,73 @@ void Meter::ReadOptions(ConfigParser& parser, const WCHAR* section)
 	}
 }
 
+/*
+** Draws the meter using a cached layer of |drawRect| size. The meter is drawn to the layer again
+** only if its options or the values of its measures have changed since the last time. Returns
+** true if the cached layer was used as is.
+**
+*/
+bool Meter::DrawLayer(Gfx::Canvas& canvas, const Gdiplus::Rect& drawRect)
+{
+	ContentHash hash;
+	hash.Add(&m_OptionsHash, sizeof(m_OptionsHash));
+	hash.Add(drawRect.Width);
+	hash.Add(drawRect.Height);
+	hash.Add(drawRect.X - GetX());
+	hash.Add(drawRect.Y - GetY());
+	hash.Add(canvas.GetAccurateText() ? 1 : 0);
+
+	for (auto iter = m_Measures.cbegin(); iter != m_Measures.cend(); ++iter)
+	{
+		Measure* measure = *iter;
+		hash.Add(measure->GetValue());
+		hash.Add(measure->GetMinValue());
+		hash.Add(measure->GetMaxValue());
+
+		const WCHAR* str = measure->GetStringValue();
+		if (str)
+		{
+			hash.Add(str, wcslen(str));
+		}
+	}
+
+	const ULONGLONG key = hash.Get();
+	const bool cached = m_Layer && m_LayerKey == key;
+	if (!cached)
+	{
+		if (!m_Layer)
+		{
+			m_Layer.reset(new Gfx::Canvas());
+			m_Layer->Resize(drawRect.Width, drawRect.Height);
+		}
+		else if (m_Layer->GetW() != drawRect.Width || m_Layer->GetH() != drawRect.Height)
+		{
+			m_Layer->Resize(drawRect.Width, drawRect.Height);
+		}
+
+		m_Layer->SetAccurateText(canvas.GetAccurateText());
+		m_Layer->BeginDraw();
+		m_Layer->Clear();
+
+		// Draw as if the layer was placed at |drawRect| on the skin.
+		Matrix matrix(1.0f, 0.0f, 0.0f, 1.0f, (REAL)-drawRect.X, (REAL)-drawRect.Y);
+		if (m_Transformation && !m_Transformation->IsIdentity())
+		{
+			matrix.Multiply(m_Transformation, MatrixOrderPrepend);
+		}
+
+		m_Layer->SetTransform(matrix);
+		Draw(*m_Layer);
+		m_Layer->ResetTransform();
+		m_Layer->EndDraw();
+
+		m_LayerKey = key;
+	}
+
+	canvas.DrawCanvas(*m_Layer, drawRect.X, drawRect.Y);
+	return cached;
+}
+
 /*
 ** Binds this meter to the given measure. The same measure can be bound to
 ** several meters but one meter and only be bound to one measure.
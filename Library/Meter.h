@@ -13,6 +13,7 @@
 #include <gdiplus.h>
 #include <vector>
 #include <string>
+#include <memory>
 #include "Util.h"
 #include "ConfigParser.h"
 #include "Skin.h"
@@ -28,13 +29,19 @@ public:
 
 	Meter(const Meter& other) = delete;
 
-	void ReadOptions(ConfigParser& parser) { ReadOptions(parser, GetName()); parser.ClearStyleTemplate(); }
+	void ReadOptions(ConfigParser& parser);
 
 	virtual void Initialize();
 	virtual bool Update();
 	virtual bool Draw(Gfx::Canvas& canvas);
 	virtual bool HasActiveTransition() { return false; }
 
+	// Returns false if the meter depends on state that is not in its options or the current values
+	// of its measures (e.g. the history or the mouse) and therefore cannot use CacheLayer=1.
+	virtual bool IsLayerCacheable() { return true; }
+	bool GetCacheLayer() { return m_CacheLayer; }
+	bool DrawLayer(Gfx::Canvas& canvas, const Gdiplus::Rect& drawRect);
+
 	virtual int GetW() { return m_Hidden ? 0 : m_W; }
 	virtual int GetH() { return m_Hidden ? 0 : m_H; }
 	virtual int GetX(bool abs = false);
@@ -42,6 +49,7 @@ public:
 	RECT GetMeterRect();
 
 	Gdiplus::Rect GetMeterRectPadding();
+	Gdiplus::Rect GetDrawRect();
 	int GetWidthPadding() { return m_Padding.X + m_Padding.Width; }
 	int GetHeightPadding() { return m_Padding.Y + m_Padding.Height; }
 
@@ -52,6 +60,8 @@ public:
 
 	void SetRelativeMeter(Meter* meter) { m_RelativeMeter = meter; }
 
+	const std::vector<Measure*>& GetMeasures() { return m_Measures; }
+
 	const Mouse& GetMouse() { return m_Mouse; }
 	bool HasMouseAction() { return m_HasMouseAction; }
 
@@ -67,6 +77,12 @@ public:
 
 	const Gdiplus::Matrix* GetTransformationMatrix() { return m_Transformation; }
 
+	// Used by Skin::Redraw() to find the parts of the skin that need to be redrawn.
+	const Gdiplus::Rect& GetDrawnRect() { return m_DrawnRect; }
+	void SetDrawnRect(const Gdiplus::Rect& rect) { m_DrawnRect = rect; }
+	bool IsChanged() { return m_Changed; }
+	void SetChanged(bool changed) { m_Changed = changed; }
+
 	virtual bool HitTest(int x, int y);
 
 	void SetMouseOver(bool over) { m_MouseOver = over; }
@@ -103,6 +119,9 @@ protected:
 	virtual void ReadOptions(ConfigParser& parser, const WCHAR* section);
 	virtual void BindMeasures(ConfigParser& parser, const WCHAR* section);
 
+	// Returns the history of the measure that is shared with the meters updated at the same rate.
+	MeasureHistory& GetHistory(size_t index) { return m_Measures[index]->GetHistory(GetUpdateDivider()); }
+
 	virtual bool IsFixedSize(bool overwrite = false) { return true; }
 
 	bool BindPrimaryMeasure(ConfigParser& parser, const WCHAR* section, bool optional);
@@ -145,6 +164,15 @@ protected:
 	Gdiplus::Rect m_Padding;
 	bool m_AntiAlias;
 	bool m_Initialized;
+
+	Gdiplus::Rect m_DrawnRect;	// Area drawn by the last Skin::Redraw()
+	bool m_Changed;				// Looks different than when last drawn
+
+	ULONGLONG m_OptionsHash;	// Hash of the options read by the last ReadOptions()
+
+	bool m_CacheLayer;
+	std::unique_ptr<Gfx::Canvas> m_Layer;
+	ULONGLONG m_LayerKey;		// Content of |m_Layer|
 };
 
 #endif
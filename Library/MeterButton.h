@@ -27,6 +27,7 @@ public:
 	virtual void Initialize();
 	virtual bool Update();
 	virtual bool Draw(Gfx::Canvas& canvas);
+	virtual bool IsLayerCacheable() { return false; }
 
 	bool MouseMove(POINT pos);
 	bool MouseUp(POINT pos, bool execute);
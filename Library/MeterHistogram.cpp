@@ -22,7 +22,7 @@ MeterHistogram::MeterHistogram(Skin* skin, const WCHAR* name) : Meter(skin, name
 	m_PrimaryColor(Color::Green),
 	m_SecondaryColor(Color::Red),
 	m_OverlapColor(Color::Yellow),
-	m_MeterPos(),
+	m_HistorySize(),
 	m_Autoscale(false),
 	m_Flip(false),
 	m_PrimaryImage(L"PrimaryImage", c_PrimaryOptionArray, false, skin),
@@ -31,15 +31,15 @@ MeterHistogram::MeterHistogram(Skin* skin, const WCHAR* name) : Meter(skin, name
 	m_PrimaryNeedsReload(false),
 	m_SecondaryNeedsReload(false),
 	m_OverlapNeedsReload(false),
-	m_PrimaryValues(),
-	m_SecondaryValues(),
 	m_MaxPrimaryValue(1.0),
 	m_MinPrimaryValue(),
 	m_MaxSecondaryValue(1.0),
 	m_MinSecondaryValue(),
 	m_SizeChanged(true),
 	m_GraphStartLeft(false),
-	m_GraphHorizontalOrientation(false)
+	m_GraphHorizontalOrientation(false),
+	m_LayerPrimaryCount(),
+	m_LayerSecondaryCount()
 {
 }
 
@@ -49,42 +49,50 @@ MeterHistogram::~MeterHistogram()
 }
 
 /*
-** Disposes the buffers.
+** Stops graphing the values. The values themselves are kept by the measures.
 **
 */
 void MeterHistogram::DisposeBuffer()
 {
-	// Reset current position
-	m_MeterPos = 0;
-
-	// Delete buffers
-	delete [] m_PrimaryValues;
-	m_PrimaryValues = nullptr;
-
-	delete [] m_SecondaryValues;
-	m_SecondaryValues = nullptr;
+	m_HistorySize = 0;
 }
 
 /*
-** Creates the buffers.
+** Makes sure that the histories of the measures are deep enough for the meter.
 **
 */
 void MeterHistogram::CreateBuffer()
 {
-	DisposeBuffer();
-
-	// Create buffers for values
 	int maxSize = m_GraphHorizontalOrientation ? m_H : m_W;
-	if (maxSize > 0)
+	m_HistorySize = max(0, maxSize);
+
+	if (m_HistorySize > 0)
 	{
-		m_PrimaryValues = new double[maxSize]();
-		if (m_Measures.size() >= 2)
+		for (size_t i = 0, isize = min(m_Measures.size(), (size_t)2); i < isize; ++i)
 		{
-			m_SecondaryValues = new double[maxSize]();
+			GetHistory(i).Reserve(m_HistorySize, m_Autoscale);
 		}
 	}
 }
 
+/*
+** Returns the value of the primary (index 0) or secondary (index 1) measure age updates ago.
+**
+*/
+double MeterHistogram::GetHistoryValue(size_t index, int age)
+{
+	if (index < m_Measures.size() && age >= 0)
+	{
+		const MeasureHistory& history = GetHistory(index);
+		if ((size_t)age < history.GetCapacity())
+		{
+			return history.Get(age);
+		}
+	}
+
+	return 0.0;
+}
+
 /*
 ** Load the images and calculate the dimensions of the meter from them.
 ** Or create the brushes if solid color histogram is used.
@@ -305,22 +313,25 @@ bool MeterHistogram::Update()
 	{
 		int maxSize = m_GraphHorizontalOrientation ? m_H : m_W;
 
-		if (m_PrimaryValues && maxSize > 0)  // m_PrimaryValues must not be nullptr
+		if (m_HistorySize > 0 && maxSize > 0)
 		{
 			Measure* measure = m_Measures[0];
 			Measure* secondaryMeasure = (m_Measures.size() >= 2) ? m_Measures[1] : nullptr;
 
-			// Gather values
-			m_PrimaryValues[m_MeterPos] = measure->GetValue();
+			// The measures may have been rebound since the buffer was created.
+			CreateBuffer();
+
+			// Gather values. The measures keep the history so that other meters with the same
+			// UpdateDivider can share it. Each pass over the meters is recorded only once even if
+			// several meters graph the same measure.
+			const UINT pass = m_Skin->GetMeterPass();
+			GetHistory(0).Push(pass, measure->GetValue());
 
-			if (secondaryMeasure && m_SecondaryValues)
+			if (secondaryMeasure)
 			{
-				m_SecondaryValues[m_MeterPos] = secondaryMeasure->GetValue();
+				GetHistory(1).Push(pass, secondaryMeasure->GetValue());
 			}
 
-			++m_MeterPos;
-			m_MeterPos %= maxSize;
-
 			m_MaxPrimaryValue = measure->GetMaxValue();
 			m_MinPrimaryValue = measure->GetMinValue();
 			m_MaxSecondaryValue = 0.0;
@@ -335,11 +346,10 @@ bool MeterHistogram::Update()
 			{
 				// Go through all values and find the max
 
-				double newValue = 0.0;
-				for (int i = 0; i < maxSize; ++i)
-				{
-					newValue = max(newValue, m_PrimaryValues[i]);
-				}
+				double minValue, maxValue;
+				GetHistory(0).GetRange(m_HistorySize, minValue, maxValue);
+
+				double newValue = max(0.0, maxValue);
 
 				// Scale the value up to nearest power of 2
 				if (newValue > DBL_MAX / 2.0)
@@ -355,12 +365,10 @@ bool MeterHistogram::Update()
 					}
 				}
 
-				if (secondaryMeasure && m_SecondaryValues)
+				if (secondaryMeasure)
 				{
-					for (int i = 0; i < maxSize; ++i)
-					{
-						newValue = max(newValue, m_SecondaryValues[i]);
-					}
+					GetHistory(1).GetRange(m_HistorySize, minValue, maxValue);
+					newValue = max(newValue, maxValue);
 
 					// Scale the value up to nearest power of 2
 					if (newValue > DBL_MAX / 2.0)
@@ -384,233 +392,236 @@ bool MeterHistogram::Update()
 }
 
 /*
-** Draws the meter on the double buffer
+** Returns the length in pixels of the bar of the primary (index 0) or secondary (index 1) measure
+** age updates ago.
 **
 */
-bool MeterHistogram::Draw(Gfx::Canvas& canvas)
+int MeterHistogram::GetBarLength(size_t index, int age, int length)
 {
-	if (!Meter::Draw(canvas) ||
-		(m_Measures.size() >= 1 && !m_PrimaryValues) ||
-		(m_Measures.size() >= 2 && !m_SecondaryValues)) return false;
-
-	Gdiplus::Graphics& graphics = canvas.BeginGdiplusContext();
+	const double maxValue = (index == 0) ? m_MaxPrimaryValue : m_MaxSecondaryValue;
+	const double minValue = (index == 0) ? m_MinPrimaryValue : m_MinSecondaryValue;
+
+	double value = (maxValue == 0.0) ? 0.0 : GetHistoryValue(index, age) / maxValue;
+	value -= minValue;
+	int barLength = (int)(length * value);
+	barLength = min(length, barLength);
+	return max(0, barLength);
+}
 
+/*
+** Draws the columns (or rows with GraphOrientation=Horizontal) of the values from firstAge up to
+** lastAge updates ago to the graph area rect.
+**
+*/
+void MeterHistogram::DrawColumns(Gdiplus::Graphics& graphics, const Gdiplus::Rect& rect, int firstAge, int lastAge)
+{
 	Measure* secondaryMeasure = (m_Measures.size() >= 2) ? m_Measures[1] : nullptr;
 
 	GraphicsPath primaryPath;
 	GraphicsPath secondaryPath;
 	GraphicsPath bothPath;
 
-	Bitmap* primaryBitmap = m_PrimaryImage.GetImage();
-	Bitmap* secondaryBitmap = m_SecondaryImage.GetImage();
-	Bitmap* bothBitmap = m_OverlapImage.GetImage();
+	const int size = m_GraphHorizontalOrientation ? rect.Height : rect.Width;
+	const int length = m_GraphHorizontalOrientation ? rect.Width : rect.Height;
 
-	Gdiplus::Rect meterRect = GetMeterRectPadding();
-
-	// Default values (GraphStart=Right, GraphOrientation=Vertical)
-	int i;
-	int startValue = 0;
-	int* endValueLHS = &i;
-	int* endValueRHS = &meterRect.Width;
-	int step = 1;
-	int endValue = -1; //(should be 0, but need to simulate <=)
-
-	// GraphStart=Left, GraphOrientation=Vertical
-	if (!m_GraphHorizontalOrientation)
+	// Adds the part of the bar at pos from the distances from to to from the base of the graph.
+	auto addBar = [&](GraphicsPath& path, int pos, int from, int to)
 	{
-		if (m_GraphStartLeft)
-		{
-			startValue = meterRect.Width - 1;
-			endValueLHS = &endValue;
-			endValueRHS = &i;
-			step = -1;
-		}
-	}
-	else
-	{
-		if (!m_Flip)
+		if (to <= from) return;
+
+		if (m_GraphHorizontalOrientation)
 		{
-			endValueRHS = &meterRect.Height;
+			const int x = m_GraphStartLeft ? rect.X + from : rect.X + rect.Width - to;
+			path.AddRectangle(Rect(x, rect.Y + pos, to - from, 1));
 		}
 		else
 		{
-			startValue = meterRect.Height - 1;
-			endValueLHS = &endValue;
-			endValueRHS = &i;
-			step = -1;
+			const int y = m_Flip ? rect.Y + from : rect.Y + rect.Height - to;
+			path.AddRectangle(Rect(rect.X + pos, y, 1, to - from));
 		}
-	}
+	};
 
-	// Horizontal or Vertical graph
-	if (m_GraphHorizontalOrientation)
+	for (int age = firstAge; age < lastAge; ++age)
 	{
-		for (i = startValue; *endValueLHS < *endValueRHS; i += step)
-		{
-			double value = (m_MaxPrimaryValue == 0.0) ?
-				  0.0
-				: m_PrimaryValues[(i + (m_MeterPos % meterRect.Height)) % meterRect.Height] / m_MaxPrimaryValue;
-			value -= m_MinPrimaryValue;
-			int primaryBarHeight = (int)(meterRect.Width * value);
-			primaryBarHeight = min(meterRect.Width, primaryBarHeight);
-			primaryBarHeight = max(0, primaryBarHeight);
-
-			if (secondaryMeasure)
-			{
-				value = (m_MaxSecondaryValue == 0.0) ?
-					  0.0
-					: m_SecondaryValues[(i + m_MeterPos) % meterRect.Height] / m_MaxSecondaryValue;
-				value -= m_MinSecondaryValue;
-				int secondaryBarHeight = (int)(meterRect.Width * value);
-				secondaryBarHeight = min(meterRect.Width, secondaryBarHeight);
-				secondaryBarHeight = max(0, secondaryBarHeight);
-
-				// Check which measured value is higher
-				int bothBarHeight = min(primaryBarHeight, secondaryBarHeight);
-
-				// Cache image/color rectangle for the both lines
-				{
-					Rect& r = m_GraphStartLeft ?
-						  Rect(meterRect.X, meterRect.Y + startValue + (step * i), bothBarHeight, 1)
-						: Rect(meterRect.X + meterRect.Width - bothBarHeight, meterRect.Y + startValue + (step * i), bothBarHeight, 1);
-
-					bothPath.AddRectangle(r);  // cache
-				}
+		const int pos = IsLatestAtStart() ? age : size - 1 - age;
+		const int primaryBarLength = GetBarLength(0, age, length);
 
-				// Cache the image/color rectangle for the rest
-				if (secondaryBarHeight > primaryBarHeight)
-				{
-					Rect& r = m_GraphStartLeft ?
-						  Rect(meterRect.X + bothBarHeight, meterRect.Y + startValue + (step * i), secondaryBarHeight - bothBarHeight, 1)
-						: Rect(meterRect.X + meterRect.Width - secondaryBarHeight, meterRect.Y + startValue + (step * i), secondaryBarHeight - bothBarHeight, 1);
+		if (secondaryMeasure)
+		{
+			const int secondaryBarLength = GetBarLength(1, age, length);
 
-					secondaryPath.AddRectangle(r);  // cache
-				}
-				else
-				{
-					Rect& r = m_GraphStartLeft ?
-						  Rect(meterRect.X + bothBarHeight, meterRect.Y + startValue + (step * i), primaryBarHeight - bothBarHeight, 1)
-						: Rect(meterRect.X + meterRect.Width - primaryBarHeight, meterRect.Y + startValue + (step * i), primaryBarHeight - bothBarHeight, 1);
+			// Check which measured value is higher
+			const int bothBarLength = min(primaryBarLength, secondaryBarLength);
+			addBar(bothPath, pos, 0, bothBarLength);
 
-					primaryPath.AddRectangle(r);  // cache
-				}
+			if (secondaryBarLength > primaryBarLength)
+			{
+				addBar(secondaryPath, pos, bothBarLength, secondaryBarLength);
 			}
 			else
 			{
-				Rect& r = m_GraphStartLeft ?
-					  Rect(meterRect.X, meterRect.Y + startValue + (step * i), primaryBarHeight, 1)
-					: Rect(meterRect.X + meterRect.Width - primaryBarHeight, meterRect.Y + startValue + (step * i), primaryBarHeight, 1);
-
-				primaryPath.AddRectangle(r);  // cache
+				addBar(primaryPath, pos, bothBarLength, primaryBarLength);
 			}
 		}
+		else
+		{
+			addBar(primaryPath, pos, 0, primaryBarLength);
+		}
 	}
-	else	// GraphOrientation=Vertical
+
+	// Draw cached rectangles
+	auto fillPath = [&](GraphicsPath& path, Bitmap* bitmap, const Color& color)
 	{
-		for (i = startValue; *endValueLHS < *endValueRHS; i += step)
+		if (bitmap)
 		{
-			double value = (m_MaxPrimaryValue == 0.0) ?
-				  0.0
-				: m_PrimaryValues[(i + m_MeterPos) % meterRect.Width] / m_MaxPrimaryValue;
-			value -= m_MinPrimaryValue;
-			int primaryBarHeight = (int)(meterRect.Height * value);
-			primaryBarHeight = min(meterRect.Height, primaryBarHeight);
-			primaryBarHeight = max(0, primaryBarHeight);
-
-			if (secondaryMeasure)
-			{
-				value = (m_MaxSecondaryValue == 0.0) ?
-					  0.0
-					: m_SecondaryValues[(i + m_MeterPos) % meterRect.Width] / m_MaxSecondaryValue;
-				value -= m_MinSecondaryValue;
-				int secondaryBarHeight = (int)(meterRect.Height * value);
-				secondaryBarHeight = min(meterRect.Height, secondaryBarHeight);
-				secondaryBarHeight = max(0, secondaryBarHeight);
-
-				// Check which measured value is higher
-				int bothBarHeight = min(primaryBarHeight, secondaryBarHeight);
-
-				// Cache image/color rectangle for the both lines
-				{
-					Rect& r = m_Flip ?
-						  Rect(meterRect.X + startValue + (step * i), meterRect.Y, 1, bothBarHeight)
-						: Rect(meterRect.X + startValue + (step * i), meterRect.Y + meterRect.Height - bothBarHeight, 1, bothBarHeight);
-
-					bothPath.AddRectangle(r);  // cache
-				}
-
-				// Cache the image/color rectangle for the rest
-				if (secondaryBarHeight > primaryBarHeight)
-				{
-					Rect& r = m_Flip ?
-						  Rect(meterRect.X + startValue + (step * i), meterRect.Y + bothBarHeight, 1, secondaryBarHeight - bothBarHeight)
-						: Rect(meterRect.X + startValue + (step * i), meterRect.Y + meterRect.Height - secondaryBarHeight, 1, secondaryBarHeight - bothBarHeight);
+			Rect r(rect.X, rect.Y, bitmap->GetWidth(), bitmap->GetHeight());
 
-					secondaryPath.AddRectangle(r);  // cache
-				}
-				else
-				{
-					Rect& r = m_Flip ?
-						  Rect(meterRect.X + startValue + (step * i), meterRect.Y + bothBarHeight, 1, primaryBarHeight - bothBarHeight)
-						: Rect(meterRect.X + startValue + (step * i), meterRect.Y + meterRect.Height - primaryBarHeight, 1, primaryBarHeight - bothBarHeight);
+			graphics.SetClip(&path);
+			graphics.DrawImage(bitmap, r, 0, 0, r.Width, r.Height, UnitPixel);
+			graphics.ResetClip();
+		}
+		else
+		{
+			SolidBrush brush(color);
+			graphics.FillPath(&brush, &path);
+		}
+	};
 
-					primaryPath.AddRectangle(r);  // cache
-				}
-			}
-			else
-			{
-				Rect& r = m_Flip ?
-					  Rect(meterRect.X + startValue + (step * i), meterRect.Y, 1, primaryBarHeight)
-					: Rect(meterRect.X + startValue + (step * i), meterRect.Y + meterRect.Height - primaryBarHeight, 1, primaryBarHeight);
+	fillPath(primaryPath, m_PrimaryImage.GetImage(), m_PrimaryColor);
+	if (secondaryMeasure)
+	{
+		fillPath(secondaryPath, m_SecondaryImage.GetImage(), m_SecondaryColor);
+		fillPath(bothPath, m_OverlapImage.GetImage(), m_OverlapColor);
+	}
+}
 
-				primaryPath.AddRectangle(r);  // cache
-			}
+/*
+** Draws the graph through |m_Layer| with CacheLayer=1. The layer keeps the columns drawn so far
+** and is moved by one column for each new value so that only the new columns are drawn. The whole
+** layer is drawn again if anything else that affects the columns (e.g. the scale with AutoScale=1)
+** has changed. Histograms with images are always drawn directly.
+**
+*/
+void MeterHistogram::DrawScrolled(Gfx::Canvas& canvas, const Gdiplus::Rect& meterRect)
+{
+	const MeasureHistory& primaryHistory = GetHistory(0);
+	const MeasureHistory* secondaryHistory = (m_Measures.size() >= 2) ? &GetHistory(1) : nullptr;
+
+	ContentHash hash;
+	hash.Add(&m_OptionsHash, sizeof(m_OptionsHash));
+	hash.Add(meterRect.Width);
+	hash.Add(meterRect.Height);
+	hash.Add(m_MaxPrimaryValue);
+	hash.Add(m_MinPrimaryValue);
+	hash.Add(m_MaxSecondaryValue);
+	hash.Add(m_MinSecondaryValue);
+
+	const void* sources[] =
+	{
+		m_Measures[0],
+		secondaryHistory ? m_Measures[1] : nullptr
+	};
+	hash.Add(sources, sizeof(sources));
+
+	const ULONGLONG key = hash.Get();
+	const int size = m_GraphHorizontalOrientation ? meterRect.Height : meterRect.Width;
+
+	// Number of new values since the layer was last drawn, or the size of the graph if the whole
+	// layer must be drawn.
+	int shift = size;
+	if (m_Layer && m_LayerKey == key)
+	{
+		const UINT count = primaryHistory.GetCount() - m_LayerPrimaryCount;
+		if (!secondaryHistory || secondaryHistory->GetCount() - m_LayerSecondaryCount == count)
+		{
+			shift = (int)min(count, (UINT)size);
 		}
 	}
 
-	// Draw cached rectangles
-	if (primaryBitmap)
+	if (!m_Layer)
 	{
-		Rect r(meterRect.X, meterRect.Y, primaryBitmap->GetWidth(), primaryBitmap->GetHeight());
-
-		graphics.SetClip(&primaryPath);
-		graphics.DrawImage(primaryBitmap, r, 0, 0, r.Width, r.Height, UnitPixel);
-		graphics.ResetClip();
+		m_Layer.reset(new Gfx::Canvas());
+		m_Layer->Resize(meterRect.Width, meterRect.Height);
 	}
-	else
+	else if (m_Layer->GetW() != meterRect.Width || m_Layer->GetH() != meterRect.Height)
 	{
-		SolidBrush brush(m_PrimaryColor);
-		graphics.FillPath(&brush, &primaryPath);
+		m_Layer->Resize(meterRect.Width, meterRect.Height);
+		shift = size;
 	}
-	if (secondaryMeasure)
+
+	m_Layer->BeginDraw();
+
+	const Rect layerRect(0, 0, meterRect.Width, meterRect.Height);
+	if (shift >= size)
 	{
-		if (secondaryBitmap)
-		{
-			Rect r(meterRect.X, meterRect.Y, secondaryBitmap->GetWidth(), secondaryBitmap->GetHeight());
+		m_Layer->Clear();
 
-			graphics.SetClip(&secondaryPath);
-			graphics.DrawImage(secondaryBitmap, r, 0, 0, r.Width, r.Height, UnitPixel);
-			graphics.ResetClip();
-		}
-		else
-		{
-			SolidBrush brush(m_SecondaryColor);
-			graphics.FillPath(&brush, &secondaryPath);
-		}
-		if (bothBitmap)
+		Gdiplus::Graphics& graphics = m_Layer->BeginGdiplusContext();
+		DrawColumns(graphics, layerRect, 0, size);
+		m_Layer->EndGdiplusContext();
+	}
+	else
+	{
+		const int offset = IsLatestAtStart() ? shift : -shift;
+		if (m_GraphHorizontalOrientation)
 		{
-			Rect r(meterRect.X, meterRect.Y, bothBitmap->GetWidth(), bothBitmap->GetHeight());
-
-			graphics.SetClip(&bothPath);
-			graphics.DrawImage(bothBitmap, r, 0, 0, r.Width, r.Height, UnitPixel);
-			graphics.ResetClip();
+			m_Layer->Scroll(0, offset);
 		}
 		else
 		{
-			SolidBrush brush(m_OverlapColor);
-			graphics.FillPath(&brush, &bothPath);
+			m_Layer->Scroll(offset, 0);
 		}
+
+		// The latest value may have been replaced since it was drawn so it is drawn again along
+		// with the new values.
+		const int ages = shift + 1;
+		const int pos = IsLatestAtStart() ? 0 : size - ages;
+		const Rect clearRect = m_GraphHorizontalOrientation ?
+			  Rect(0, pos, meterRect.Width, ages)
+			: Rect(pos, 0, ages, meterRect.Height);
+
+		Gdiplus::Graphics& graphics = m_Layer->BeginGdiplusContext();
+		SolidBrush transparent(Color(0, 0, 0, 0));
+		graphics.SetCompositingMode(CompositingModeSourceCopy);
+		graphics.FillRectangle(&transparent, clearRect);
+		graphics.SetCompositingMode(CompositingModeSourceOver);
+
+		DrawColumns(graphics, layerRect, 0, ages);
+		m_Layer->EndGdiplusContext();
 	}
 
+	m_Layer->EndDraw();
+
+	m_LayerKey = key;
+	m_LayerPrimaryCount = primaryHistory.GetCount();
+	m_LayerSecondaryCount = secondaryHistory ? secondaryHistory->GetCount() : 0;
+
+	canvas.DrawCanvas(*m_Layer, meterRect.X, meterRect.Y);
+}
+
+/*
+** Draws the meter on the double buffer
+**
+*/
+bool MeterHistogram::Draw(Gfx::Canvas& canvas)
+{
+	if (!Meter::Draw(canvas) || (!m_Measures.empty() && m_HistorySize <= 0)) return false;
+
+	Gdiplus::Rect meterRect = GetMeterRectPadding();
+	if (meterRect.Width <= 0 || meterRect.Height <= 0) return true;
+
+	// The images are fixed to the meter and cannot be scrolled with the columns.
+	const bool images = m_PrimaryImage.GetImage() || m_SecondaryImage.GetImage() || m_OverlapImage.GetImage();
+	if (m_CacheLayer && !images && !m_Measures.empty())
+	{
+		DrawScrolled(canvas, meterRect);
+		return true;
+	}
+
+	m_Layer.reset();
+
+	Gdiplus::Graphics& graphics = canvas.BeginGdiplusContext();
+	DrawColumns(graphics, meterRect, 0, m_GraphHorizontalOrientation ? meterRect.Height : meterRect.Width);
 	canvas.EndGdiplusContext();
 
 	return true;
@@ -26,6 +26,9 @@ public:
 	virtual bool Update();
 	virtual bool Draw(Gfx::Canvas& canvas);
 
+	// With CacheLayer=1, the layer is scrolled by Draw() itself.
+	virtual bool IsLayerCacheable() { return false; }
+
 protected:
 	virtual void ReadOptions(ConfigParser& parser, const WCHAR* section);
 	virtual void BindMeasures(ConfigParser& parser, const WCHAR* section);
@@ -35,12 +38,19 @@ protected:
 private:
 	void DisposeBuffer();
 	void CreateBuffer();
+	double GetHistoryValue(size_t index, int age);
+	int GetBarLength(size_t index, int age, int length);
+	void DrawColumns(Gdiplus::Graphics& graphics, const Gdiplus::Rect& rect, int firstAge, int lastAge);
+	void DrawScrolled(Gfx::Canvas& canvas, const Gdiplus::Rect& meterRect);
+
+	// Returns true if the latest value is drawn at the left (or top) of the graph.
+	bool IsLatestAtStart() { return m_GraphHorizontalOrientation ? m_Flip : m_GraphStartLeft; }
 
 	Gdiplus::Color m_PrimaryColor;
 	Gdiplus::Color m_SecondaryColor;
 	Gdiplus::Color m_OverlapColor;
 
-	int m_MeterPos;							// New value placement position
+	int m_HistorySize;						// Number of values graphed, zero if the meter cannot be drawn
 	bool m_Autoscale;
 	bool m_Flip;
 
@@ -56,9 +66,6 @@ private:
 	bool m_SecondaryNeedsReload;
 	bool m_OverlapNeedsReload;
 
-	double* m_PrimaryValues;
-	double* m_SecondaryValues;
-
 	double m_MaxPrimaryValue;
 	double m_MinPrimaryValue;
 	double m_MaxSecondaryValue;
@@ -69,6 +76,9 @@ private:
 	bool m_GraphStartLeft;
 	bool m_GraphHorizontalOrientation;
 
+	UINT m_LayerPrimaryCount;				// History counts of the measures when |m_Layer| was drawn
+	UINT m_LayerSecondaryCount;
+
 	static const WCHAR* c_PrimaryOptionArray[TintedImage::OptionCount];
 	static const WCHAR* c_SecondaryOptionArray[TintedImage::OptionCount];
 	static const WCHAR* c_BothOptionArray[TintedImage::OptionCount];
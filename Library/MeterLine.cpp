@@ -19,9 +19,9 @@ MeterLine::MeterLine(Skin* skin, const WCHAR* name) : Meter(skin, name),
 	m_Flip(false),
 	m_LineWidth(1.0),
 	m_HorizontalColor(Color::Black),
-	m_CurrentPos(),
 	m_GraphStartLeft(false),
-	m_GraphHorizontalOrientation(false)
+	m_GraphHorizontalOrientation(false),
+	m_ValuesPerPixel(1)
 {
 }
 
@@ -30,50 +30,25 @@ MeterLine::~MeterLine()
 }
 
 /*
-** create the buffer for the lines
+** Makes sure that the histories of the measures are deep enough for the lines.
 **
 */
 void MeterLine::Initialize()
 {
 	Meter::Initialize();
 
-	size_t colorsSize = m_Colors.size();
-	size_t allValuesSize = m_AllValues.size();
-	size_t num = (allValuesSize > 0) ? m_AllValues[0].size() : 0;
-	int maxSize = m_GraphHorizontalOrientation ? m_H : m_W;
-
-	if (colorsSize != allValuesSize)
-	{
-		if (colorsSize > allValuesSize)
-		{
-			for (size_t i = allValuesSize; i < colorsSize; ++i)
-			{
-				m_AllValues.push_back(std::vector<double>());
+	ReserveHistory();
+}
 
-				if (maxSize > 0)
-				{
-					m_AllValues.back().assign(maxSize, 0.0);
-				}
-			}
-		}
-		else
-		{
-			m_AllValues.resize(colorsSize);
-		}
-	}
+void MeterLine::ReserveHistory()
+{
+	const int maxSize = m_GraphHorizontalOrientation ? m_H : m_W;
+	if (maxSize <= 0) return;
 
-	if (maxSize < 0 || num != (size_t)maxSize)
+	const size_t lineCount = min(m_Colors.size(), m_Measures.size());
+	for (size_t i = 0; i < lineCount; ++i)
 	{
-		if (m_CurrentPos >= maxSize) m_CurrentPos = 0;
-
-		num = (maxSize < 0) ? 0 : maxSize;
-		for (size_t i = 0; i < allValuesSize; ++i)
-		{
-			if (num != m_AllValues[i].size())
-			{
-				m_AllValues[i].resize(num, 0.0);
-			}
-		}
+		GetHistory(i).Reserve(maxSize * m_ValuesPerPixel, m_Autoscale);
 	}
 }
 
@@ -85,11 +60,6 @@ void MeterLine::ReadOptions(ConfigParser& parser, const WCHAR* section)
 {
 	WCHAR tmpName[64];
 
-	// Store the current number of lines so we know if the buffer needs to be updated
-	int oldLineCount = (int)m_Colors.size();
-	int oldSize = m_GraphHorizontalOrientation ? m_H : m_W;
-	bool oldGraphHorizontalOrientation = m_GraphHorizontalOrientation;
-
 	Meter::ReadOptions(parser, section);
 
 	int lineCount = parser.ReadInt(section, L"LineCount", 1);
@@ -125,6 +95,12 @@ void MeterLine::ReadOptions(ConfigParser& parser, const WCHAR* section)
 	m_Flip = parser.ReadBool(section, L"Flip", false);
 	m_Autoscale = parser.ReadBool(section, L"AutoScale", false);
 	m_LineWidth = parser.ReadFloat(section, L"LineWidth", 1.0);
+	m_ValuesPerPixel = max(1, parser.ReadInt(section, L"ValuesPerPixel", 1));
+	if (m_ValuesPerPixel > MAX_VALUES_PER_PIXEL)
+	{
+		LogWarningF(this, L"ValuesPerPixel=%i is too large, using %i", m_ValuesPerPixel, MAX_VALUES_PER_PIXEL);
+		m_ValuesPerPixel = MAX_VALUES_PER_PIXEL;
+	}
 	m_HorizontalLines = parser.ReadBool(section, L"HorizontalLines", false);
 	ARGB color = parser.ReadColor(section, L"HorizontalColor", Color::Black);		// This is left here for backwards compatibility
 	m_HorizontalColor = parser.ReadColor(section, L"HorizontalLineColor", color);	// This is what it should be
@@ -159,13 +135,7 @@ void MeterLine::ReadOptions(ConfigParser& parser, const WCHAR* section)
 
 	if (m_Initialized)
 	{
-		int maxSize = m_GraphHorizontalOrientation ? m_H : m_W;
-		if (oldLineCount != lineCount || oldSize != maxSize || oldGraphHorizontalOrientation != m_GraphHorizontalOrientation)
-		{
-			m_AllValues.clear();
-			m_CurrentPos = 0;
-			Initialize();
-		}
+		ReserveHistory();
 	}
 }
 
@@ -181,15 +151,17 @@ bool MeterLine::Update()
 
 		if (maxSize > 0)
 		{
-			int allValuesSize = (int)m_AllValues.size();
-			int counter = 0;
-			for (auto i = m_Measures.cbegin(); counter < allValuesSize && i != m_Measures.cend(); ++i, ++counter)
+			// The measures keep the history so that other meters with the same UpdateDivider can
+			// share it. Each pass over the meters is recorded only once even if several meters graph
+			// the same measure.
+			ReserveHistory();
+
+			const UINT pass = m_Skin->GetMeterPass();
+			const size_t lineCount = min(m_Colors.size(), m_Measures.size());
+			for (size_t i = 0; i < lineCount; ++i)
 			{
-				m_AllValues[counter][m_CurrentPos] = (*i)->GetValue();
+				GetHistory(i).Push(pass, m_Measures[i]->GetValue());
 			}
-
-			++m_CurrentPos;
-			m_CurrentPos %= maxSize;
 		}
 		return true;
 	}
@@ -214,16 +186,19 @@ bool MeterLine::Draw(Gfx::Canvas& canvas)
 	if (m_Autoscale)
 	{
 		double newValue = 0;
-		counter = 0;
-		for (auto i = m_AllValues.cbegin(); i != m_AllValues.cend(); ++i)
+		const size_t lineCount = min(m_Colors.size(), m_Measures.size());
+		for (size_t i = 0; i < lineCount; ++i)
 		{
-			double scale = m_ScaleValues[counter];
-			for (auto j = (*i).cbegin(); j != (*i).cend(); ++j)
-			{
-				double val = (*j) * scale;
-				newValue = max(newValue, val);
-			}
-			++counter;
+			const MeasureHistory& history = GetHistory(i);
+			const size_t depth = (size_t)maxSize * m_ValuesPerPixel;
+			if (history.GetCapacity() < depth) continue;
+
+			double lowest, highest;
+			history.GetRange(depth, lowest, highest);
+
+			// The scale may be negative.
+			const double scale = m_ScaleValues[i];
+			newValue = max(newValue, max(lowest * scale, highest * scale));
 		}
 
 		// Scale the value up to nearest power of 2
@@ -284,131 +259,66 @@ bool MeterLine::Draw(Gfx::Canvas& canvas)
 	}
 
 	// Draw all the lines
-
-	if (m_GraphHorizontalOrientation)
+	const bool horizontal = m_GraphHorizontalOrientation;
+	const int size = horizontal ? meterRect.Height : meterRect.Width;
+	const REAL length = (horizontal ? meterRect.Width : meterRect.Height) - 1.0f;
+	const bool latestAtStart = horizontal ? m_Flip : m_GraphStartLeft;
+	const bool valueFromStart = horizontal ? m_GraphStartLeft : m_Flip;
+
+	m_Envelopes.resize(m_Colors.size());
+	for (counter = 0; counter < (int)m_Colors.size(); ++counter)
 	{
-		const REAL W = meterRect.Width - 1.0f;
-		counter = 0;
-		for (auto i = m_AllValues.cbegin(); i != m_AllValues.cend(); ++i)
-		{
-			// Draw a line
-			REAL X, oldX;
-
-			const double scale = m_ScaleValues[counter] * W / maxValue;
-
-			int pos = m_CurrentPos;
-
-			auto calcX = [&](REAL& _x)
-			{
-				_x = (REAL)((*i)[pos] * scale);
-				_x = min(_x, W);
-				_x = max(_x, 0.0f);
-				_x = meterRect.X + (m_GraphStartLeft ? _x : W - _x);
-			};
-
-			calcX(oldX);
+		const double scale = m_ScaleValues[counter] * length / maxValue;
 
-			// Cache all lines
-			GraphicsPath path;
-		
-			if (!m_Flip)
-			{
-				for (int j = meterRect.Y + 1, R = meterRect.Y + meterRect.Height; j < R; ++j)
-				{
-					++pos;
-					pos %= meterRect.Height;
-
-					calcX(X);
-
-					path.AddLine(oldX, (REAL)(j - 1), X, (REAL)j);
+		auto addPoint = [&](int age, double value)
+		{
+			REAL v = (REAL)(value * scale);
+			v = min(v, length);
+			v = max(v, 0.0f);
+			v = valueFromStart ? v : length - v;
+
+			const REAL pos = (REAL)(latestAtStart ? age : size - 1 - age);
+			m_Points.push_back(horizontal ?
+				  PointF(meterRect.X + v, meterRect.Y + pos)
+				: PointF(meterRect.X + pos, meterRect.Y + v));
+		};
+
+		// Start from the oldest value. Each pixel shows the values of its column of the envelope
+		// as a line from the first value through the range to the last value.
+		m_Points.clear();
+		if (counter < (int)m_Measures.size())
+		{
+			HistoryEnvelope& envelope = m_Envelopes[counter];
+			envelope.Update(GetHistory(counter), (size_t)max(size, 0), m_ValuesPerPixel);
 
-					oldX = X;
-				}
-			}
-			else
+			for (int age = size - 1; age >= 0; --age)
 			{
-				for (int j = meterRect.Y + meterRect.Height, R = meterRect.Y + 1; j > R; --j)
+				const HistoryEnvelope::Column& column = envelope.Get(age);
+				addPoint(age, column.first);
+				if (column.min != column.max)
 				{
-					++pos;
-					pos %= meterRect.Height;
-
-					calcX(X);
-
-					path.AddLine(oldX, (REAL)(j - 1), X, (REAL)(j - 2));
-
-					oldX = X;
+					addPoint(age, column.min);
+					addPoint(age, column.max);
+					addPoint(age, column.last);
 				}
 			}
-
-			// Draw cached lines
-			Pen pen(m_Colors[counter], (REAL)m_LineWidth);
-			pen.SetLineJoin(LineJoinBevel);
-			graphics.DrawPath(&pen, &path);
-
-			++counter;
 		}
-	}
-	else
-	{
-		const REAL H = meterRect.Height - 1.0f;
-		counter = 0;
-		for (auto i = m_AllValues.cbegin(); i != m_AllValues.cend(); ++i)
+		else
 		{
-			// Draw a line
-			REAL Y, oldY;
-
-			const double scale = m_ScaleValues[counter] * H / maxValue;
-
-			int pos = m_CurrentPos;
-
-			auto calcY = [&](REAL& _y)
-			{
-				_y = (REAL)((*i)[pos] * scale);
-				_y = min(_y, H);
-				_y = max(_y, 0.0f);
-				_y = meterRect.Y + (m_Flip ? _y : H - _y);
-			};
-
-			calcY(oldY);
-
-			// Cache all lines
-			GraphicsPath path;
-		
-			if (!m_GraphStartLeft)
+			for (int age = size - 1; age >= 0; --age)
 			{
-				for (int j = meterRect.X + 1, R = meterRect.X + meterRect.Width; j < R; ++j)
-				{
-					++pos;
-					pos %= meterRect.Width;
-
-					calcY(Y);
-
-					path.AddLine((REAL)(j - 1), oldY, (REAL)j, Y);
-
-					oldY = Y;
-				}
+				addPoint(age, 0.0);
 			}
-			else
-			{
-				for (int j = meterRect.X + meterRect.Width, R = meterRect.X + 1; j > R; --j)
-				{
-					++pos;
-					pos %= meterRect.Width;
-
-					calcY(Y);
-
-					path.AddLine((REAL)(j - 1), oldY, (REAL)(j - 2), Y);
+		}
 
-					oldY = Y;
-				}
-			}
+		if (m_Points.size() >= 2)
+		{
+			GraphicsPath path;
+			path.AddLines(m_Points.data(), (INT)m_Points.size());
 
-			// Draw cached lines
 			Pen pen(m_Colors[counter], (REAL)m_LineWidth);
 			pen.SetLineJoin(LineJoinBevel);
 			graphics.DrawPath(&pen, &path);
-
-			++counter;
 		}
 	}
 
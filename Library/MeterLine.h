@@ -9,6 +9,7 @@
 #define __METERLINE_H__
 
 #include "Meter.h"
+#include "HistoryEnvelope.h"
 
 class MeterLine : public Meter
 {
@@ -24,12 +25,18 @@ public:
 	virtual void Initialize();
 	virtual bool Update();
 	virtual bool Draw(Gfx::Canvas& canvas);
+	virtual bool IsLayerCacheable() { return false; }
 
 protected:
 	virtual void ReadOptions(ConfigParser& parser, const WCHAR* section);
 	virtual void BindMeasures(ConfigParser& parser, const WCHAR* section);
 
 private:
+	// Each line keeps width * ValuesPerPixel values, so keep the memory use sane.
+	static const int MAX_VALUES_PER_PIXEL = 1000;
+
+	void ReserveHistory();
+
 	std::vector<Gdiplus::Color> m_Colors;
 	std::vector<double> m_ScaleValues;
 
@@ -39,11 +46,12 @@ private:
 	double m_LineWidth;
 	Gdiplus::Color m_HorizontalColor;
 
-	std::vector< std::vector<double> > m_AllValues;
-	int m_CurrentPos;
-
 	bool m_GraphStartLeft;
 	bool m_GraphHorizontalOrientation;
+
+	int m_ValuesPerPixel;
+	std::vector<HistoryEnvelope> m_Envelopes;		// One for each line
+	std::vector<Gdiplus::PointF> m_Points;			// buffer
 };
 
 #endif
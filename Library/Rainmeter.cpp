@@ -9,6 +9,7 @@
 #include "../Common/Gfx/Canvas.h"
 #include "../Common/PathUtil.h"
 #include "../Common/Platform.h"
+#include "../Common/RegExpCache.h"
 #include "Rainmeter.h"
 #include "TrayIcon.h"
 #include "System.h"
@@ -25,11 +26,14 @@ using namespace Gdiplus;
 
 enum TIMER
 {
-	TIMER_NETSTATS    = 1
+	TIMER_NETSTATS    = 1,
+	TIMER_SKINS       = 2,
+	TIMER_LOG         = 3
 };
 enum INTERVAL
 {
-	INTERVAL_NETSTATS = 120000
+	INTERVAL_NETSTATS = 120000,
+	INTERVAL_SLACK    = 10
 };
 
 /*
@@ -105,6 +109,10 @@ Rainmeter::Rainmeter() :
 	m_NormalStayDesktop(true),
 	m_DisableRDP(false),
 	m_DisableDragging(false),
+	m_SkinCache(false),
+	m_SkinTimers(OnSkinTimer),
+	m_SkinTimerDueTime(),
+	m_TimerSlack(INTERVAL_SLACK),
 	m_CurrentParser(),
 	m_Window(),
 	m_Mutex(),
@@ -229,6 +237,9 @@ int Rainmeter::Initialize(LPCWSTR iniPath, LPCWSTR layout)
 
 	if (!m_Window) return 1;
 
+	// Logs the summaries of the repeated and suppressed messages when they are due.
+	SetTimer(m_Window, TIMER_LOG, (UINT)LogLimiter::FLUSH_INTERVAL, nullptr);
+
 	Logger& logger = GetLogger();
 	const WCHAR* iniFile = m_IniFile.c_str();
 
@@ -410,11 +421,20 @@ int Rainmeter::Initialize(LPCWSTR iniPath, LPCWSTR layout)
 void Rainmeter::Finalize()
 {
 	KillTimer(m_Window, TIMER_NETSTATS);
+	KillTimer(m_Window, TIMER_SKINS);
+	KillTimer(m_Window, TIMER_LOG);
 
 	DeleteAllUnmanagedSkins();
 	DeleteAllSkins();
 	DeleteAllUnmanagedSkins();  // Redelete unmanaged windows caused by OnCloseAction
 
+	if (m_Debug)
+	{
+		RegExpCache& regExpCache = GetRegExpCache();
+		LogDebugF(L"RegExp cache: %llu hits, %llu misses, %llu evictions",
+			regExpCache.GetHits(), regExpCache.GetMisses(), regExpCache.GetEvictions());
+	}
+
 	delete m_TrayIcon;
 
 	System::Finalize();
@@ -435,6 +455,8 @@ void Rainmeter::Finalize()
 		UpdateDesktopWorkArea(true);
 	}
 
+	GetLogger().Finalize();
+
 	if (m_ResourceInstance) FreeLibrary(m_ResourceInstance);
 	if (m_Mutex) ReleaseMutex(m_Mutex);
 }
@@ -550,6 +572,14 @@ LRESULT CALLBACK Rainmeter::MainWndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPA
 			MeasureNet::UpdateStats();
 			GetRainmeter().WriteStats(false);
 		}
+		else if (wParam == TIMER_SKINS)
+		{
+			GetRainmeter().RunSkinTimers();
+		}
+		else if (wParam == TIMER_LOG)
+		{
+			GetLogger().Flush();
+		}
 		break;
 
 	case WM_RAINMETER_DELAYED_REFRESH_ALL:
@@ -584,6 +614,73 @@ void Rainmeter::SetNetworkStatisticsTimer()
 	static bool set = SetTimer(m_Window, TIMER_NETSTATS, INTERVAL_NETSTATS, nullptr) != 0;
 }
 
+/*
+** Sets a timer for the skin. The skin receives the timer through Skin::OnTimer() like a
+** regular window timer, but all skin timers share a single window timer.
+**
+*/
+void Rainmeter::SetSkinTimer(Skin* skin, UINT_PTR id, UINT elapse)
+{
+	m_SkinTimers.SetTimer(skin, id, max(elapse, (UINT)USER_TIMER_MINIMUM), System::GetTickCount64());
+	ScheduleSkinTimers();
+}
+
+void Rainmeter::KillSkinTimer(Skin* skin, UINT_PTR id)
+{
+	m_SkinTimers.KillTimer(skin, id);
+	ScheduleSkinTimers();
+}
+
+void Rainmeter::KillSkinTimers(Skin* skin)
+{
+	m_SkinTimers.KillTimers(skin);
+	ScheduleSkinTimers();
+}
+
+void Rainmeter::OnSkinTimer(void* owner, UINT_PTR id)
+{
+	((Skin*)owner)->OnSkinTimer(id);
+}
+
+/*
+** Handles the skin timers that are due now or within the slack.
+**
+*/
+void Rainmeter::RunSkinTimers()
+{
+	m_SkinTimers.Run(System::GetTickCount64(), m_TimerSlack);
+
+	// Window timers repeat so always rearm.
+	m_SkinTimerDueTime = 0;
+	ScheduleSkinTimers();
+}
+
+/*
+** Sets the window timer to the next due skin timer.
+**
+*/
+void Rainmeter::ScheduleSkinTimers()
+{
+	ULONGLONG dueTime;
+	if (!m_SkinTimers.GetNextDueTime(&dueTime))
+	{
+		if (m_SkinTimerDueTime != 0)
+		{
+			KillTimer(m_Window, TIMER_SKINS);
+			m_SkinTimerDueTime = 0;
+		}
+		return;
+	}
+
+	if (dueTime != m_SkinTimerDueTime)
+	{
+		const ULONGLONG ticks = System::GetTickCount64();
+		const ULONGLONG elapse = (dueTime > ticks) ? dueTime - ticks : 0;
+		SetTimer(m_Window, TIMER_SKINS, (UINT)min(elapse, (ULONGLONG)USER_TIMER_MAXIMUM), nullptr);
+		m_SkinTimerDueTime = dueTime;
+	}
+}
+
 void Rainmeter::CreateOptionsFile()
 {
 	CreateDirectory(m_SettingsPath.c_str(), nullptr);
@@ -982,6 +1079,7 @@ void Rainmeter::CreateSkin(const std::wstring& folderPath, const std::wstring& f
 
 	// Note: May modify existing key
 	m_Skins[folderPath] = skin;
+	m_SkinGroups.Invalidate();
 
 	skin->Initialize();
 
@@ -996,6 +1094,7 @@ void Rainmeter::DeleteAllSkins()
 	{
 		Skin* skin = (*it).second;
 		m_Skins.erase(it);  // Remove before deleting Skin
+		m_SkinGroups.Invalidate();
 
 		DialogManage::UpdateSkins(skin, true);
 		delete skin;
@@ -1005,6 +1104,7 @@ void Rainmeter::DeleteAllSkins()
 	}
 
 	m_Skins.clear();
+	m_SkinGroups.Invalidate();
 	DialogAbout::UpdateSkins();
 }
 
@@ -1029,6 +1129,7 @@ void Rainmeter::RemoveSkin(Skin* skin)
 		if ((*it).second == skin)
 		{
 			m_Skins.erase(it);
+			m_SkinGroups.Invalidate();
 			DialogManage::UpdateSkins(skin, true);
 			DialogAbout::UpdateSkins();
 			break;
@@ -1131,11 +1232,32 @@ Skin* Rainmeter::GetSkin(HWND hwnd)
 
 void Rainmeter::GetSkinsByLoadOrder(std::multimap<int, Skin*>& windows, const std::wstring& group)
 {
+	if (!group.empty())
+	{
+		if (!m_SkinGroups.IsCurrent())
+		{
+			m_SkinGroups.Clear();
+			for (auto iter = m_Skins.cbegin(); iter != m_Skins.cend(); ++iter)
+			{
+				if ((*iter).second)
+				{
+					m_SkinGroups.Add((*iter).second);
+				}
+			}
+		}
+
+		for (Skin* skin : m_SkinGroups.Get(group))
+		{
+			windows.insert(std::pair<int, Skin*>(GetLoadOrder(skin->GetFolderPath()), skin));
+		}
+		return;
+	}
+
 	std::map<std::wstring, Skin*>::const_iterator iter = m_Skins.begin();
 	for (; iter != m_Skins.end(); ++iter)
 	{
 		Skin* skin = (*iter).second;
-		if (skin && (group.empty() || skin->BelongsToGroup(group)))
+		if (skin)
 		{
 			windows.insert(std::pair<int, Skin*>(GetLoadOrder((*iter).first), skin));
 		}
@@ -1268,7 +1390,26 @@ void Rainmeter::ExecuteBang(const WCHAR* bang, std::vector<std::wstring>& args,
 */
 void Rainmeter::ExecuteCommand(const WCHAR* command, Skin* skin, bool multi)
 {
+	const int batchDepth = skin ? skin->GetBatchDepth() : 0;
 	m_CommandHandler.ExecuteCommand(command, skin, multi);
+	if (skin && HasSkin(skin))
+	{
+		skin->EndBatches(batchDepth);
+	}
+}
+
+/*
+** Runs the given precompiled action
+**
+*/
+void Rainmeter::ExecuteAction(const ActionProgram& action, Skin* skin)
+{
+	const int batchDepth = skin ? skin->GetBatchDepth() : 0;
+	m_CommandHandler.ExecuteAction(action, skin);
+	if (skin && HasSkin(skin))
+	{
+		skin->EndBatches(batchDepth);
+	}
 }
 
 /*
@@ -1306,6 +1447,11 @@ void Rainmeter::ReadGeneralSettings(const std::wstring& iniFile)
 		logger.StartLogFile();
 	}
 
+	logger.SetLimits(
+		parser.ReadUInt64(L"Rainmeter", L"LogRepeatInterval", LogLimiter::DEFAULT_REPEAT_INTERVAL),
+		parser.ReadUInt(L"Rainmeter", L"LogRate", LogLimiter::DEFAULT_RATE),
+		parser.ReadUInt(L"Rainmeter", L"LogBurst", LogLimiter::DEFAULT_BURST));
+
 	if (m_TrayIcon)
 	{
 		m_TrayIcon->ReadOptions(parser);
@@ -1317,6 +1463,12 @@ void Rainmeter::ReadGeneralSettings(const std::wstring& iniFile)
 	m_DisableDragging = parser.ReadBool(L"Rainmeter", L"DisableDragging", false);
 	m_DisableRDP = parser.ReadBool(L"Rainmeter", L"DisableRDP", false);
 
+	// Keep snapshots of the parsed skin files in the "Cache" folder of the settings path.
+	m_SkinCache = parser.ReadBool(L"Rainmeter", L"SkinCache", false);
+
+	// Skin timers that are due within this many milliseconds are handled together.
+	m_TimerSlack = (UINT)max(0, min(1000, parser.ReadInt(L"Rainmeter", L"TimerSlack", INTERVAL_SLACK)));
+
 	m_SkinEditor = parser.ReadString(L"Rainmeter", L"ConfigEditor", L"");
 	if (m_SkinEditor.empty())
 	{
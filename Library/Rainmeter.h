@@ -18,6 +18,7 @@
 #include "Logger.h"
 #include "Skin.h"
 #include "SkinRegistry.h"
+#include "TimerScheduler.h"
 
 #define MAX_LINE_LENGTH 4096
 
@@ -60,6 +61,10 @@ public:
 
 	void SetNetworkStatisticsTimer();
 
+	void SetSkinTimer(Skin* skin, UINT_PTR id, UINT elapse);
+	void KillSkinTimer(Skin* skin, UINT_PTR id);
+	void KillSkinTimers(Skin* skin);
+
 	ConfigParser* GetCurrentParser() { return m_CurrentParser; }
 	void SetCurrentParser(ConfigParser* parser) { m_CurrentParser = parser; }
 
@@ -118,6 +123,7 @@ public:
 	LCID GetResourceLCID() { return m_ResourceLCID; }
 
 	bool GetDebug() { return m_Debug; }
+	bool GetSkinCache() { return m_SkinCache; }
 
 	GlobalOptions& GetGlobalOptions() { return m_GlobalOptions; }
 
@@ -161,6 +167,7 @@ public:
 
 	void ExecuteBang(const WCHAR* bang, std::vector<std::wstring>& args, Skin* skin);
 	void ExecuteCommand(const WCHAR* command, Skin* skin, bool multi = true);
+	void ExecuteAction(const ActionProgram& action, Skin* skin);
 	void DelayedExecuteCommand(const WCHAR* command, Skin* skin = nullptr);
 
 	void RefreshAll();
@@ -184,6 +191,10 @@ private:
 
 	static LRESULT CALLBACK MainWndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 
+	static void OnSkinTimer(void* owner, UINT_PTR id);
+	void RunSkinTimers();
+	void ScheduleSkinTimers();
+
 	void ActivateActiveSkins();
 	void CreateSkin(const std::wstring& folderPath, const std::wstring& file);
 	void DeleteAllSkins();
@@ -206,6 +217,7 @@ private:
 
 	std::multimap<int, int> m_SkinOrders;
 	std::map<std::wstring, Skin*> m_Skins;
+	GroupIndex<Skin> m_SkinGroups;
 	std::list<Skin*> m_UnmanagedSkins;
 	std::vector<std::wstring> m_Layouts;
 	std::vector<std::wstring> m_Favorites;
@@ -242,6 +254,12 @@ private:
 
 	bool m_DisableDragging;
 
+	bool m_SkinCache;
+
+	TimerScheduler m_SkinTimers;
+	ULONGLONG m_SkinTimerDueTime;
+	UINT m_TimerSlack;
+
 	std::wstring m_SkinEditor;
 
 	CommandHandler m_CommandHandler;
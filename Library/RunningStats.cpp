@@ -0,0 +1,162 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "RunningStats.h"
+
+RunningAverage::RunningAverage() :
+	m_Pos(),
+	m_Updates(),
+	m_Sum(),
+	m_Compensation()
+{
+}
+
+void RunningAverage::Resize(size_t size, double value)
+{
+	m_Values.resize(size, value);
+	if (m_Pos >= size) m_Pos = 0;
+
+	Recalculate();
+}
+
+double RunningAverage::Add(double value)
+{
+	const size_t size = m_Values.size();
+	const double oldValue = m_Values[m_Pos];
+	m_Values[m_Pos] = value;
+
+	++m_Pos;
+	m_Pos %= size;
+
+	if (++m_Updates >= size)
+	{
+		// Discard the rounding errors accumulated over the window.
+		Recalculate();
+	}
+	else
+	{
+		Accumulate(value);
+		Accumulate(-oldValue);
+
+		if (!_finite(m_Sum))
+		{
+			// The sum cannot recover from NaN or infinity by subtraction.
+			Recalculate();
+		}
+	}
+
+	return m_Sum / (double)size;
+}
+
+void RunningAverage::Accumulate(double value)
+{
+	const double y = value - m_Compensation;
+	const double t = m_Sum + y;
+	m_Compensation = (t - m_Sum) - y;
+	m_Sum = t;
+}
+
+void RunningAverage::Recalculate()
+{
+	m_Sum = 0.0;
+	m_Compensation = 0.0;
+	for (size_t i = 0, isize = m_Values.size(); i < isize; ++i)
+	{
+		Accumulate(m_Values[i]);
+	}
+
+	if (!_finite(m_Sum))
+	{
+		// The compensation turns infinity into NaN so use the plain sum instead.
+		m_Sum = 0.0;
+		m_Compensation = 0.0;
+		for (size_t i = 0, isize = m_Values.size(); i < isize; ++i)
+		{
+			m_Sum += m_Values[i];
+		}
+	}
+
+	m_Updates = 0;
+}
+
+RunningMedian::RunningMedian() :
+	m_Pos()
+{
+}
+
+void RunningMedian::Resize(size_t size, double value)
+{
+	m_Values.resize(size, value);
+	if (m_Pos >= size) m_Pos = 0;
+
+	m_Lower.clear();
+	m_Upper.clear();
+	for (size_t i = 0; i < size; ++i)
+	{
+		Insert(m_Values[i]);
+		Balance();
+	}
+}
+
+double RunningMedian::Add(double value)
+{
+	const double oldValue = m_Values[m_Pos];
+	m_Values[m_Pos] = value;
+
+	++m_Pos;
+	m_Pos %= m_Values.size();
+
+	auto iter = m_Lower.find(oldValue);
+	if (iter != m_Lower.end())
+	{
+		m_Lower.erase(iter);
+	}
+	else
+	{
+		m_Upper.erase(m_Upper.find(oldValue));
+	}
+
+	Insert(value);
+	Balance();
+
+	return *m_Upper.begin();
+}
+
+void RunningMedian::Insert(double value)
+{
+	if (!m_Lower.empty() && Less()(value, *m_Lower.rbegin()))
+	{
+		m_Lower.insert(value);
+	}
+	else
+	{
+		m_Upper.insert(value);
+	}
+}
+
+/*
+** Moves values between the sets so that m_Lower contains half of the values (rounded down).
+**
+*/
+void RunningMedian::Balance()
+{
+	const size_t lowerSize = (m_Lower.size() + m_Upper.size()) / 2;
+	while (m_Lower.size() > lowerSize)
+	{
+		auto iter = std::prev(m_Lower.end());
+		m_Upper.insert(*iter);
+		m_Lower.erase(iter);
+	}
+
+	while (m_Lower.size() < lowerSize)
+	{
+		auto iter = m_Upper.begin();
+		m_Lower.insert(*iter);
+		m_Upper.erase(iter);
+	}
+}
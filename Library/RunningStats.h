@@ -0,0 +1,107 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#ifndef RM_LIBRARY_RUNNINGSTATS_H_
+#define RM_LIBRARY_RUNNINGSTATS_H_
+
+#include <Windows.h>
+#include <set>
+#include <vector>
+
+// Average of the last GetSize() values. The sum is updated with Kahan summation when a value is
+// added and recalculated from scratch once per window, so Add() takes constant amortized time.
+class RunningAverage
+{
+public:
+	RunningAverage();
+
+	size_t GetSize() const { return m_Values.size(); }
+
+	// Like std::vector::resize(): existing values are kept and new slots are set to value.
+	void Resize(size_t size, double value);
+	void Clear() { Resize(0, 0.0); }
+
+	// Replaces the oldest value and returns the new average. The size must not be zero.
+	double Add(double value);
+
+private:
+	void Accumulate(double value);
+	void Recalculate();
+
+	std::vector<double> m_Values;
+	size_t m_Pos;
+	size_t m_Updates;		// Since the last Recalculate()
+	double m_Sum;
+	double m_Compensation;
+};
+
+// Median of the last GetSize() values, i.e. the value at index GetSize() / 2 when the values are
+// sorted. The values are kept in two ordered sets split at the median so that Add() takes
+// logarithmic time. NaN is ordered after all other values.
+class RunningMedian
+{
+public:
+	RunningMedian();
+
+	size_t GetSize() const { return m_Values.size(); }
+
+	// Like std::vector::resize(): existing values are kept and new slots are set to value.
+	void Resize(size_t size, double value);
+	void Clear() { Resize(0, 0.0); }
+
+	// Replaces the oldest value and returns the new median. The size must not be zero.
+	double Add(double value);
+
+private:
+	struct Less
+	{
+		bool operator()(double a, double b) const { return a < b || (a == a && b != b); }
+	};
+
+	void Insert(double value);
+	void Balance();
+
+	std::vector<double> m_Values;
+	size_t m_Pos;
+
+	std::multiset<double, Less> m_Lower;	// The GetSize() / 2 smallest values
+	std::multiset<double, Less> m_Upper;
+};
+
+// Exponential moving average with the same center of mass as a simple average over size values,
+// i.e. with the smoothing factor 2 / (size + 1).
+class ExponentialAverage
+{
+public:
+	ExponentialAverage() : m_Alpha(1.0), m_Value(), m_HasValue(false) {}
+
+	void SetSize(UINT size) { m_Alpha = 2.0 / ((double)size + 1.0); }
+	void Clear() { m_HasValue = false; }
+
+	double Add(double value)
+	{
+		// Start over with the new value if there is no previous value or if it is NaN or infinite.
+		if (m_HasValue && _finite(m_Value))
+		{
+			m_Value += m_Alpha * (value - m_Value);
+		}
+		else
+		{
+			m_Value = value;
+			m_HasValue = true;
+		}
+
+		return m_Value;
+	}
+
+private:
+	double m_Alpha;
+	double m_Value;
+	bool m_HasValue;
+};
+
+#endif
@@ -0,0 +1,96 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "RunningStats.h"
+#include "../Common/UnitTest.h"
+
+TEST_CLASS(Library_RunningStats_Test)
+{
+public:
+	TEST_METHOD(TestRunningAverage)
+	{
+		RunningAverage average;
+		average.Resize(4, 2.0);
+		Assert::AreEqual(2.5, average.Add(4.0));
+		Assert::AreEqual(3.0, average.Add(4.0));
+		Assert::AreEqual(3.5, average.Add(4.0));
+		Assert::AreEqual(4.0, average.Add(4.0));
+		Assert::AreEqual(3.0, average.Add(0.0));
+
+		// Growing keeps the existing values.
+		average.Resize(5, 9.0);
+		Assert::AreEqual(5.2, average.Add(9.0));
+
+		// Non-finite values only affect the average while they are in the window.
+		average.Resize(2, 0.0);
+		average.Add(1.0);
+		average.Add(std::numeric_limits<double>::infinity());
+		Assert::IsTrue(average.Add(1.0) == std::numeric_limits<double>::infinity());
+		Assert::AreEqual(1.0, average.Add(1.0));
+
+		// Compare with summing the window.
+		average.Clear();
+		average.Resize(1000, 0.0);
+		std::vector<double> window(1000, 0.0);
+		size_t pos = 0;
+		unsigned int seed = 1;
+		for (int i = 0; i < 100000; ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			const double value = (double)((seed >> 8) % 100000) / 7.0;
+			window[pos] = value;
+			pos = (pos + 1) % window.size();
+
+			double sum = 0.0;
+			for (double v : window) sum += v;
+			const double result = average.Add(value);
+			Assert::IsTrue(fabs(result - sum / window.size()) <= 1e-9 * fabs(result));
+		}
+	}
+
+	TEST_METHOD(TestRunningMedian)
+	{
+		RunningMedian median;
+		median.Resize(3, 0.0);
+		Assert::AreEqual(0.0, median.Add(5.0));
+		Assert::AreEqual(1.0, median.Add(1.0));
+		Assert::AreEqual(3.0, median.Add(3.0));
+		Assert::AreEqual(3.0, median.Add(9.0));
+		Assert::AreEqual(3.0, median.Add(1.0));
+		Assert::AreEqual(1.0, median.Add(1.0));
+
+		// Compare with sorting the window.
+		median.Resize(8, 0.0);
+		std::vector<double> window(8, 0.0);
+		size_t pos = 0;
+		unsigned int seed = 1;
+		for (int i = 0; i < 1000; ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			const double value = (double)((seed >> 16) % 10);
+			window[pos] = value;
+			pos = (pos + 1) % window.size();
+
+			std::vector<double> sorted = window;
+			std::sort(sorted.begin(), sorted.end());
+			Assert::AreEqual(sorted[sorted.size() / 2], median.Add(value));
+		}
+	}
+
+	TEST_METHOD(TestExponentialAverage)
+	{
+		ExponentialAverage average;
+		average.SetSize(3);
+		Assert::AreEqual(4.0, average.Add(4.0));
+		Assert::AreEqual(6.0, average.Add(8.0));
+		Assert::AreEqual(5.0, average.Add(4.0));
+
+		average.Clear();
+		Assert::AreEqual(1.0, average.Add(1.0));
+	}
+};
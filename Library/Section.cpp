@@ -38,7 +38,7 @@ void Section::ReadOptions(ConfigParser& parser, const WCHAR* section)
 
 	m_DynamicVariables = parser.ReadBool(section, L"DynamicVariables", false);
 
-	m_OnUpdateAction = parser.ReadString(section, L"OnUpdateAction", L"", false);
+	m_OnUpdateAction.Set(parser.ReadString(section, L"OnUpdateAction", L"", false));
 
 	const std::wstring& group = parser.ReadString(section, L"Group", L"");
 	InitializeGroup(group);
@@ -63,8 +63,8 @@ bool Section::UpdateCounter()
 */
 void Section::DoUpdateAction()
 {
-	if (!m_OnUpdateAction.empty())
+	if (!m_OnUpdateAction.IsEmpty())
 	{
-		GetRainmeter().ExecuteCommand(m_OnUpdateAction.c_str(), m_Skin);
+		GetRainmeter().ExecuteAction(m_OnUpdateAction, m_Skin);
 	}
 }
@@ -10,6 +10,7 @@
 
 #include <windows.h>
 #include <string>
+#include "CommandHandler.h"
 #include "Group.h"
 
 class ConfigParser;
@@ -34,7 +35,7 @@ public:
 	int GetUpdateCounter() const { return m_UpdateCounter; }
 	int GetUpdateDivider() const { return m_UpdateDivider; }
 
-	const std::wstring& GetOnUpdateAction() { return m_OnUpdateAction; }
+	const std::wstring& GetOnUpdateAction() { return m_OnUpdateAction.GetText(); }
 	void DoUpdateAction();
 
 	Skin* GetSkin() { return m_Skin; }
@@ -54,7 +55,7 @@ protected:
 	int m_UpdateDivider;			// Divider for the update
 	int m_UpdateCounter;			// Current update counter
 
-	std::wstring m_OnUpdateAction;
+	ActionProgram m_OnUpdateAction;
 
 	Skin* m_Skin;
 };
@@ -22,6 +22,8 @@
 #include "MeasurePlugin.h"
 #include "MeasureTime.h"
 #include "MeterButton.h"
+#include "MeterHistogram.h"
+#include "MeterLine.h"
 #include "MeterString.h"
 #include "TintedImage.h"
 #include "MeasureScript.h"
@@ -122,7 +124,19 @@ Skin::Skin(const std::wstring& folderPath, const std::wstring& file) : m_FolderP
 	m_State(STATE_INITIALIZING),
 	m_Hidden(false),
 	m_ResizeWindow(RESIZEMODE_NONE),
+	m_DependencyUpdate(false),
+	m_FullUpdate(true),
+	m_VariablesVersion(),
+	m_ParallelUpdate(false),
+	m_PartialRedraw(false),
+	m_BatchUpdate(false),
+	m_BatchDepth(0),
+	m_BatchAllMeters(false),
+	m_BatchRedraw(false),
+	m_LayerCacheHits(),
+	m_LayerCacheMisses(),
 	m_UpdateCounter(),
+	m_MeterPass(),
 	m_MouseMoveCounter(),
 	m_FontCollection(),
 	m_ToolTipHidden(false),
@@ -155,6 +169,7 @@ Skin::~Skin()
 	}
 
 	Dispose(false);
+	GetRainmeter().KillSkinTimers(this);
 
 	--c_InstanceCount;
 
@@ -171,10 +186,10 @@ Skin::~Skin()
 void Skin::Dispose(bool refresh)
 {
 	// Kill the timer/hook
-	KillTimer(m_Window, TIMER_METER);
-	KillTimer(m_Window, TIMER_MOUSE);
+	GetRainmeter().KillSkinTimer(this, TIMER_METER);
+	GetRainmeter().KillSkinTimer(this, TIMER_MOUSE);
 	KillTimer(m_Window, TIMER_FADE);
-	KillTimer(m_Window, TIMER_TRANSITION);
+	GetRainmeter().KillSkinTimer(this, TIMER_TRANSITION);
 
 	m_FadeStartTime = 0;
 
@@ -186,6 +201,17 @@ void Skin::Dispose(bool refresh)
 	m_MouseOver = false;
 	SetMouseLeaveEvent(true);
 
+	if (m_LayerCacheHits != 0 || m_LayerCacheMisses != 0)
+	{
+		if (GetRainmeter().GetDebug())
+		{
+			LogDebugF(this, L"CacheLayer: %u hits, %u misses", m_LayerCacheHits, m_LayerCacheMisses);
+		}
+
+		m_LayerCacheHits = 0;
+		m_LayerCacheMisses = 0;
+	}
+
 	// Destroy the meters
 	for (auto j = m_Meters.begin(); j != m_Meters.end(); ++j)
 	{
@@ -193,6 +219,11 @@ void Skin::Dispose(bool refresh)
 	}
 	m_Meters.clear();
 
+	m_BatchDepth = 0;
+	m_BatchAllMeters = false;
+	m_BatchRedraw = false;
+	m_BatchMeters.clear();
+
 	// Destroy the measures
 	for (auto i = m_Measures.begin(); i != m_Measures.end(); ++i)
 	{
@@ -200,6 +231,11 @@ void Skin::Dispose(bool refresh)
 	}
 	m_Measures.clear();
 
+	m_Parser.ClearSymbols();
+
+	m_UpdateGraph.Reset(0);
+	m_UpdateValues.clear();
+
 	delete m_Background;
 	m_Background = nullptr;
 
@@ -411,10 +447,10 @@ void Skin::Refresh(bool init, bool all)
 	// Start the timers
 	if (m_WindowUpdate >= 0)
 	{
-		SetTimer(m_Window, TIMER_METER, m_WindowUpdate, nullptr);
+		GetRainmeter().SetSkinTimer(this, TIMER_METER, m_WindowUpdate);
 	}
 
-	SetTimer(m_Window, TIMER_MOUSE, INTERVAL_MOUSE, nullptr);
+	GetRainmeter().SetSkinTimer(this, TIMER_MOUSE, INTERVAL_MOUSE);
 
 	GetRainmeter().SetCurrentParser(nullptr);
 
@@ -649,6 +685,9 @@ void Skin::ChangeSingleZPos(ZPOSITION zPos, bool all)
 */
 void Skin::DoBang(Bang bang, const std::vector<std::wstring>& args)
 {
+	// Bangs may change sections without changing any measure, so update everything.
+	m_FullUpdate = true;
+
 	switch (bang)
 	{
 	case Bang::Refresh:
@@ -657,15 +696,30 @@ void Skin::DoBang(Bang bang, const std::vector<std::wstring>& args)
 		break;
 
 	case Bang::Redraw:
-		Redraw();
+		if (m_BatchDepth > 0)
+		{
+			m_BatchRedraw = true;
+		}
+		else
+		{
+			Redraw();
+		}
+		break;
+
+	case Bang::BeginBatch:
+		BeginBatch();
+		break;
+
+	case Bang::EndBatch:
+		EndBatch();
 		break;
 
 	case Bang::Update:
-		KillTimer(m_Window, TIMER_METER);  // Kill timer temporarily
+		GetRainmeter().KillSkinTimer(this, TIMER_METER);  // Kill timer temporarily
 		Update(false);
 		if (m_WindowUpdate >= 0)
 		{
-			SetTimer(m_Window, TIMER_METER, m_WindowUpdate, nullptr);
+			GetRainmeter().SetSkinTimer(this, TIMER_METER, m_WindowUpdate);
 		}
 		break;
 
@@ -950,7 +1004,7 @@ void Skin::DoDelayedCommand(const WCHAR* command, UINT delay)
 {
 	static UINT_PTR id = TIMER_MAX;
 	++id;
-	SetTimer(m_Window, id, delay, nullptr);
+	GetRainmeter().SetSkinTimer(this, id, delay);
 	m_DelayedCommands.emplace(id, command);
 }
 
@@ -1067,6 +1121,42 @@ void Skin::ResizeBlur(const std::wstring& arg, int mode)
 	free(parseSz);
 }
 
+/*
+** Returns the meters in the given group in skin order.
+**
+*/
+const std::vector<Meter*>& Skin::GetMeterGroup(const std::wstring& group)
+{
+	if (!m_MeterGroups.IsCurrent())
+	{
+		m_MeterGroups.Clear();
+		for (auto j = m_Meters.cbegin(); j != m_Meters.cend(); ++j)
+		{
+			m_MeterGroups.Add(*j);
+		}
+	}
+
+	return m_MeterGroups.Get(group);
+}
+
+/*
+** Returns the measures in the given group in skin order.
+**
+*/
+const std::vector<Measure*>& Skin::GetMeasureGroup(const std::wstring& group)
+{
+	if (!m_MeasureGroups.IsCurrent())
+	{
+		m_MeasureGroups.Clear();
+		for (auto i = m_Measures.cbegin(); i != m_Measures.cend(); ++i)
+		{
+			m_MeasureGroups.Add(*i);
+		}
+	}
+
+	return m_MeasureGroups.Get(group);
+}
+
 // Helper function that compares the given name to section's name.
 bool CompareName(const Section* section, const WCHAR* name, bool group)
 {
@@ -1077,10 +1167,10 @@ void Skin::ShowMeter(const std::wstring& name, bool group)
 {
 	const WCHAR* meter = name.c_str();
 
-	std::vector<Meter*>::const_iterator j = m_Meters.begin();
-	for ( ; j != m_Meters.end(); ++j)
+	const std::vector<Meter*>& meters = group ? GetMeterGroup(name) : m_Meters;
+	for (auto j = meters.cbegin(); j != meters.cend(); ++j)
 	{
-		if (CompareName((*j), meter, group))
+		if (group || CompareName((*j), meter, false))
 		{
 			(*j)->Show();
 			SetResizeWindowMode(RESIZEMODE_CHECK);	// Need to recalculate the window size
@@ -1095,10 +1185,10 @@ void Skin::HideMeter(const std::wstring& name, bool group)
 {
 	const WCHAR* meter = name.c_str();
 
-	std::vector<Meter*>::const_iterator j = m_Meters.begin();
-	for ( ; j != m_Meters.end(); ++j)
+	const std::vector<Meter*>& meters = group ? GetMeterGroup(name) : m_Meters;
+	for (auto j = meters.cbegin(); j != meters.cend(); ++j)
 	{
-		if (CompareName((*j), meter, group))
+		if (group || CompareName((*j), meter, false))
 		{
 			(*j)->Hide();
 			SetResizeWindowMode(RESIZEMODE_CHECK);	// Need to recalculate the window size
@@ -1113,10 +1203,10 @@ void Skin::ToggleMeter(const std::wstring& name, bool group)
 {
 	const WCHAR* meter = name.c_str();
 
-	std::vector<Meter*>::const_iterator j = m_Meters.begin();
-	for ( ; j != m_Meters.end(); ++j)
+	const std::vector<Meter*>& meters = group ? GetMeterGroup(name) : m_Meters;
+	for (auto j = meters.cbegin(); j != meters.cend(); ++j)
 	{
-		if (CompareName((*j), meter, group))
+		if (group || CompareName((*j), meter, false))
 		{
 			if ((*j)->IsHidden())
 			{
@@ -1164,6 +1254,33 @@ void Skin::UpdateMeter(const std::wstring& name, bool group)
 		group = true;
 	}
 
+	if (m_BatchDepth > 0)
+	{
+		// Record the meters to be updated when the batch ends.
+		if (all)
+		{
+			m_BatchAllMeters = true;
+			return;
+		}
+
+		if (group)
+		{
+			const std::vector<Meter*>& meters = GetMeterGroup(name);
+			m_BatchMeters.insert(meters.cbegin(), meters.cend());
+		}
+		else if (Meter* found = GetMeter(name))
+		{
+			m_BatchMeters.insert(found);
+		}
+		else
+		{
+			LogErrorF(this, L"!UpdateMeter: [%s] not found", meter);
+		}
+		return;
+	}
+
+	++m_MeterPass;
+
 	bool bActiveTransition = false;
 	bool bContinue = true;
 	for (auto j = m_Meters.cbegin(); j != m_Meters.cend(); ++j)
@@ -1203,10 +1320,10 @@ void Skin::EnableMeasure(const std::wstring& name, bool group)
 {
 	const WCHAR* measure = name.c_str();
 
-	std::vector<Measure*>::const_iterator i = m_Measures.begin();
-	for ( ; i != m_Measures.end(); ++i)
+	const std::vector<Measure*>& measures = group ? GetMeasureGroup(name) : m_Measures;
+	for (auto i = measures.cbegin(); i != measures.cend(); ++i)
 	{
-		if (CompareName((*i), measure, group))
+		if (group || CompareName((*i), measure, false))
 		{
 			(*i)->Enable();
 			if (!group) return;
@@ -1220,10 +1337,10 @@ void Skin::DisableMeasure(const std::wstring& name, bool group)
 {
 	const WCHAR* measure = name.c_str();
 
-	std::vector<Measure*>::const_iterator i = m_Measures.begin();
-	for ( ; i != m_Measures.end(); ++i)
+	const std::vector<Measure*>& measures = group ? GetMeasureGroup(name) : m_Measures;
+	for (auto i = measures.cbegin(); i != measures.cend(); ++i)
 	{
-		if (CompareName((*i), measure, group))
+		if (group || CompareName((*i), measure, false))
 		{
 			(*i)->Disable();
 			if (!group) return;
@@ -1237,10 +1354,10 @@ void Skin::ToggleMeasure(const std::wstring& name, bool group)
 {
 	const WCHAR* measure = name.c_str();
 
-	std::vector<Measure*>::const_iterator i = m_Measures.begin();
-	for ( ; i != m_Measures.end(); ++i)
+	const std::vector<Measure*>& measures = group ? GetMeasureGroup(name) : m_Measures;
+	for (auto i = measures.cbegin(); i != measures.cend(); ++i)
 	{
-		if (CompareName((*i), measure, group))
+		if (group || CompareName((*i), measure, false))
 		{
 			if ((*i)->IsDisabled())
 			{
@@ -1261,10 +1378,10 @@ void Skin::PauseMeasure(const std::wstring& name, bool group)
 {
 	const WCHAR* measure = name.c_str();
 
-	std::vector<Measure*>::const_iterator i = m_Measures.begin();
-	for ( ; i != m_Measures.end(); ++i)
+	const std::vector<Measure*>& measures = group ? GetMeasureGroup(name) : m_Measures;
+	for (auto i = measures.cbegin(); i != measures.cend(); ++i)
 	{
-		if (CompareName((*i), measure, group))
+		if (group || CompareName((*i), measure, false))
 		{
 			(*i)->Pause();
 			if (!group) return;
@@ -1278,10 +1395,10 @@ void Skin::UnpauseMeasure(const std::wstring& name, bool group)
 {
 	const WCHAR* measure = name.c_str();
 
-	std::vector<Measure*>::const_iterator i = m_Measures.begin();
-	for ( ; i != m_Measures.end(); ++i)
+	const std::vector<Measure*>& measures = group ? GetMeasureGroup(name) : m_Measures;
+	for (auto i = measures.cbegin(); i != measures.cend(); ++i)
 	{
-		if (CompareName((*i), measure, group))
+		if (group || CompareName((*i), measure, false))
 		{
 			(*i)->Unpause();
 			if (!group) return;
@@ -1295,10 +1412,10 @@ void Skin::TogglePauseMeasure(const std::wstring& name, bool group)
 {
 	const WCHAR* measure = name.c_str();
 
-	std::vector<Measure*>::const_iterator i = m_Measures.begin();
-	for ( ; i != m_Measures.end(); ++i)
+	const std::vector<Measure*>& measures = group ? GetMeasureGroup(name) : m_Measures;
+	for (auto i = measures.cbegin(); i != measures.cend(); ++i)
 	{
-		if (CompareName((*i), measure, group))
+		if (group || CompareName((*i), measure, false))
 		{
 			if ((*i)->IsPaused())
 			{
@@ -1326,10 +1443,18 @@ void Skin::UpdateMeasure(const std::wstring& name, bool group)
 		group = true;
 	}
 
+	// The members are copied since the update actions may change the groups.
+	std::vector<Measure*> members;
+	if (group && !all)
+	{
+		members = GetMeasureGroup(name);
+	}
+
+	const std::vector<Measure*>& measures = (group && !all) ? members : m_Measures;
 	bool bNetStats = m_HasNetMeasures;
-	for (auto i = m_Measures.cbegin(); i != m_Measures.cend(); ++i)
+	for (auto i = measures.cbegin(); i != measures.cend(); ++i)
 	{
-		if (all || CompareName((*i), measure, group))
+		if (all || group || CompareName((*i), measure, false))
 		{
 			if (bNetStats && (*i)->GetTypeID() == TypeID<MeasureNet>())
 			{
@@ -1393,20 +1518,14 @@ void Skin::SetOption(const std::wstring& section, const std::wstring& option, co
 
 	if (group)
 	{
-		for (auto j = m_Meters.begin(); j != m_Meters.end(); ++j)
+		for (Meter* meter : GetMeterGroup(section))
 		{
-			if ((*j)->BelongsToGroup(section))
-			{
-				setValue(*j, option, value);
-			}
+			setValue(meter, option, value);
 		}
 
-		for (auto i = m_Measures.begin(); i != m_Measures.end(); ++i)
+		for (Measure* measure : GetMeasureGroup(section))
 		{
-			if ((*i)->BelongsToGroup(section))
-			{
-				setValue(*i, option, value);
-			}
+			setValue(measure, option, value);
 		}
 	}
 	else
@@ -2046,6 +2165,10 @@ bool Skin::ReadSkin()
 	m_WindowUpdate = m_Parser.ReadInt(L"Rainmeter", L"Update", INTERVAL_METER);
 	m_TransitionUpdate = m_Parser.ReadInt(L"Rainmeter", L"TransitionUpdate", INTERVAL_TRANSITION);
 	m_DefaultUpdateDivider = m_Parser.ReadInt(L"Rainmeter", L"DefaultUpdateDivider", 1);
+	m_DependencyUpdate = m_Parser.ReadBool(L"Rainmeter", L"DependencyUpdate", false);
+	m_ParallelUpdate = m_Parser.ReadBool(L"Rainmeter", L"ParallelUpdate", false);
+	m_PartialRedraw = m_Parser.ReadBool(L"Rainmeter", L"PartialRedraw", false);
+	m_BatchUpdate = m_Parser.ReadBool(L"Rainmeter", L"BatchUpdate", false);
 	m_ToolTipHidden = m_Parser.ReadBool(L"Rainmeter", L"ToolTipHidden", false);
 
 	if (m_Parser.ReadBool(L"Rainmeter", L"Blur", false))
@@ -2216,6 +2339,7 @@ bool Skin::ReadSkin()
 				if (meter)
 				{
 					m_Meters.push_back(meter);
+					m_Parser.AddMeter(meter);
 					meter->SetRelativeMeter(prevMeter);
 
 					if (meter->GetTypeID() == TypeID<MeterButton>())
@@ -2231,6 +2355,24 @@ bool Skin::ReadSkin()
 		}
 	}
 
+	if (m_DependencyUpdate)
+	{
+		// Scripts can change other sections directly so their effects cannot be tracked.
+		for (auto iter = m_Measures.cbegin(); iter != m_Measures.cend(); ++iter)
+		{
+			if ((*iter)->GetTypeID() == TypeID<MeasureScript>())
+			{
+				LogNoticeF(this, L"DependencyUpdate is ignored in skins with Script measures");
+				m_DependencyUpdate = false;
+				break;
+			}
+		}
+
+		m_UpdateValues.assign(m_Measures.size(), MeasureValueSet(0.0, L""));
+	}
+
+	m_FullUpdate = true;
+
 	if (m_Meters.empty())
 	{
 		std::wstring text = GetFormattedString(ID_STR_NOMETERSINSKIN, m_FolderPath.c_str(), m_FileName.c_str());
@@ -2268,6 +2410,7 @@ bool Skin::ReadSkin()
 	}
 
 	// Set window size (and CURRENTCONFIGWIDTH/HEIGHT) temporarily
+	++m_MeterPass;
 	for (auto iter = m_Meters.cbegin(); iter != m_Meters.cend(); ++iter)
 	{
 		bool bActiveTransition = true;  // Do not track the change of ActiveTransition
@@ -2468,7 +2611,7 @@ void Skin::CreateDoubleBuffer(int cx, int cy)
 ** Redraws the meters and paints the window
 **
 */
-void Skin::Redraw()
+void Skin::Redraw(bool partial)
 {
 	if (m_ResizeWindow)
 	{
@@ -2491,14 +2634,27 @@ void Skin::Redraw()
 		if (cx != m_Canvas.GetW() || cy != m_Canvas.GetH())
 		{
 			CreateDoubleBuffer(cx, cy);
+			partial = false;
 		}
 	}
 
+	// A partial redraw only draws the area covered by the meters that have changed or moved.
+	Rect redrawRect;
+	if (partial && !GetRedrawRect(redrawRect))
+	{
+		return;
+	}
+
 	if (!m_Canvas.BeginDraw())
 	{
 		return;
 	}
 
+	if (partial)
+	{
+		m_Canvas.SetClip(redrawRect);
+	}
+
 	m_Canvas.Clear();
 
 	if (m_WindowW != 0 && m_WindowH != 0)
@@ -2553,25 +2709,98 @@ void Skin::Redraw()
 		std::vector<Meter*>::const_iterator j = m_Meters.begin();
 		for ( ; j != m_Meters.end(); ++j)
 		{
-			const Matrix* matrix = (*j)->GetTransformationMatrix();
-			if (matrix && !matrix->IsIdentity())
-			{
-				m_Canvas.SetTransform(*matrix);
-				(*j)->Draw(m_Canvas);
-				m_Canvas.ResetTransform();
-			}
-			else
+			const Rect drawRect = (*j)->GetDrawRect();
+			if (!partial || redrawRect.IntersectsWith(drawRect))
 			{
-				(*j)->Draw(m_Canvas);
+				DrawMeter(*j, drawRect);
 			}
+
+			(*j)->SetDrawnRect(drawRect);
+			(*j)->SetChanged(false);
 		}
 	}
 
+	if (partial)
+	{
+		m_Canvas.ResetClip();
+	}
+
 	UpdateWindow(m_TransparencyValue, true);
 
 	m_Canvas.EndDraw();
 }
 
+/*
+** Draws the meter to the canvas, through its cached layer with CacheLayer=1.
+**
+*/
+void Skin::DrawMeter(Meter* meter, const Rect& drawRect)
+{
+	if (meter->GetCacheLayer() && meter->IsLayerCacheable() && !meter->HasActiveTransition() &&
+		!drawRect.IsEmptyArea())
+	{
+		if (meter->DrawLayer(m_Canvas, drawRect))
+		{
+			++m_LayerCacheHits;
+		}
+		else
+		{
+			++m_LayerCacheMisses;
+		}
+		return;
+	}
+
+	const Matrix* matrix = meter->GetTransformationMatrix();
+	if (matrix && !matrix->IsIdentity())
+	{
+		m_Canvas.SetTransform(*matrix);
+		meter->Draw(m_Canvas);
+		m_Canvas.ResetTransform();
+	}
+	else
+	{
+		meter->Draw(m_Canvas);
+	}
+}
+
+/*
+** Gets the bounding rectangle of the old and new areas of the meters that have changed or moved
+** since the last redraw. Returns false if nothing needs to be redrawn.
+**
+*/
+bool Skin::GetRedrawRect(Rect& rect)
+{
+	rect = Rect();
+
+	auto addRect = [&rect](const Rect& other)
+	{
+		if (other.IsEmptyArea()) return;
+
+		if (rect.IsEmptyArea())
+		{
+			rect = other;
+		}
+		else
+		{
+			Rect::Union(rect, rect, other);
+		}
+	};
+
+	for (auto iter = m_Meters.cbegin(); iter != m_Meters.cend(); ++iter)
+	{
+		Meter* meter = *iter;
+		const Rect drawRect = meter->GetDrawRect();
+		const Rect& drawnRect = meter->GetDrawnRect();
+		if (meter->IsChanged() || !drawRect.Equals(drawnRect))
+		{
+			addRect(drawRect);
+			addRect(drawnRect);
+		}
+	}
+
+	return rect.Intersect(Rect(0, 0, m_Canvas.GetW(), m_Canvas.GetH())) != FALSE;
+}
+
 /*
 ** Updates the transition state
 **
@@ -2581,24 +2810,96 @@ void Skin::PostUpdate(bool bActiveTransition)
 	// Start/stop the transition timer if necessary
 	if (bActiveTransition && !m_ActiveTransition)
 	{
-		SetTimer(m_Window, TIMER_TRANSITION, m_TransitionUpdate, nullptr);
+		GetRainmeter().SetSkinTimer(this, TIMER_TRANSITION, m_TransitionUpdate);
 		m_ActiveTransition = true;
 	}
 	else if (m_ActiveTransition && !bActiveTransition)
 	{
-		KillTimer(m_Window, TIMER_TRANSITION);
+		GetRainmeter().KillSkinTimer(this, TIMER_TRANSITION);
 		m_ActiveTransition = false;
 	}
 }
 
+void Skin::BeginBatch()
+{
+	++m_BatchDepth;
+}
+
+void Skin::EndBatch()
+{
+	if (m_BatchDepth == 0) return;
+
+	if (--m_BatchDepth == 0)
+	{
+		FlushBatch();
+	}
+}
+
 /*
-** Updates the given measure
+** Ends the batches that are still open above the given depth. Called after an action so that a
+** !BeginBatch without !EndBatch does not swallow the updates of the skin until it is refreshed.
 **
 */
-bool Skin::UpdateMeasure(Measure* measure, bool force)
+void Skin::EndBatches(int depth)
 {
-	bool bUpdate = false;
+	if (m_BatchDepth <= depth) return;
+
+	LogWarningF(this, L"!BeginBatch without !EndBatch");
+	m_BatchDepth = depth + 1;
+	EndBatch();
+}
 
+/*
+** Updates the meters recorded during the batch once and redraws the skin if requested.
+**
+*/
+void Skin::FlushBatch()
+{
+	// The update actions of the meters may record new ones.
+	std::unordered_set<Meter*> meters;
+	meters.swap(m_BatchMeters);
+	const bool all = m_BatchAllMeters;
+	const bool redraw = m_BatchRedraw;
+	m_BatchAllMeters = false;
+	m_BatchRedraw = false;
+
+	if (all || !meters.empty())
+	{
+		++m_MeterPass;
+
+		bool bActiveTransition = false;
+		for (auto j = m_Meters.cbegin(); j != m_Meters.cend(); ++j)
+		{
+			if (all || meters.count(*j) != 0)
+			{
+				if (UpdateMeter((*j), bActiveTransition, true))
+				{
+					(*j)->DoUpdateAction();
+				}
+			}
+			else if (!bActiveTransition && (*j)->HasActiveTransition())
+			{
+				bActiveTransition = true;
+			}
+		}
+
+		SetResizeWindowMode(RESIZEMODE_CHECK);	// Need to recalculate the window size
+		PostUpdate(bActiveTransition);
+	}
+
+	if (redraw)
+	{
+		Redraw();
+	}
+}
+
+/*
+** Starts the update of the given measure. Returns true if the value of the measure needs to be
+** calculated, in which case Measure::CalculateValue() and Measure::EndUpdate() must follow.
+**
+*/
+bool Skin::BeginUpdateMeasure(Measure* measure, bool force, bool& rereadOptions)
+{
 	if (force)
 	{
 		measure->ResetUpdateCounter();
@@ -2607,12 +2908,29 @@ bool Skin::UpdateMeasure(Measure* measure, bool force)
 	int updateDivider = measure->GetUpdateDivider();
 	if (updateDivider >= 0 || force)
 	{
-		const bool rereadOptions =
+		rereadOptions =
 			measure->HasDynamicVariables() && (measure->GetUpdateCounter() + 1) >= updateDivider;
-		bUpdate = measure->Update(rereadOptions);
+		return measure->BeginUpdate(rereadOptions);
 	}
 
-	return bUpdate;
+	return false;
+}
+
+/*
+** Updates the given measure
+**
+*/
+bool Skin::UpdateMeasure(Measure* measure, bool force)
+{
+	bool rereadOptions = false;
+	if (BeginUpdateMeasure(measure, force, rereadOptions))
+	{
+		measure->CalculateValue();
+		measure->EndUpdate(rereadOptions);
+		return true;
+	}
+
+	return false;
 }
 
 /*
@@ -2631,13 +2949,21 @@ bool Skin::UpdateMeter(Meter* meter, bool& bActiveTransition, bool force)
 	int updateDivider = meter->GetUpdateDivider();
 	if (updateDivider >= 0 || force)
 	{
+		bool rereadOptions = false;
 		if (meter->HasDynamicVariables() &&
 			(meter->GetUpdateCounter() + 1) >= updateDivider)
 		{
 			meter->ReadOptions(m_Parser);
+			rereadOptions = true;
 		}
 
 		bUpdate = meter->Update();
+
+		// Meters without measures or dynamic options look the same after each update.
+		if (bUpdate && (rereadOptions || !meter->GetMeasures().empty()))
+		{
+			meter->SetChanged(true);
+		}
 	}
 
 	// Update tooltips
@@ -2654,8 +2980,9 @@ bool Skin::UpdateMeter(Meter* meter, bool& bActiveTransition, bool force)
 	}
 
 	// Check for transitions
-	if (!bActiveTransition && meter->HasActiveTransition())
+	if (meter->HasActiveTransition())
 	{
+		meter->SetChanged(true);
 		bActiveTransition = true;
 	}
 
@@ -2669,6 +2996,32 @@ bool Skin::UpdateMeter(Meter* meter, bool& bActiveTransition, bool force)
 void Skin::Update(bool refresh)
 {
 	++m_UpdateCounter;
+	++m_MeterPass;
+
+	// With DependencyUpdate=1, only the sections that depend on changed measures are updated. All
+	// sections are updated (and the dependency graph is rebuilt) after a refresh, after a bang, or
+	// after a variable has been changed. If a bang is executed during the update, the remaining
+	// sections are updated as well.
+	const bool scheduled = m_DependencyUpdate && !refresh && !m_FullUpdate &&
+		m_UpdateGraph.IsBuilt() && m_VariablesVersion == m_Parser.GetVariablesVersion();
+	const bool track = m_DependencyUpdate && !scheduled;
+	const bool ordered = m_DependencyUpdate && m_UpdateGraph.IsBuilt();
+	m_FullUpdate = false;
+	m_VariablesVersion = m_Parser.GetVariablesVersion();
+	m_UpdateGraph.BeginUpdate();
+
+	if (m_BatchUpdate)
+	{
+		BeginBatch();
+	}
+
+	std::vector<std::vector<Measure*>> references;
+	std::vector<bool> tracked;
+	if (track)
+	{
+		references.resize(m_Measures.size() + m_Meters.size());
+		tracked.resize(references.size(), false);
+	}
 
 	if (!m_Measures.empty())
 	{
@@ -2679,36 +3032,142 @@ void Skin::Update(bool refresh)
 			MeasureNet::UpdateStats();
 		}
 
+		// With ParallelUpdate=1, the values of the thread-safe measures are calculated
+		// concurrently before the other measures are updated. The rest of their update (e.g.
+		// IfActions and OnChangeAction) is done in the loop below on this thread.
+		enum { PARALLEL_NONE = 0, PARALLEL_SKIPPED, PARALLEL_CALCULATED };
+		std::vector<BYTE> parallelState;
+		if (m_ParallelUpdate)
+		{
+			parallelState.resize(m_Measures.size(), PARALLEL_NONE);
+
+			std::vector<Measure*> measures;
+			for (size_t i = 0, isize = m_Measures.size(); i < isize; ++i)
+			{
+				const size_t node = ordered ? m_UpdateGraph.GetOrder()[i] : i;
+				if (scheduled && !m_UpdateGraph.IsDirty(node)) continue;
+
+				// Options of measures with DynamicVariables can only be read on this thread.
+				Measure* measure = m_Measures[node];
+				if (measure->IsThreadSafe() && !measure->HasDynamicVariables())
+				{
+					bool rereadOptions = false;
+					if (BeginUpdateMeasure(measure, refresh, rereadOptions))
+					{
+						measures.push_back(measure);
+						parallelState[node] = PARALLEL_CALCULATED;
+					}
+					else
+					{
+						parallelState[node] = PARALLEL_SKIPPED;
+					}
+				}
+			}
+
+			if (!measures.empty())
+			{
+				m_UpdatePool.Run(measures);
+				System::ResetWorkingDirectory();
+			}
+		}
+
 		// Update all measures
-		std::vector<Measure*>::const_iterator i = m_Measures.begin();
-		for ( ; i != m_Measures.end(); ++i)
+		for (size_t i = 0, isize = m_Measures.size(); i < isize; ++i)
 		{
-			if (UpdateMeasure((*i), refresh))
+			const size_t node = ordered ? m_UpdateGraph.GetOrder()[i] : i;
+			if (scheduled && !m_FullUpdate && !m_UpdateGraph.IsDirty(node)) continue;
+
+			Measure* measure = m_Measures[node];
+			bool updated = false;
+			if (!parallelState.empty() && parallelState[node] != PARALLEL_NONE)
 			{
-				(*i)->DoUpdateAction();
-				(*i)->DoChangeAction();
+				if (parallelState[node] == PARALLEL_CALCULATED)
+				{
+					measure->EndUpdate(false);
+					updated = true;
+				}
+
+				if (track) tracked[node] = true;
+			}
+			else
+			{
+				if (track) m_Parser.StartReferenceTracking(&references[node]);
+				updated = UpdateMeasure(measure, refresh);
+				if (track) tracked[node] = m_Parser.StopReferenceTracking();
+			}
+
+			if (updated)
+			{
+				if (m_DependencyUpdate)
+				{
+					const WCHAR* stringValue = measure->GetStringValue();
+					if (m_UpdateValues[node].IsChanged(measure->GetValue(), stringValue ? stringValue : L"") &&
+						scheduled)
+					{
+						m_UpdateGraph.SetChanged(node);
+					}
+				}
+
+				measure->DoUpdateAction();
+				measure->DoChangeAction();
 			}
 		}
 	}
 
 	DialogAbout::UpdateMeasures(this);
 
+	// The meters updated and the redraw requested by the bangs executed so far are merged into the
+	// meter updates and the redraw below.
+	std::unordered_set<Meter*> batchMeters;
+	bool batchAllMeters = false;
+	bool batchRedraw = false;
+	if (m_BatchUpdate)
+	{
+		batchMeters.swap(m_BatchMeters);
+		std::swap(batchAllMeters, m_BatchAllMeters);
+		std::swap(batchRedraw, m_BatchRedraw);
+	}
+
 	// Update all meters
 	bool bActiveTransition = false;
 	bool bUpdate = false;
-	std::vector<Meter*>::const_iterator j = m_Meters.begin();
-	for ( ; j != m_Meters.end(); ++j)
+	for (size_t i = 0, isize = m_Meters.size(); i < isize; ++i)
 	{
-		if (UpdateMeter((*j), bActiveTransition, refresh))
+		Meter* meter = m_Meters[i];
+		const size_t node = m_Measures.size() + i;
+		const bool batched = batchAllMeters || (!batchMeters.empty() && batchMeters.count(meter) != 0);
+		if (batched)
+		{
+			SetResizeWindowMode(RESIZEMODE_CHECK);	// Need to recalculate the window size
+		}
+		else if (scheduled && !m_FullUpdate && !m_UpdateGraph.IsDirty(node))
+		{
+			if (!bActiveTransition && meter->HasActiveTransition())
+			{
+				bActiveTransition = true;
+			}
+			continue;
+		}
+
+		if (track) m_Parser.StartReferenceTracking(&references[node]);
+		const bool updated = UpdateMeter(meter, bActiveTransition, refresh || batched);
+		if (track) tracked[node] = m_Parser.StopReferenceTracking();
+
+		if (updated)
 		{
 			bUpdate = true;
 
-			(*j)->DoUpdateAction();
+			meter->DoUpdateAction();
 		}
 	}
 
+	if (track)
+	{
+		BuildUpdateGraph(references, tracked, refresh);
+	}
+
 	// Redraw all meters
-	if (bUpdate || m_ResizeWindow || refresh)
+	if (bUpdate || m_ResizeWindow || refresh || batchRedraw)
 	{
 		if (m_DynamicWindowSize)
 		{
@@ -2720,7 +3179,7 @@ void Skin::Update(bool refresh)
 		// Only redraw if we are not in a remote session
 		if (GetRainmeter().IsRedrawable())
 		{
-			Redraw();
+			Redraw(m_PartialRedraw && !refresh && !batchRedraw);
 		}
 	}
 
@@ -2731,6 +3190,100 @@ void Skin::Update(bool refresh)
 	{
 		GetRainmeter().ExecuteCommand(m_OnUpdateAction.c_str(), this);
 	}
+
+	if (m_BatchUpdate)
+	{
+		EndBatch();
+	}
+}
+
+/*
+** Builds the dependency graph used with DependencyUpdate=1. |references| contains the measures
+** referenced in the options of each section during the last update and |tracked| is false for
+** sections that referenced something else than measures (e.g. [Meter:X]).
+**
+*/
+void Skin::BuildUpdateGraph(std::vector<std::vector<Measure*>>& references, const std::vector<bool>& tracked, bool log)
+{
+	const size_t measureCount = m_Measures.size();
+
+	std::unordered_map<Measure*, size_t> nodes;
+	for (size_t i = 0; i < measureCount; ++i)
+	{
+		nodes[m_Measures[i]] = i;
+	}
+
+	m_UpdateGraph.Reset(measureCount + m_Meters.size());
+
+	auto addEdges = [&](const std::vector<Measure*>& measures, size_t node)
+	{
+		for (auto measure : measures)
+		{
+			auto iter = nodes.find(measure);
+			if (iter != nodes.end())
+			{
+				m_UpdateGraph.AddEdge(iter->second, node);
+			}
+		}
+	};
+
+	auto isAlwaysUpdated = [&](Section* section, size_t node)
+	{
+		return !tracked[node] || section->GetUpdateDivider() != 1 || !section->GetOnUpdateAction().empty();
+	};
+
+	for (size_t i = 0; i < measureCount; ++i)
+	{
+		Measure* measure = m_Measures[i];
+		std::vector<Measure*>& measures = references[i];
+		const bool derived = measure->GetDependencies(measures);
+
+		addEdges(measures, i);
+		if (!derived || isAlwaysUpdated(measure, i))
+		{
+			m_UpdateGraph.SetAlwaysUpdate(i);
+		}
+	}
+
+	for (size_t i = 0, isize = m_Meters.size(); i < isize; ++i)
+	{
+		Meter* meter = m_Meters[i];
+		const size_t node = measureCount + i;
+
+		addEdges(meter->GetMeasures(), node);
+		addEdges(references[node], node);
+
+		// Line and Histogram meters add a new value to the graph on every update.
+		if (isAlwaysUpdated(meter, node) ||
+			meter->GetTypeID() == TypeID<MeterLine>() ||
+			meter->GetTypeID() == TypeID<MeterHistogram>())
+		{
+			m_UpdateGraph.SetAlwaysUpdate(node);
+		}
+	}
+
+	// The meters are in the graph only to find out when they need to be updated.
+	m_UpdateGraph.Build(measureCount);
+
+	if (log)
+	{
+		for (size_t i = 0; i < measureCount; ++i)
+		{
+			if (m_UpdateGraph.IsCircular(i))
+			{
+				LogDebugF(m_Measures[i], L"Circular reference: Updated on every update cycle");
+			}
+
+			for (size_t dependent : m_UpdateGraph.GetDependents(i))
+			{
+				// Without DependencyUpdate, these measures would use the value of the previous update.
+				if (dependent < i)
+				{
+					LogNoticeF(m_Measures[dependent], L"Updated after [%s] (declared later)", m_Measures[i]->GetName());
+				}
+			}
+		}
+	}
 }
 
 /*
@@ -2774,7 +3327,8 @@ void Skin::UpdateWindowTransparency(int alpha)
 
 /*
 ** Handles the timers. The METERTIMER updates all the measures
-** MOUSETIMER is used to hide/show the window.
+** MOUSETIMER is used to hide/show the window. Apart from the fade and deactivate timers, the
+** timers are run by the shared scheduler in Rainmeter and delivered through OnSkinTimer().
 **
 */
 LRESULT Skin::OnTimer(UINT uMsg, WPARAM wParam, LPARAM lParam)
@@ -2782,6 +3336,9 @@ LRESULT Skin::OnTimer(UINT uMsg, WPARAM wParam, LPARAM lParam)
 	switch (wParam)
 	{
 	case TIMER_METER:
+		// Batches opened on this skin by bangs from other skins are not ended by the action.
+		EndBatches(0);
+
 		Update(false);
 		break;
 
@@ -2846,7 +3403,7 @@ LRESULT Skin::OnTimer(UINT uMsg, WPARAM wParam, LPARAM lParam)
 			else
 			{
 				// Stop the transition timer
-				KillTimer(m_Window, TIMER_TRANSITION);
+				GetRainmeter().KillSkinTimer(this, TIMER_TRANSITION);
 				m_ActiveTransition = false;
 			}
 		}
@@ -2908,7 +3465,7 @@ LRESULT Skin::OnTimer(UINT uMsg, WPARAM wParam, LPARAM lParam)
 		{
 			auto it = m_DelayedCommands.find(wParam);
 			if (it != m_DelayedCommands.end()) {
-				KillTimer(m_Window, wParam);
+				GetRainmeter().KillSkinTimer(this, wParam);
 				GetRainmeter().ExecuteCommand(it->second.c_str(), this, true);
 				m_DelayedCommands.erase(it);
 			}
@@ -4753,14 +5310,5 @@ std::wstring Skin::GetSkinPath()
 
 Meter* Skin::GetMeter(const std::wstring& meterName)
 {
-	const WCHAR* name = meterName.c_str();
-	std::vector<Meter*>::const_iterator j = m_Meters.begin();
-	for ( ; j != m_Meters.end(); ++j)
-	{
-		if (_wcsicmp((*j)->GetName(), name) == 0)
-		{
-			return (*j);
-		}
-	}
-	return nullptr;
+	return m_Parser.GetMeter(meterName);
 }
@@ -12,10 +12,13 @@
 #include <dwmapi.h>
 #include <string>
 #include <list>
+#include <unordered_set>
 #include "CommandHandler.h"
 #include "ConfigParser.h"
+#include "DependencyGraph.h"
 #include "Group.h"
 #include "Mouse.h"
+#include "UpdatePool.h"
 #include "../Common/Gfx/Canvas.h"
 
 #define BEGIN_MESSAGEPROC switch (uMsg) {
@@ -86,6 +89,7 @@ enum RESIZEMODE
 
 class Rainmeter;
 class Measure;
+class MeasureValueSet;
 class Meter;
 
 namespace Gfx {
@@ -106,6 +110,7 @@ public:
 
 	void DoBang(Bang bang, const std::vector<std::wstring>& args);
 	void DoDelayedCommand(const WCHAR* command, UINT delay);
+	void OnSkinTimer(UINT_PTR id) { OnTimer(WM_TIMER, id, 0); }
 
 	void HideMeter(const std::wstring& name, bool group = false);
 	void ShowMeter(const std::wstring& name, bool group = false);
@@ -121,11 +126,18 @@ public:
 	void UpdateMeasure(const std::wstring& name, bool group = false);
 	void Deactivate();
 	void Refresh(bool init, bool all = false);
-	void Redraw();
+	void Redraw(bool partial = false);
 	void RedrawWindow() { UpdateWindow(m_TransparencyValue); }
 	void SetVariable(const std::wstring& variable, const std::wstring& value);
 	void SetOption(const std::wstring& section, const std::wstring& option, const std::wstring& value, bool group);
 
+	// Between BeginBatch() and EndBatch(), !UpdateMeter and !Redraw are only recorded. When the
+	// outermost batch ends, each recorded meter is updated once and the skin is redrawn once.
+	void BeginBatch();
+	void EndBatch();
+	int GetBatchDepth() { return m_BatchDepth; }
+	void EndBatches(int depth);
+
 	void SetMouseLeaveEvent(bool cancel);
 	void SetHasMouseScrollAction() { m_HasMouseScrollAction = true; }
 
@@ -183,6 +195,7 @@ public:
 	HIDEMODE GetWindowHide() { return m_WindowHide; }
 	int GetAlphaValue() { return m_AlphaValue; }
 	int GetUpdateCounter() { return m_UpdateCounter; }
+	UINT GetMeterPass() { return m_MeterPass; }
 	int GetTransitionUpdate() { return m_TransitionUpdate; }
 	int GetDefaultUpdateDivider() { return m_DefaultUpdateDivider; }
 
@@ -279,9 +292,16 @@ private:
 	void WindowToScreen();
 	void ScreenToWindow();
 	void PostUpdate(bool bActiveTransition);
+	void FlushBatch();
+	const std::vector<Meter*>& GetMeterGroup(const std::wstring& group);
+	const std::vector<Measure*>& GetMeasureGroup(const std::wstring& group);
+	bool BeginUpdateMeasure(Measure* measure, bool force, bool& rereadOptions);
 	bool UpdateMeasure(Measure* measure, bool force);
 	bool UpdateMeter(Meter* meter, bool& bActiveTransition, bool force);
+	bool GetRedrawRect(Gdiplus::Rect& rect);
+	void DrawMeter(Meter* meter, const Gdiplus::Rect& drawRect);
 	void Update(bool refresh);
+	void BuildUpdateGraph(std::vector<std::vector<Measure*>>& references, const std::vector<bool>& tracked, bool log);
 	void UpdateWindow(int alpha, bool canvasBeginDrawCalled = false);
 	void UpdateWindowTransparency(int alpha);
 	void ReadOptions();
@@ -414,10 +434,34 @@ private:
 	std::vector<Measure*> m_Measures;
 	std::vector<Meter*> m_Meters;
 
+	GroupIndex<Meter> m_MeterGroups;
+	GroupIndex<Measure> m_MeasureGroups;
+
+	bool m_DependencyUpdate;
+	bool m_FullUpdate;
+	UINT m_VariablesVersion;
+	DependencyGraph m_UpdateGraph;					// Measures followed by meters
+	std::vector<MeasureValueSet> m_UpdateValues;	// Values of the measures in the last update
+
+	bool m_ParallelUpdate;
+	UpdatePool m_UpdatePool;
+
+	bool m_PartialRedraw;
+
+	bool m_BatchUpdate;		// Batch the bangs executed during each update
+	int m_BatchDepth;
+	bool m_BatchAllMeters;
+	bool m_BatchRedraw;
+	std::unordered_set<Meter*> m_BatchMeters;
+
+	UINT m_LayerCacheHits;
+	UINT m_LayerCacheMisses;
+
 	const std::wstring m_FolderPath;
 	const std::wstring m_FileName;
 
 	int m_UpdateCounter;
+	UINT m_MeterPass;				// Incremented for each pass that updates meters
 	UINT m_MouseMoveCounter;
 
 	Gfx::FontCollection* m_FontCollection;
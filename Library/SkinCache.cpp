@@ -0,0 +1,347 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "SkinCache.h"
+#include "ContentHash.h"
+
+namespace {
+
+const UINT32 CACHE_MAGIC = 0x43534D52;  // "RMSC"
+const UINT32 CACHE_VERSION = 1;
+
+class Writer
+{
+public:
+	Writer(std::vector<BYTE>& data) : m_Data(data) {}
+
+	void Write(const void* data, size_t size)
+	{
+		const BYTE* bytes = (const BYTE*)data;
+		m_Data.insert(m_Data.end(), bytes, bytes + size);
+	}
+
+	void WriteUInt32(UINT32 value) { Write(&value, sizeof(value)); }
+	void WriteUInt64(ULONGLONG value) { Write(&value, sizeof(value)); }
+
+	void WriteString(const std::wstring& str)
+	{
+		WriteUInt32((UINT32)str.length());
+		Write(str.c_str(), str.length() * sizeof(WCHAR));
+	}
+
+private:
+	std::vector<BYTE>& m_Data;
+};
+
+class Reader
+{
+public:
+	Reader(const BYTE* data, size_t size) : m_Pos(data), m_End(data + size) {}
+
+	bool Read(void* data, size_t size)
+	{
+		if ((size_t)(m_End - m_Pos) < size) return false;
+		memcpy(data, m_Pos, size);
+		m_Pos += size;
+		return true;
+	}
+
+	bool ReadUInt32(UINT32& value) { return Read(&value, sizeof(value)); }
+	bool ReadUInt64(ULONGLONG& value) { return Read(&value, sizeof(value)); }
+
+	bool ReadString(std::wstring& str)
+	{
+		UINT32 length;
+		if (!ReadUInt32(length) || (size_t)(m_End - m_Pos) / sizeof(WCHAR) < length) return false;
+		str.resize(length);
+		return Read(&str[0], length * sizeof(WCHAR));
+	}
+
+	bool ReadCount(UINT32& count)
+	{
+		// Every item takes at least 4 bytes so larger counts must be corrupt.
+		return ReadUInt32(count) && count <= (size_t)(m_End - m_Pos) / sizeof(UINT32);
+	}
+
+	bool IsAtEnd() const { return m_Pos == m_End; }
+
+private:
+	const BYTE* m_Pos;
+	const BYTE* m_End;
+};
+
+ULONGLONG ToULongLong(DWORD high, DWORD low)
+{
+	return ((ULONGLONG)high << 32) | low;
+}
+
+}  // namespace
+
+/*
+** Returns the path of the cache file for the given skin file in the given folder.
+**
+*/
+std::wstring SkinCache::GetCacheFile(const std::wstring& folder, const std::wstring& iniFile)
+{
+	std::wstring name = iniFile;
+	_wcsupr(&name[0]);
+
+	ContentHash hash;
+	hash.Add(name);
+
+	WCHAR buffer[32];
+	_snwprintf_s(buffer, _TRUNCATE, L"%016llX.cache", hash.Get());
+	return folder + buffer;
+}
+
+/*
+** Sets the size and write time of the file. The hash is not changed.
+**
+*/
+bool SkinCache::GetFileInfo(File& file)
+{
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesEx(file.path.c_str(), GetFileExInfoStandard, &data)) return false;
+
+	file.size = ToULongLong(data.nFileSizeHigh, data.nFileSizeLow);
+	file.writeTime = ToULongLong(data.ftLastWriteTime.dwHighDateTime, data.ftLastWriteTime.dwLowDateTime);
+	return true;
+}
+
+/*
+** Loads the snapshot from the cache file. Returns false if there is no usable snapshot. If only
+** the write times of some of the files have changed, the cache file is updated.
+**
+*/
+bool SkinCache::Load(const std::wstring& cacheFile, ULONGLONG key, Snapshot& snapshot)
+{
+	HANDLE file = CreateFile(
+		cacheFile.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	std::vector<BYTE> data;
+	LARGE_INTEGER size;
+	DWORD read = 0;
+	if (GetFileSizeEx(file, &size) && size.HighPart == 0 && size.LowPart > 0)
+	{
+		data.resize(size.LowPart);
+		if (!::ReadFile(file, &data[0], size.LowPart, &read, nullptr) || read != size.LowPart)
+		{
+			data.clear();
+		}
+	}
+
+	CloseHandle(file);
+
+	if (data.empty() || !Deserialize(&data[0], data.size(), snapshot) || snapshot.key != key)
+	{
+		return false;
+	}
+
+	bool updated = false;
+	if (!Validate(snapshot, updated)) return false;
+
+	if (updated)
+	{
+		Save(cacheFile, snapshot);
+	}
+
+	return true;
+}
+
+/*
+** Writes the snapshot to the cache file. The folder is created if needed.
+**
+*/
+bool SkinCache::Save(const std::wstring& cacheFile, const Snapshot& snapshot)
+{
+	std::vector<BYTE> data;
+	Serialize(snapshot, data);
+
+	const std::wstring::size_type pos = cacheFile.find_last_of(L'\\');
+	if (pos != std::wstring::npos)
+	{
+		CreateDirectory(cacheFile.substr(0, pos).c_str(), nullptr);
+	}
+
+	HANDLE file = CreateFile(
+		cacheFile.c_str(), GENERIC_WRITE, 0, nullptr,
+		CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	DWORD written = 0;
+	const bool result = ::WriteFile(file, &data[0], (DWORD)data.size(), &written, nullptr) && written == data.size();
+	CloseHandle(file);
+
+	if (!result)
+	{
+		// A partially written file would be rejected by Deserialize() anyway.
+		DeleteFile(cacheFile.c_str());
+	}
+
+	return result;
+}
+
+void SkinCache::Serialize(const Snapshot& snapshot, std::vector<BYTE>& data)
+{
+	data.clear();
+
+	Writer writer(data);
+	writer.WriteUInt32(CACHE_MAGIC);
+	writer.WriteUInt32(CACHE_VERSION);
+	writer.WriteUInt64(snapshot.key);
+
+	writer.WriteUInt32((UINT32)snapshot.files.size());
+	for (const auto& file : snapshot.files)
+	{
+		writer.WriteString(file.path);
+		writer.WriteUInt64(file.size);
+		writer.WriteUInt64(file.writeTime);
+		writer.WriteUInt64(file.hash);
+	}
+
+	writer.WriteUInt32((UINT32)snapshot.sections.size());
+	for (const auto& section : snapshot.sections)
+	{
+		writer.WriteString(section);
+	}
+
+	writer.WriteUInt32((UINT32)snapshot.values.size());
+	for (const auto& value : snapshot.values)
+	{
+		writer.WriteString(value.first);
+		writer.WriteString(value.second);
+	}
+
+	writer.WriteUInt32((UINT32)snapshot.variables.size());
+	for (const auto& variable : snapshot.variables)
+	{
+		writer.WriteString(variable);
+	}
+
+	// Checksum of everything above.
+	ContentHash checksum;
+	checksum.Add(&data[0], data.size());
+	writer.WriteUInt64(checksum.Get());
+}
+
+/*
+** Reads a snapshot written by Serialize(). Returns false if the data is truncated, corrupt, or
+** from another version.
+**
+*/
+bool SkinCache::Deserialize(const BYTE* data, size_t size, Snapshot& snapshot)
+{
+	if (size < sizeof(ULONGLONG)) return false;
+
+	ContentHash checksum;
+	checksum.Add(data, size - sizeof(ULONGLONG));
+	ULONGLONG expected;
+	memcpy(&expected, data + size - sizeof(ULONGLONG), sizeof(ULONGLONG));
+	if (checksum.Get() != expected) return false;
+
+	Reader reader(data, size - sizeof(ULONGLONG));
+	UINT32 magic, version, count;
+	if (!reader.ReadUInt32(magic) || magic != CACHE_MAGIC ||
+		!reader.ReadUInt32(version) || version != CACHE_VERSION ||
+		!reader.ReadUInt64(snapshot.key))
+	{
+		return false;
+	}
+
+	if (!reader.ReadCount(count)) return false;
+	snapshot.files.resize(count);
+	for (auto& file : snapshot.files)
+	{
+		if (!reader.ReadString(file.path) ||
+			!reader.ReadUInt64(file.size) ||
+			!reader.ReadUInt64(file.writeTime) ||
+			!reader.ReadUInt64(file.hash))
+		{
+			return false;
+		}
+	}
+
+	if (!reader.ReadCount(count)) return false;
+	snapshot.sections.clear();
+	for (UINT32 i = 0; i < count; ++i)
+	{
+		snapshot.sections.emplace_back();
+		if (!reader.ReadString(snapshot.sections.back())) return false;
+	}
+
+	if (!reader.ReadCount(count)) return false;
+	snapshot.values.resize(count);
+	for (auto& value : snapshot.values)
+	{
+		if (!reader.ReadString(value.first) || !reader.ReadString(value.second)) return false;
+	}
+
+	if (!reader.ReadCount(count)) return false;
+	snapshot.variables.clear();
+	for (UINT32 i = 0; i < count; ++i)
+	{
+		snapshot.variables.emplace_back();
+		if (!reader.ReadString(snapshot.variables.back())) return false;
+	}
+
+	return reader.IsAtEnd();
+}
+
+/*
+** Checks that none of the files of the snapshot have changed. If a file has a new write time but
+** the same contents, the write time in the snapshot is updated and updated is set to true.
+**
+*/
+bool SkinCache::Validate(Snapshot& snapshot, bool& updated)
+{
+	if (snapshot.files.empty()) return false;
+
+	for (auto& file : snapshot.files)
+	{
+		File current = file;
+		if (!GetFileInfo(current) || current.size != file.size) return false;
+
+		if (current.writeTime != file.writeTime)
+		{
+			if (!HashFile(file.path.c_str(), current.hash) || current.hash != file.hash) return false;
+
+			file.writeTime = current.writeTime;
+			updated = true;
+		}
+	}
+
+	return true;
+}
+
+/*
+** Computes the same hash of the file contents as IniParser::ReadFile().
+**
+*/
+bool SkinCache::HashFile(const WCHAR* path, ULONGLONG& hash)
+{
+	HANDLE file = CreateFile(
+		path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	ContentHash contentHash;
+	BYTE buffer[16384];
+	DWORD read;
+	bool result;
+	while ((result = ::ReadFile(file, buffer, sizeof(buffer), &read, nullptr) != FALSE) && read > 0)
+	{
+		contentHash.Add(buffer, read);
+	}
+
+	CloseHandle(file);
+
+	hash = contentHash.Get();
+	return result;
+}
@@ -0,0 +1,58 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#ifndef RM_LIBRARY_SKINCACHE_H_
+#define RM_LIBRARY_SKINCACHE_H_
+
+#include <Windows.h>
+#include <list>
+#include <string>
+#include <vector>
+
+// Stores the sections and values read from a skin file and its @Include files in a binary file
+// so that they can be loaded on the next refresh without parsing the files again. A snapshot is
+// only used if it was created with the same key (see ConfigParser) and if none of the files read
+// for it have changed. Files are compared by size and write time, and files that were only
+// touched are recognized by the hash of their contents.
+class SkinCache
+{
+public:
+	struct File
+	{
+		std::wstring path;
+		ULONGLONG size;
+		ULONGLONG writeTime;
+		ULONGLONG hash;
+	};
+
+	struct Snapshot
+	{
+		ULONGLONG key;
+		std::vector<File> files;
+		std::list<std::wstring> sections;
+		std::vector<std::pair<std::wstring, std::wstring>> values;
+		std::list<std::wstring> variables;
+	};
+
+	SkinCache() = delete;
+
+	static std::wstring GetCacheFile(const std::wstring& folder, const std::wstring& iniFile);
+
+	static bool GetFileInfo(File& file);
+
+	static bool Load(const std::wstring& cacheFile, ULONGLONG key, Snapshot& snapshot);
+	static bool Save(const std::wstring& cacheFile, const Snapshot& snapshot);
+
+	static void Serialize(const Snapshot& snapshot, std::vector<BYTE>& data);
+	static bool Deserialize(const BYTE* data, size_t size, Snapshot& snapshot);
+
+private:
+	static bool Validate(Snapshot& snapshot, bool& updated);
+	static bool HashFile(const WCHAR* path, ULONGLONG& hash);
+};
+
+#endif
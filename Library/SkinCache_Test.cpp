@@ -0,0 +1,76 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "SkinCache.h"
+#include "../Common/UnitTest.h"
+
+TEST_CLASS(Library_SkinCache_Test)
+{
+public:
+	SkinCache::Snapshot CreateSnapshot()
+	{
+		SkinCache::Snapshot snapshot;
+		snapshot.key = 0x123456789ABCDEF0ULL;
+		snapshot.files.push_back({ L"C:\\Skins\\A\\A.ini", 120, 130, 140 });
+		snapshot.files.push_back({ L"C:\\Skins\\A\\@Resources\\Inc.inc", 0, 1, 2 });
+		snapshot.sections.push_back(L"Rainmeter");
+		snapshot.sections.push_back(L"MeterText");
+		snapshot.values.emplace_back(L"RAINMETER~UPDATE", L"1000");
+		snapshot.values.emplace_back(L"METERTEXT~TEXT", L"");
+		snapshot.variables.push_back(L"FONT");
+		return snapshot;
+	}
+
+	TEST_METHOD(TestRoundTrip)
+	{
+		const SkinCache::Snapshot snapshot = CreateSnapshot();
+		std::vector<BYTE> data;
+		SkinCache::Serialize(snapshot, data);
+
+		SkinCache::Snapshot result;
+		Assert::IsTrue(SkinCache::Deserialize(&data[0], data.size(), result));
+		Assert::IsTrue(result.key == snapshot.key);
+		Assert::AreEqual((size_t)2, result.files.size());
+		Assert::AreEqual(L"C:\\Skins\\A\\@Resources\\Inc.inc", result.files[1].path.c_str());
+		Assert::IsTrue(result.files[0].size == 120 && result.files[0].writeTime == 130 && result.files[0].hash == 140);
+		Assert::IsTrue(result.sections == snapshot.sections);
+		Assert::IsTrue(result.values == snapshot.values);
+		Assert::IsTrue(result.variables == snapshot.variables);
+	}
+
+	TEST_METHOD(TestCorruptData)
+	{
+		std::vector<BYTE> data;
+		SkinCache::Serialize(CreateSnapshot(), data);
+
+		SkinCache::Snapshot result;
+		for (size_t size = 0; size < data.size(); ++size)
+		{
+			Assert::IsFalse(SkinCache::Deserialize(&data[0], size, result));
+		}
+
+		for (size_t i = 0; i < data.size(); ++i)
+		{
+			data[i] ^= 0x01;
+			Assert::IsFalse(SkinCache::Deserialize(&data[0], data.size(), result));
+			data[i] ^= 0x01;
+		}
+
+		Assert::IsTrue(SkinCache::Deserialize(&data[0], data.size(), result));
+	}
+
+	TEST_METHOD(TestGetCacheFile)
+	{
+		const std::wstring file1 = SkinCache::GetCacheFile(L"C:\\Cache\\", L"C:\\Skins\\A\\A.ini");
+		const std::wstring file2 = SkinCache::GetCacheFile(L"C:\\Cache\\", L"c:\\skins\\a\\a.INI");
+		const std::wstring file3 = SkinCache::GetCacheFile(L"C:\\Cache\\", L"C:\\Skins\\A\\B.ini");
+		Assert::AreEqual(file1.c_str(), file2.c_str());
+		Assert::IsTrue(file1 != file3);
+		Assert::IsTrue(file1.compare(0, 9, L"C:\\Cache\\") == 0);
+	}
+};
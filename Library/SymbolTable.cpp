@@ -0,0 +1,174 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "SymbolTable.h"
+
+namespace {
+
+const size_t INITIAL_SIZE = 64;
+
+inline WCHAR FoldCase(WCHAR ch)
+{
+	return (ch < 0x80) ? ((ch >= L'a' && ch <= L'z') ? (WCHAR)(ch - (L'a' - L'A')) : ch) : towupper(ch);
+}
+
+}  // namespace
+
+SymbolTable::SymbolTable() :
+	m_Count()
+{
+}
+
+SymbolTable::~SymbolTable()
+{
+}
+
+void SymbolTable::Clear()
+{
+	m_Symbols.clear();
+	m_Count = 0;
+}
+
+/*
+** Adds a measure. If a measure with the same name already exists, the existing measure is kept.
+**
+*/
+void SymbolTable::AddMeasure(const std::wstring& name, Measure* measure)
+{
+	Symbol& symbol = Insert(name);
+	if (!symbol.measure)
+	{
+		symbol.measure = measure;
+	}
+}
+
+/*
+** Adds a meter. If a meter with the same name already exists, the existing meter is kept.
+**
+*/
+void SymbolTable::AddMeter(const std::wstring& name, Meter* meter)
+{
+	Symbol& symbol = Insert(name);
+	if (!symbol.meter)
+	{
+		symbol.meter = meter;
+	}
+}
+
+Measure* SymbolTable::GetMeasure(const WCHAR* name, size_t length) const
+{
+	const Symbol* symbol = Find(name, length);
+	return symbol ? symbol->measure : nullptr;
+}
+
+Meter* SymbolTable::GetMeter(const WCHAR* name, size_t length) const
+{
+	const Symbol* symbol = Find(name, length);
+	return symbol ? symbol->meter : nullptr;
+}
+
+/*
+** FNV-1a hash of the case folded name.
+**
+*/
+size_t SymbolTable::Hash(const WCHAR* name, size_t length)
+{
+	uint32_t hash = 2166136261U;
+	for (size_t i = 0; i < length; ++i)
+	{
+		hash ^= (uint32_t)FoldCase(name[i]);
+		hash *= 16777619U;
+	}
+	return (size_t)hash;
+}
+
+SymbolTable::Symbol& SymbolTable::Insert(const std::wstring& name)
+{
+	// Keep the load factor below 1/2.
+	if ((m_Count + 1) * 2 > m_Symbols.size())
+	{
+		Grow();
+	}
+
+	const size_t hash = Hash(name.c_str(), name.length());
+	const size_t mask = m_Symbols.size() - 1;
+	for (size_t i = hash & mask; ; i = (i + 1) & mask)
+	{
+		Symbol& symbol = m_Symbols[i];
+		if (!symbol.name)
+		{
+			symbol.hash = hash;
+			symbol.name = name.c_str();
+			symbol.length = name.length();
+			++m_Count;
+			return symbol;
+		}
+		else if (IsEqual(symbol, name.c_str(), name.length(), hash))
+		{
+			return symbol;
+		}
+	}
+}
+
+const SymbolTable::Symbol* SymbolTable::Find(const WCHAR* name, size_t length) const
+{
+	if (m_Count == 0)
+	{
+		return nullptr;
+	}
+
+	const size_t hash = Hash(name, length);
+	const size_t mask = m_Symbols.size() - 1;
+	for (size_t i = hash & mask; m_Symbols[i].name; i = (i + 1) & mask)
+	{
+		if (IsEqual(m_Symbols[i], name, length, hash))
+		{
+			return &m_Symbols[i];
+		}
+	}
+
+	return nullptr;
+}
+
+void SymbolTable::Grow()
+{
+	std::vector<Symbol> symbols(m_Symbols.empty() ? INITIAL_SIZE : m_Symbols.size() * 2, Symbol());
+	symbols.swap(m_Symbols);
+
+	const size_t mask = m_Symbols.size() - 1;
+	for (const auto& symbol : symbols)
+	{
+		if (symbol.name)
+		{
+			size_t i = symbol.hash & mask;
+			while (m_Symbols[i].name)
+			{
+				i = (i + 1) & mask;
+			}
+			m_Symbols[i] = symbol;
+		}
+	}
+}
+
+bool SymbolTable::IsEqual(const Symbol& symbol, const WCHAR* name, size_t length, size_t hash)
+{
+	if (symbol.hash != hash || symbol.length != length)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < length; ++i)
+	{
+		if (FoldCase(symbol.name[i]) != FoldCase(name[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
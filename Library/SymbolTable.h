@@ -0,0 +1,63 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#ifndef RM_LIBRARY_SYMBOLTABLE_H_
+#define RM_LIBRARY_SYMBOLTABLE_H_
+
+#include <Windows.h>
+#include <string>
+#include <vector>
+
+class Measure;
+class Meter;
+
+// Case-insensitive index of the measure and meter names of a skin. The names are not copied: each
+// symbol points to the name owned by its section. Lookups take a pointer and a length so that e.g.
+// names within formulas and section variables can be resolved without allocating.
+class SymbolTable
+{
+public:
+	SymbolTable();
+	~SymbolTable();
+
+	SymbolTable(const SymbolTable& other) = delete;
+	SymbolTable& operator=(SymbolTable other) = delete;
+
+	void Clear();
+
+	void AddMeasure(const std::wstring& name, Measure* measure);
+	void AddMeter(const std::wstring& name, Meter* meter);
+
+	Measure* GetMeasure(const WCHAR* name, size_t length) const;
+	Meter* GetMeter(const WCHAR* name, size_t length) const;
+
+	size_t GetCount() const { return m_Count; }
+
+	static size_t Hash(const WCHAR* name, size_t length);
+
+private:
+	struct Symbol
+	{
+		size_t hash;
+		const WCHAR* name;
+		size_t length;
+		Measure* measure;
+		Meter* meter;
+	};
+
+	Symbol& Insert(const std::wstring& name);
+	const Symbol* Find(const WCHAR* name, size_t length) const;
+	void Grow();
+
+	static bool IsEqual(const Symbol& symbol, const WCHAR* name, size_t length, size_t hash);
+
+	// Open addressing with linear probing. The size is always zero or a power of two.
+	std::vector<Symbol> m_Symbols;
+	size_t m_Count;
+};
+
+#endif
@@ -0,0 +1,78 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "SymbolTable.h"
+#include "../Common/UnitTest.h"
+
+TEST_CLASS(Library_SymbolTable_Test)
+{
+public:
+	TEST_METHOD(TestLookup)
+	{
+		// The table only stores the pointers so dummy values can be used here.
+		Measure* const measureA = (Measure*)0x10;
+		Measure* const measureB = (Measure*)0x20;
+		Meter* const meterC = (Meter*)0x30;
+
+		const std::wstring nameA = L"MeasureA";
+		const std::wstring nameB = L"measureB";
+		const std::wstring nameC = L"MeterC";
+
+		SymbolTable table;
+		Assert::IsNull(table.GetMeasure(L"MeasureA", 8));
+
+		table.AddMeasure(nameA, measureA);
+		table.AddMeasure(nameB, measureB);
+		table.AddMeter(nameC, meterC);
+		Assert::AreEqual((size_t)3, table.GetCount());
+
+		Assert::IsTrue(table.GetMeasure(L"MEASUREA", 8) == measureA);
+		Assert::IsTrue(table.GetMeasure(L"measurea", 8) == measureA);
+		Assert::IsTrue(table.GetMeasure(L"MeasureB", 8) == measureB);
+		Assert::IsNull(table.GetMeter(L"MeasureB", 8));
+		Assert::IsTrue(table.GetMeter(L"meterc", 6) == meterC);
+		Assert::IsNull(table.GetMeasure(L"meterc", 6));
+
+		// Only the given length is used, e.g. for names within formulas.
+		Assert::IsTrue(table.GetMeasure(L"MeasureA+MeasureB", 8) == measureA);
+		Assert::IsNull(table.GetMeasure(L"MeasureA", 7));
+
+		// The first section with a given name is kept.
+		table.AddMeasure(L"MEASUREA", measureB);
+		table.AddMeter(L"meterc", (Meter*)0x40);
+		Assert::AreEqual((size_t)3, table.GetCount());
+		Assert::IsTrue(table.GetMeasure(L"MeasureA", 8) == measureA);
+		Assert::IsTrue(table.GetMeter(L"MeterC", 6) == meterC);
+
+		table.Clear();
+		Assert::AreEqual((size_t)0, table.GetCount());
+		Assert::IsNull(table.GetMeasure(L"MeasureA", 8));
+	}
+
+	TEST_METHOD(TestGrow)
+	{
+		std::vector<std::wstring> names;
+		for (int i = 0; i < 1000; ++i)
+		{
+			names.push_back(L"Section" + std::to_wstring(i));
+		}
+
+		SymbolTable table;
+		for (size_t i = 0; i < names.size(); ++i)
+		{
+			table.AddMeasure(names[i], (Measure*)(i + 1));
+		}
+
+		Assert::AreEqual(names.size(), table.GetCount());
+		for (size_t i = 0; i < names.size(); ++i)
+		{
+			std::wstring name = L"SECTION" + std::to_wstring(i);
+			Assert::IsTrue(table.GetMeasure(name.c_str(), name.length()) == (Measure*)(i + 1));
+		}
+	}
+};
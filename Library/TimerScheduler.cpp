@@ -0,0 +1,313 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "TimerScheduler.h"
+
+namespace {
+
+// Level 0 has one slot per millisecond. Each of the upper levels has 64 slots that each span a
+// full round of the level below. Timers further away than the top level can hold are parked in
+// the last reachable slot and cascaded again when their turn comes.
+const int LEVEL0_BITS = 8;
+const int LEVEL_BITS = 6;
+const int LEVEL_COUNT = 4;
+const ULONGLONG LEVEL0_MASK = (1 << LEVEL0_BITS) - 1;
+const ULONGLONG LEVEL_MASK = (1 << LEVEL_BITS) - 1;
+const ULONGLONG MAX_DELTA = (1ULL << (LEVEL0_BITS + LEVEL_COUNT * LEVEL_BITS)) - 1;
+
+int GetLevelShift(int level)
+{
+	return LEVEL0_BITS + level * LEVEL_BITS;
+}
+
+}  // namespace
+
+TimerScheduler::TimerScheduler(TimerProc proc) :
+	m_Level0(),
+	m_Levels(),
+	m_Level0Count(),
+	m_Time(),
+	m_Serial(),
+	m_Proc(proc)
+{
+}
+
+TimerScheduler::~TimerScheduler()
+{
+	for (const auto& item : m_Timers)
+	{
+		delete item.second;
+	}
+}
+
+/*
+** Creates or resets the timer. The timer first expires after elapse milliseconds from now.
+**
+*/
+void TimerScheduler::SetTimer(void* owner, UINT_PTR id, UINT elapse, ULONGLONG now)
+{
+	if (m_Timers.empty() && now > m_Time)
+	{
+		// Nothing can expire in between so skip the idle period.
+		m_Time = now;
+	}
+
+	const Key key(owner, id);
+	Timer*& timer = m_Timers[key];
+	if (timer)
+	{
+		Remove(timer);
+	}
+	else
+	{
+		timer = new Timer();
+		timer->key = key;
+	}
+
+	timer->elapse = max(1U, elapse);
+	timer->serial = ++m_Serial;
+	timer->dueTime = max(now + timer->elapse, m_Time + 1);
+	Insert(timer);
+}
+
+void TimerScheduler::KillTimer(void* owner, UINT_PTR id)
+{
+	auto iter = m_Timers.find(Key(owner, id));
+	if (iter != m_Timers.end())
+	{
+		Remove(iter->second);
+		delete iter->second;
+		m_Timers.erase(iter);
+	}
+}
+
+/*
+** Kills all timers of the owner.
+**
+*/
+void TimerScheduler::KillTimers(void* owner)
+{
+	auto iter = m_Timers.lower_bound(Key(owner, 0));
+	while (iter != m_Timers.end() && iter->first.first == owner)
+	{
+		Remove(iter->second);
+		delete iter->second;
+		iter = m_Timers.erase(iter);
+	}
+}
+
+bool TimerScheduler::HasTimer(void* owner, UINT_PTR id) const
+{
+	return m_Timers.find(Key(owner, id)) != m_Timers.end();
+}
+
+/*
+** Expires all timers that are due at or before now + slack and calls the timer procedure for
+** each of them. The slack allows timers that are due shortly to be handled in the same batch
+** instead of waking up again for each one.
+**
+*/
+void TimerScheduler::Run(ULONGLONG now, UINT slack)
+{
+	std::vector<Expiry> expired;
+	Advance(now + slack, expired);
+
+	// Dispatch in the order the timers were due and, for equal due times, created.
+	std::sort(expired.begin(), expired.end(), [](const Expiry& lhs, const Expiry& rhs)
+	{
+		return lhs.dueTime < rhs.dueTime || (lhs.dueTime == rhs.dueTime && lhs.serial < rhs.serial);
+	});
+
+	for (const auto& item : expired)
+	{
+		// Earlier callbacks may have killed or reset the timer (or even deleted its owner).
+		auto iter = m_Timers.find(item.key);
+		if (iter != m_Timers.end() && iter->second->serial == item.serial)
+		{
+			m_Proc(item.key.first, item.key.second);
+		}
+	}
+}
+
+/*
+** Returns the time when the next timer is due. Returns false if there are no timers.
+**
+*/
+bool TimerScheduler::GetNextDueTime(ULONGLONG* dueTime) const
+{
+	if (m_Timers.empty()) return false;
+
+	ULONGLONG result = GetFirstDueTime(m_Level0, _countof(m_Level0), (size_t)((m_Time + 1) & LEVEL0_MASK));
+	for (int level = 0; level < LEVEL_COUNT; ++level)
+	{
+		const size_t start = (size_t)(((m_Time >> GetLevelShift(level)) + 1) & LEVEL_MASK);
+		result = min(result, GetFirstDueTime(m_Levels[level], _countof(m_Levels[level]), start));
+	}
+
+	*dueTime = result;
+	return true;
+}
+
+/*
+** Returns the earliest due time in the first non-empty slot starting from start.
+**
+*/
+ULONGLONG TimerScheduler::GetFirstDueTime(Timer* const* slots, size_t count, size_t start)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		Timer* timer = slots[(start + i) % count];
+		if (timer)
+		{
+			ULONGLONG dueTime = timer->dueTime;
+			for (timer = timer->next; timer; timer = timer->next)
+			{
+				dueTime = min(dueTime, timer->dueTime);
+			}
+			return dueTime;
+		}
+	}
+
+	return ULLONG_MAX;
+}
+
+void TimerScheduler::Insert(Timer* timer)
+{
+	ULONGLONG dueTime = timer->dueTime;
+	ULONGLONG delta = (dueTime > m_Time) ? dueTime - m_Time : 0;
+	if (delta > MAX_DELTA)
+	{
+		delta = MAX_DELTA;
+		dueTime = m_Time + MAX_DELTA;
+	}
+
+	Timer** slot;
+	if (delta <= LEVEL0_MASK)
+	{
+		slot = &m_Level0[dueTime & LEVEL0_MASK];
+		++m_Level0Count;
+	}
+	else
+	{
+		int level = 0;
+		while (delta >> GetLevelShift(level + 1))
+		{
+			++level;
+		}
+		slot = &m_Levels[level][(dueTime >> GetLevelShift(level)) & LEVEL_MASK];
+	}
+
+	timer->prev = nullptr;
+	timer->next = *slot;
+	if (*slot)
+	{
+		(*slot)->prev = timer;
+	}
+	*slot = timer;
+	timer->slot = slot;
+}
+
+void TimerScheduler::Remove(Timer* timer)
+{
+	if (timer->prev)
+	{
+		timer->prev->next = timer->next;
+	}
+	else
+	{
+		*timer->slot = timer->next;
+	}
+
+	if (timer->next)
+	{
+		timer->next->prev = timer->prev;
+	}
+
+	if (timer->slot >= m_Level0 && timer->slot < m_Level0 + _countof(m_Level0))
+	{
+		--m_Level0Count;
+	}
+}
+
+/*
+** Moves the timers in the current slot of the level to the lower levels.
+**
+*/
+void TimerScheduler::Cascade(int level)
+{
+	Timer** slot = &m_Levels[level][(m_Time >> GetLevelShift(level)) & LEVEL_MASK];
+	Timer* timer = *slot;
+	*slot = nullptr;
+
+	while (timer)
+	{
+		Timer* next = timer->next;
+		Insert(timer);
+		timer = next;
+	}
+}
+
+/*
+** Advances the wheel up to the given time and collects the timers that expired on the way.
+** Expired timers are rescheduled to their next due time after the given time.
+**
+*/
+void TimerScheduler::Advance(ULONGLONG time, std::vector<Expiry>& expired)
+{
+	if (m_Timers.empty())
+	{
+		m_Time = max(m_Time, time);
+		return;
+	}
+
+	while (m_Time < time)
+	{
+		if (m_Level0Count == 0 && (m_Time & LEVEL0_MASK) != LEVEL0_MASK)
+		{
+			// Nothing can expire before the next cascade.
+			m_Time = min(m_Time | LEVEL0_MASK, time);
+			continue;
+		}
+
+		++m_Time;
+
+		if ((m_Time & LEVEL0_MASK) == 0)
+		{
+			for (int level = 0; level < LEVEL_COUNT; ++level)
+			{
+				Cascade(level);
+				if ((m_Time >> GetLevelShift(level)) & LEVEL_MASK) break;
+			}
+		}
+
+		Timer** slot = &m_Level0[m_Time & LEVEL0_MASK];
+		Timer* timer = *slot;
+		*slot = nullptr;
+
+		while (timer)
+		{
+			Timer* next = timer->next;
+			--m_Level0Count;
+
+			if (timer->dueTime <= m_Time)
+			{
+				expired.push_back({ timer->key, timer->serial, timer->dueTime });
+
+				// Like Win32 timers, missed periods are coalesced into a single expiry.
+				timer->dueTime += timer->elapse;
+				if (timer->dueTime <= time)
+				{
+					timer->dueTime += ((time - timer->dueTime) / timer->elapse + 1) * timer->elapse;
+				}
+			}
+
+			Insert(timer);
+			timer = next;
+		}
+	}
+}
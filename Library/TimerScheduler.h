@@ -0,0 +1,83 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#ifndef RM_LIBRARY_TIMERSCHEDULER_H_
+#define RM_LIBRARY_TIMERSCHEDULER_H_
+
+#include <Windows.h>
+#include <map>
+#include <vector>
+
+// Process-wide replacement for the per-window SetTimer()/KillTimer() timers. The timers work like
+// the Win32 ones: they are identified by an owner and an ID, they repeat until killed, and a
+// timer that is due several times before Run() is called expires only once.
+//
+// The timers are kept in a hierarchical timer wheel with a resolution of 1 ms. The scheduler does
+// not read the clock itself: the current time is passed to SetTimer() and Run() so that it can be
+// driven by a single window timer (or by a test).
+class TimerScheduler
+{
+public:
+	typedef void (*TimerProc)(void* owner, UINT_PTR id);
+
+	TimerScheduler(TimerProc proc);
+	~TimerScheduler();
+
+	TimerScheduler(const TimerScheduler& other) = delete;
+	TimerScheduler& operator=(TimerScheduler other) = delete;
+
+	void SetTimer(void* owner, UINT_PTR id, UINT elapse, ULONGLONG now);
+	void KillTimer(void* owner, UINT_PTR id);
+	void KillTimers(void* owner);
+	bool HasTimer(void* owner, UINT_PTR id) const;
+
+	void Run(ULONGLONG now, UINT slack);
+	bool GetNextDueTime(ULONGLONG* dueTime) const;
+
+	size_t GetCount() const { return m_Timers.size(); }
+
+private:
+	typedef std::pair<void*, UINT_PTR> Key;
+
+	struct Timer
+	{
+		Key key;
+		ULONGLONG dueTime;
+		UINT elapse;
+		UINT serial;
+		Timer* prev;
+		Timer* next;
+		Timer** slot;
+	};
+
+	struct Expiry
+	{
+		Key key;
+		UINT serial;
+		ULONGLONG dueTime;
+	};
+
+	void Insert(Timer* timer);
+	void Remove(Timer* timer);
+	void Cascade(int level);
+	void Advance(ULONGLONG time, std::vector<Expiry>& expired);
+
+	static ULONGLONG GetFirstDueTime(Timer* const* slots, size_t count, size_t start);
+
+	std::map<Key, Timer*> m_Timers;
+
+	Timer* m_Level0[256];
+	Timer* m_Levels[4][64];
+	size_t m_Level0Count;
+
+	ULONGLONG m_Time;	// All timers due at or before this have expired
+	UINT m_Serial;
+
+	TimerProc m_Proc;
+};
+
+#endif
@@ -0,0 +1,141 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "TimerScheduler.h"
+#include "../Common/UnitTest.h"
+
+namespace {
+
+struct Fired
+{
+	void* owner;
+	UINT_PTR id;
+};
+
+std::vector<Fired> g_Fired;
+TimerScheduler* g_Scheduler = nullptr;
+
+void RecordTimer(void* owner, UINT_PTR id)
+{
+	g_Fired.push_back({ owner, id });
+}
+
+void KillingTimer(void* owner, UINT_PTR id)
+{
+	g_Fired.push_back({ owner, id });
+	g_Scheduler->KillTimers(owner == (void*)1 ? (void*)2 : (void*)1);
+}
+
+}  // namespace
+
+TEST_CLASS(Library_TimerScheduler_Test)
+{
+public:
+	TEST_METHOD(TestPeriodic)
+	{
+		TimerScheduler scheduler(RecordTimer);
+		g_Fired.clear();
+		scheduler.SetTimer((void*)1, 1, 100, 1000);
+
+		ULONGLONG dueTime = 0;
+		Assert::IsTrue(scheduler.GetNextDueTime(&dueTime));
+		Assert::AreEqual(1100ULL, dueTime);
+
+		scheduler.Run(1099, 0);
+		Assert::AreEqual((size_t)0, g_Fired.size());
+
+		scheduler.Run(1100, 0);
+		Assert::AreEqual((size_t)1, g_Fired.size());
+		Assert::IsTrue(scheduler.GetNextDueTime(&dueTime));
+		Assert::AreEqual(1200ULL, dueTime);
+
+		// Missed periods expire only once.
+		scheduler.Run(1550, 0);
+		Assert::AreEqual((size_t)2, g_Fired.size());
+		Assert::IsTrue(scheduler.GetNextDueTime(&dueTime));
+		Assert::AreEqual(1600ULL, dueTime);
+
+		scheduler.KillTimer((void*)1, 1);
+		Assert::IsFalse(scheduler.GetNextDueTime(&dueTime));
+		scheduler.Run(5000, 0);
+		Assert::AreEqual((size_t)2, g_Fired.size());
+	}
+
+	TEST_METHOD(TestReset)
+	{
+		TimerScheduler scheduler(RecordTimer);
+		g_Fired.clear();
+		scheduler.SetTimer((void*)1, 1, 100, 0);
+		scheduler.SetTimer((void*)1, 1, 300, 50);
+		Assert::AreEqual((size_t)1, scheduler.GetCount());
+
+		scheduler.Run(200, 0);
+		Assert::AreEqual((size_t)0, g_Fired.size());
+
+		scheduler.Run(350, 0);
+		Assert::AreEqual((size_t)1, g_Fired.size());
+	}
+
+	TEST_METHOD(TestSlack)
+	{
+		TimerScheduler scheduler(RecordTimer);
+		g_Fired.clear();
+		scheduler.SetTimer((void*)1, 1, 1000, 0);
+		scheduler.SetTimer((void*)2, 1, 1005, 0);
+		scheduler.SetTimer((void*)3, 1, 1020, 0);
+
+		// Timers within the slack are handled in the same batch.
+		scheduler.Run(1000, 10);
+		Assert::AreEqual((size_t)2, g_Fired.size());
+		Assert::IsTrue(g_Fired[0].owner == (void*)1);
+		Assert::IsTrue(g_Fired[1].owner == (void*)2);
+
+		ULONGLONG dueTime = 0;
+		Assert::IsTrue(scheduler.GetNextDueTime(&dueTime));
+		Assert::AreEqual(1020ULL, dueTime);
+	}
+
+	TEST_METHOD(TestLongDelay)
+	{
+		TimerScheduler scheduler(RecordTimer);
+		g_Fired.clear();
+		scheduler.SetTimer((void*)1, 1, 3600000, 0);
+		scheduler.SetTimer((void*)1, 2, 70000, 0);
+		scheduler.SetTimer((void*)1, 3, 4000000000, 0);
+
+		ULONGLONG dueTime = 0;
+		Assert::IsTrue(scheduler.GetNextDueTime(&dueTime));
+		Assert::AreEqual(70000ULL, dueTime);
+
+		for (ULONGLONG now = 0; now < 3600000; now += 997)
+		{
+			scheduler.Run(now, 0);
+		}
+		Assert::AreEqual((size_t)51, g_Fired.size());
+
+		scheduler.Run(3600000, 0);
+		Assert::AreEqual((size_t)52, g_Fired.size());
+		Assert::IsTrue(g_Fired.back().id == 1);
+	}
+
+	TEST_METHOD(TestKillDuringRun)
+	{
+		TimerScheduler scheduler(KillingTimer);
+		g_Fired.clear();
+		g_Scheduler = &scheduler;
+		scheduler.SetTimer((void*)1, 1, 10, 0);
+		scheduler.SetTimer((void*)2, 1, 10, 0);
+		scheduler.SetTimer((void*)2, 2, 10, 0);
+
+		scheduler.Run(10, 0);
+		Assert::AreEqual((size_t)1, g_Fired.size());
+		Assert::AreEqual((size_t)1, scheduler.GetCount());
+		Assert::IsFalse(scheduler.HasTimer((void*)2, 1));
+		g_Scheduler = nullptr;
+	}
+};
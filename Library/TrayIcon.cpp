@@ -46,12 +46,11 @@ TrayIcon::TrayIcon() :
 	m_Color1(0, 100, 0),
 	m_Color2(0, 255, 0),
 	m_Bitmap(),
-	m_Values(),
-	m_Pos(),
 	m_Notification(TRAY_NOTIFICATION_NONE),
 	m_TrayContextMenuEnabled(true),
 	m_IconEnabled(true)
 {
+	m_History.Reserve(TRAYICON_SIZE);
 }
 
 TrayIcon::~TrayIcon()
@@ -196,8 +195,7 @@ HICON TrayIcon::CreateTrayIcon(double value)
 	{
 		if (m_MeterType == TRAY_METER_TYPE_HISTOGRAM)
 		{
-			m_Values[m_Pos] = value;
-			m_Pos = (m_Pos + 1) % TRAYICON_SIZE;
+			m_History.Push(value);
 
 			Bitmap trayBitmap(TRAYICON_SIZE, TRAYICON_SIZE);
 			Graphics graphics(&trayBitmap);
@@ -212,7 +210,7 @@ HICON TrayIcon::CreateTrayIcon(double value)
 			for (int i = 0; i < TRAYICON_SIZE; ++i)
 			{
 				points[i + 1].X = i;
-				points[i + 1].Y = (int)(TRAYICON_SIZE * (1.0 - m_Values[(m_Pos + i) % TRAYICON_SIZE]));
+				points[i + 1].Y = (int)(TRAYICON_SIZE * (1.0 - m_History.Get(TRAYICON_SIZE - 1 - i)));
 			}
 
 			SolidBrush brush(m_Color1);
@@ -12,6 +12,7 @@
 #include <ole2.h>  // For Gdiplus.h.
 #include <gdiplus.h>
 #include <vector>
+#include "MeasureHistory.h"
 
 #define WM_TRAY_NOTIFYICON WM_USER + 101
 #define TRAYICON_SIZE 16
@@ -77,8 +78,7 @@ private:
 
 	std::vector<HICON> m_Icons;
 
-	double m_Values[TRAYICON_SIZE];
-	int m_Pos;
+	MeasureHistory m_History;		// Relative values of the measure
 
 	TRAY_NOTIFICATION m_Notification;
 
@@ -0,0 +1,106 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "UpdatePool.h"
+#include "Measure.h"
+
+UINT UpdatePool::c_WorkerCount = 0;
+
+UpdatePool::UpdatePool() :
+	m_Work(),
+	m_Measures(),
+	m_Next(),
+	m_PendingWorkers(),
+	m_WorkersDone(CreateEvent(nullptr, TRUE, FALSE, nullptr))
+{
+}
+
+UpdatePool::~UpdatePool()
+{
+	if (m_Work)
+	{
+		WaitForThreadpoolWorkCallbacks(m_Work, TRUE);
+		CloseThreadpoolWork(m_Work);
+	}
+
+	CloseHandle(m_WorkersDone);
+}
+
+/*
+** Calls CalculateValue() of the given measures and waits until all of them are done.
+**
+*/
+void UpdatePool::Run(const std::vector<Measure*>& measures)
+{
+	if (c_WorkerCount == 0)
+	{
+		SYSTEM_INFO systemInfo;
+		GetSystemInfo(&systemInfo);
+		c_WorkerCount = max(1UL, systemInfo.dwNumberOfProcessors) - 1;
+	}
+
+	m_Measures = &measures;
+	m_Next = 0;
+
+	if (!m_Work && measures.size() > 1 && c_WorkerCount > 0)
+	{
+		m_Work = CreateThreadpoolWork(WorkCallback, this, nullptr);
+	}
+
+	// The calling thread handles one of the measures so no more workers than that are needed.
+	UINT workers = 0;
+	if (m_Work)
+	{
+		workers = (UINT)min((size_t)c_WorkerCount, measures.size() - 1);
+		m_PendingWorkers = (LONG)workers;
+		ResetEvent(m_WorkersDone);
+		for (UINT i = 0; i < workers; ++i)
+		{
+			SubmitThreadpoolWork(m_Work);
+		}
+	}
+
+	CalculateValues();
+
+	if (workers > 0)
+	{
+		// A measure may log on a worker, which sends messages to the log window of this thread.
+		while (MsgWaitForMultipleObjects(1, &m_WorkersDone, FALSE, INFINITE, QS_SENDMESSAGE) == WAIT_OBJECT_0 + 1)
+		{
+			// Dispatches the messages sent by other threads.
+			MSG msg;
+			PeekMessage(&msg, nullptr, 0, 0, PM_NOREMOVE);
+		}
+
+		WaitForThreadpoolWorkCallbacks(m_Work, FALSE);
+	}
+
+	m_Measures = nullptr;
+}
+
+VOID CALLBACK UpdatePool::WorkCallback(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_WORK work)
+{
+	UpdatePool* pool = (UpdatePool*)context;
+	pool->CalculateValues();
+
+	if (InterlockedDecrement(&pool->m_PendingWorkers) == 0)
+	{
+		SetEvent(pool->m_WorkersDone);
+	}
+}
+
+void UpdatePool::CalculateValues()
+{
+	const LONG count = (LONG)m_Measures->size();
+
+	LONG i;
+	while ((i = InterlockedIncrement(&m_Next) - 1) < count)
+	{
+		(*m_Measures)[i]->CalculateValue();
+	}
+}
@@ -0,0 +1,46 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#ifndef RM_LIBRARY_UPDATEPOOL_H_
+#define RM_LIBRARY_UPDATEPOOL_H_
+
+#include <Windows.h>
+#include <vector>
+
+class Measure;
+
+// Calculates the values of thread-safe measures concurrently on the system thread pool. The
+// measures are taken one at a time from a shared index so that a slow measure does not hold up
+// the others. The calling thread takes part as well and Run() returns only after all the measures
+// have been calculated. Sent messages are processed while waiting so that a measure may log
+// while the calling thread waits for it.
+class UpdatePool
+{
+public:
+	UpdatePool();
+	~UpdatePool();
+
+	UpdatePool(const UpdatePool& other) = delete;
+	UpdatePool& operator=(UpdatePool other) = delete;
+
+	void Run(const std::vector<Measure*>& measures);
+
+private:
+	static VOID CALLBACK WorkCallback(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_WORK work);
+
+	void CalculateValues();
+
+	PTP_WORK m_Work;
+	const std::vector<Measure*>* m_Measures;
+	volatile LONG m_Next;
+	volatile LONG m_PendingWorkers;
+	HANDLE m_WorkersDone;
+
+	static UINT c_WorkerCount;
+};
+
+#endif
@@ -0,0 +1,517 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "WebFetcher.h"
+#include "zlib.h"
+
+namespace {
+
+// Sends the requests with WinINet. The WinINet cache is bypassed so that the conditional requests
+// made by WebFetcher reach the server and 304 responses are returned as is.
+class WinInetTransport : public WebFetcher::Transport
+{
+public:
+	bool Get(HINTERNET handle, const std::wstring& url, const std::wstring& headers, size_t maxSize, WebFetcher::Response& response) override
+	{
+		// WinINet does not decode compressed responses, so they are requested only if the decoder
+		// is going to handle them. The Header options of the measure take precedence.
+		std::wstring requestHeaders;
+		if (!HasHeader(headers, L"Accept-Encoding"))
+		{
+			requestHeaders = L"Accept-Encoding: gzip, deflate\r\n";
+		}
+		requestHeaders += headers;
+
+		const DWORD flags = INTERNET_FLAG_RELOAD | INTERNET_FLAG_NO_CACHE_WRITE;
+		HINTERNET request = InternetOpenUrl(handle, url.c_str(), requestHeaders.c_str(), -1L, flags, 0);
+		if (!request)
+		{
+			return false;
+		}
+
+		DWORD status = 0;
+		DWORD size = sizeof(status);
+		if (HttpQueryInfo(request, HTTP_QUERY_STATUS_CODE | HTTP_QUERY_FLAG_NUMBER, &status, &size, nullptr))
+		{
+			response.status = status;
+		}
+
+		response.etag = QueryHeader(request, HTTP_QUERY_ETAG);
+		response.lastModified = QueryHeader(request, HTTP_QUERY_LAST_MODIFIED);
+
+		DWORD contentLength = 0;
+		size = sizeof(contentLength);
+		HttpQueryInfo(request, HTTP_QUERY_CONTENT_LENGTH | HTTP_QUERY_FLAG_NUMBER, &contentLength, &size, nullptr);
+
+		WebFetcher::Decoder decoder(response.data, maxSize);
+		bool received = decoder.Begin(QueryHeader(request, HTTP_QUERY_CONTENT_ENCODING), contentLength);
+
+		// Each chunk is decoded as soon as it arrives so the compressed body is never stored.
+		BYTE buffer[8192];
+		while (received)
+		{
+			DWORD readSize;
+			if (!InternetReadFile(request, buffer, sizeof(buffer), &readSize))
+			{
+				received = false;
+			}
+			else if (readSize == 0)
+			{
+				// All data read.
+				received = decoder.End();
+				break;
+			}
+			else
+			{
+				received = decoder.Write(buffer, readSize);
+			}
+		}
+
+		InternetCloseHandle(request);
+		return received;
+	}
+
+private:
+	static bool HasHeader(const std::wstring& headers, const WCHAR* name)
+	{
+		const size_t length = wcslen(name);
+		for (size_t pos = 0; pos < headers.length(); )
+		{
+			if (_wcsnicmp(headers.c_str() + pos, name, length) == 0 && headers[pos + length] == L':')
+			{
+				return true;
+			}
+
+			pos = headers.find(L"\r\n", pos);
+			if (pos == std::wstring::npos) break;
+			pos += 2;
+		}
+
+		return false;
+	}
+
+	static std::wstring QueryHeader(HINTERNET request, DWORD info)
+	{
+		WCHAR buffer[256];
+		DWORD size = sizeof(buffer);
+		if (HttpQueryInfo(request, info, buffer, &size, nullptr))
+		{
+			return std::wstring(buffer, size / sizeof(WCHAR));
+		}
+
+		return std::wstring();
+	}
+};
+
+bool IsThreadAlive(DWORD threadId)
+{
+	HANDLE thread = OpenThread(SYNCHRONIZE, FALSE, threadId);
+	if (!thread)
+	{
+		return false;
+	}
+
+	const bool alive = WaitForSingleObject(thread, 0) == WAIT_TIMEOUT;
+	CloseHandle(thread);
+	return alive;
+}
+
+}  // namespace
+
+WebFetcher& GetWebFetcher()
+{
+	static WebFetcher s_WebFetcher;
+	return s_WebFetcher;
+}
+
+WebFetcher::WebFetcher(Transport* transport) :
+	m_Transport(transport ? transport : new WinInetTransport()),
+	m_OwnsTransport(!transport),
+	m_TimeToLive(DEFAULT_TIME_TO_LIVE),
+	m_MaxBodySize(DEFAULT_MAX_BODY_SIZE),
+	m_Stats()
+{
+	InitializeCriticalSection(&m_CriticalSection);
+	InitializeConditionVariable(&m_RequestDone);
+}
+
+WebFetcher::~WebFetcher()
+{
+	if (m_OwnsTransport)
+	{
+		delete m_Transport;
+	}
+
+	DeleteCriticalSection(&m_CriticalSection);
+}
+
+/*
+** Requests made through a different proxy or with different headers may get a different response
+** so they are cached separately.
+**
+*/
+std::shared_ptr<const WebFetcher::Data> WebFetcher::Fetch(HINTERNET handle, const std::wstring& url, const std::wstring& headers, bool forceReload)
+{
+	WCHAR buffer[32];
+	_snwprintf_s(buffer, _TRUNCATE, L"%p\n", handle);
+	std::wstring key = buffer;
+	key += url;
+	key += L'\n';
+	key += headers;
+
+	EnterCriticalSection(&m_CriticalSection);
+	++m_Stats.requests;
+
+	std::shared_ptr<Entry> entry = GetEntry(key, GetTickCount64());
+	if (entry->pending)
+	{
+		++m_Stats.coalesced;
+
+		// If the thread making the request was terminated, make a new request instead.
+		while (entry->pending && IsThreadAlive(entry->requestThread))
+		{
+			SleepConditionVariableCS(&m_RequestDone, &m_CriticalSection, 1000);
+		}
+
+		if (!entry->pending)
+		{
+			std::shared_ptr<const Data> result = entry->result;
+			LeaveCriticalSection(&m_CriticalSection);
+			return result;
+		}
+	}
+	else if (!forceReload && entry->data && GetTickCount64() - entry->fetchTime < m_TimeToLive)
+	{
+		++m_Stats.hits;
+
+		std::shared_ptr<const Data> result = entry->data;
+		LeaveCriticalSection(&m_CriticalSection);
+		return result;
+	}
+
+	entry->pending = true;
+	entry->requestThread = GetCurrentThreadId();
+
+	std::wstring requestHeaders;
+	if (!forceReload && entry->data)
+	{
+		if (!entry->etag.empty())
+		{
+			requestHeaders += L"If-None-Match: ";
+			requestHeaders += entry->etag;
+			requestHeaders += L"\r\n";
+		}
+
+		if (!entry->lastModified.empty())
+		{
+			requestHeaders += L"If-Modified-Since: ";
+			requestHeaders += entry->lastModified;
+			requestHeaders += L"\r\n";
+		}
+	}
+	requestHeaders += headers;
+
+	const size_t maxSize = m_MaxBodySize;
+
+	LeaveCriticalSection(&m_CriticalSection);
+
+	Response response;
+	const bool received = m_Transport->Get(handle, url, requestHeaders, maxSize, response) && response.data.size() <= maxSize;
+
+	EnterCriticalSection(&m_CriticalSection);
+
+	std::shared_ptr<const Data> result;
+	if (!received)
+	{
+		++m_Stats.errors;
+	}
+	else if (response.status == 304 && entry->data)
+	{
+		++m_Stats.revalidated;
+
+		result = entry->data;
+		entry->fetchTime = GetTickCount64();
+	}
+	else
+	{
+		++m_Stats.downloads;
+
+		result = std::make_shared<const Data>(std::move(response.data));
+
+		// Only successful responses are cached. Error pages are still returned to the caller.
+		if (response.status == 200 || response.status == 0)
+		{
+			entry->data = result;
+			entry->etag = response.etag;
+			entry->lastModified = response.lastModified;
+			entry->fetchTime = GetTickCount64();
+		}
+	}
+
+	entry->result = result;
+	entry->pending = false;
+
+	LeaveCriticalSection(&m_CriticalSection);
+	WakeAllConditionVariable(&m_RequestDone);
+
+	return result;
+}
+
+/*
+** Returns the entry for the key. If a new entry does not fit, the least recently used entry that
+** has no request in progress is evicted.
+**
+*/
+std::shared_ptr<WebFetcher::Entry> WebFetcher::GetEntry(const std::wstring& key, ULONGLONG now)
+{
+	auto iter = m_Entries.find(key);
+	if (iter == m_Entries.end())
+	{
+		if (m_Entries.size() >= MAX_ENTRIES)
+		{
+			auto oldest = m_Entries.end();
+			for (auto it = m_Entries.begin(); it != m_Entries.end(); ++it)
+			{
+				if (!it->second->pending &&
+					(oldest == m_Entries.end() || it->second->useTime < oldest->second->useTime))
+				{
+					oldest = it;
+				}
+			}
+
+			if (oldest != m_Entries.end())
+			{
+				m_Entries.erase(oldest);
+			}
+		}
+
+		iter = m_Entries.insert(std::make_pair(key, std::make_shared<Entry>())).first;
+	}
+
+	iter->second->useTime = now;
+	return iter->second;
+}
+
+void WebFetcher::SetTimeToLive(ULONGLONG timeToLive)
+{
+	EnterCriticalSection(&m_CriticalSection);
+	m_TimeToLive = timeToLive;
+	LeaveCriticalSection(&m_CriticalSection);
+}
+
+void WebFetcher::SetMaxBodySize(size_t maxBodySize)
+{
+	EnterCriticalSection(&m_CriticalSection);
+	m_MaxBodySize = maxBodySize;
+	LeaveCriticalSection(&m_CriticalSection);
+}
+
+/*
+** Removes the cached responses. Requests in progress are not affected.
+**
+*/
+void WebFetcher::Clear()
+{
+	EnterCriticalSection(&m_CriticalSection);
+	for (auto iter = m_Entries.begin(); iter != m_Entries.end(); )
+	{
+		if (iter->second->pending)
+		{
+			++iter;
+		}
+		else
+		{
+			iter = m_Entries.erase(iter);
+		}
+	}
+	LeaveCriticalSection(&m_CriticalSection);
+}
+
+size_t WebFetcher::GetSize()
+{
+	EnterCriticalSection(&m_CriticalSection);
+	const size_t size = m_Entries.size();
+	LeaveCriticalSection(&m_CriticalSection);
+	return size;
+}
+
+WebFetcher::Stats WebFetcher::GetStats()
+{
+	EnterCriticalSection(&m_CriticalSection);
+	const Stats stats = m_Stats;
+	LeaveCriticalSection(&m_CriticalSection);
+	return stats;
+}
+
+WebFetcher::Decoder::Decoder(Data& data, size_t maxSize) :
+	m_Data(data),
+	m_MaxSize(maxSize),
+	m_Encoding(Encoding::Identity),
+	m_Stream(),
+	m_Header(),
+	m_HeaderSize(),
+	m_StreamEnd(false),
+	m_TooLarge(false)
+{
+}
+
+WebFetcher::Decoder::~Decoder()
+{
+	if (m_Stream)
+	{
+		inflateEnd(m_Stream);
+		delete m_Stream;
+	}
+}
+
+bool WebFetcher::Decoder::Begin(const std::wstring& contentEncoding, size_t expectedSize)
+{
+	const WCHAR* encoding = contentEncoding.c_str();
+	if (*encoding == L'\0' || _wcsicmp(encoding, L"identity") == 0)
+	{
+		m_Encoding = Encoding::Identity;
+		m_Data.reserve(min(expectedSize, m_MaxSize));
+		return true;
+	}
+
+	if (_wcsicmp(encoding, L"gzip") == 0 || _wcsicmp(encoding, L"x-gzip") == 0)
+	{
+		m_Encoding = Encoding::Gzip;
+	}
+	else if (_wcsicmp(encoding, L"deflate") == 0)
+	{
+		m_Encoding = Encoding::Deflate;
+	}
+	else
+	{
+		return false;
+	}
+
+	m_Stream = new z_stream();
+	const int windowBits = (m_Encoding == Encoding::Gzip) ? 16 + MAX_WBITS : MAX_WBITS;
+	if (inflateInit2(m_Stream, windowBits) != Z_OK)
+	{
+		delete m_Stream;
+		m_Stream = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+bool WebFetcher::Decoder::Write(const BYTE* data, size_t size)
+{
+	if (m_Encoding == Encoding::Identity)
+	{
+		if (size > m_MaxSize - m_Data.size())
+		{
+			m_TooLarge = true;
+			return false;
+		}
+
+		m_Data.insert(m_Data.end(), data, data + size);
+		return true;
+	}
+
+	if (m_Encoding == Encoding::Deflate && m_HeaderSize < _countof(m_Header))
+	{
+		while (size > 0 && m_HeaderSize < _countof(m_Header))
+		{
+			m_Header[m_HeaderSize++] = *data++;
+			--size;
+		}
+
+		if (m_HeaderSize < _countof(m_Header))
+		{
+			return true;
+		}
+
+		const bool zlibHeader = (m_Header[0] & 0x0F) == Z_DEFLATED && ((m_Header[0] << 8) | m_Header[1]) % 31 == 0;
+		if (!zlibHeader && inflateReset2(m_Stream, -MAX_WBITS) != Z_OK)
+		{
+			return false;
+		}
+
+		if (!Inflate(m_Header, m_HeaderSize))
+		{
+			return false;
+		}
+	}
+
+	return Inflate(data, size);
+}
+
+bool WebFetcher::Decoder::End()
+{
+	if (m_Encoding == Encoding::Identity)
+	{
+		return true;
+	}
+
+	// An empty body is not compressed even if the server says so.
+	return m_StreamEnd || (m_HeaderSize == 0 && m_Stream->total_in == 0);
+}
+
+/*
+** Decodes the data to the end of the body. One byte more than allowed is decoded so that a body
+** of exactly the maximum size is accepted.
+**
+*/
+bool WebFetcher::Decoder::Inflate(const BYTE* data, size_t size)
+{
+	const size_t CHUNK_SIZE = 16384;
+
+	m_Stream->next_in = (Bytef*)data;
+	m_Stream->avail_in = (uInt)size;
+
+	bool more = true;
+	while (more)
+	{
+		if (m_StreamEnd)
+		{
+			if (m_Stream->avail_in == 0 || m_Encoding != Encoding::Gzip)
+			{
+				// Ignore anything after the end of a deflate stream.
+				break;
+			}
+
+			// Another gzip member follows.
+			inflateReset(m_Stream);
+			m_StreamEnd = false;
+		}
+
+		const size_t used = m_Data.size();
+		const size_t room = (m_MaxSize - used < CHUNK_SIZE) ? m_MaxSize - used + 1 : CHUNK_SIZE;
+		m_Data.resize(used + room);
+
+		m_Stream->next_out = &m_Data[used];
+		m_Stream->avail_out = (uInt)room;
+		const int result = inflate(m_Stream, Z_NO_FLUSH);
+		m_Data.resize(used + room - m_Stream->avail_out);
+
+		if (m_Data.size() > m_MaxSize)
+		{
+			m_TooLarge = true;
+			return false;
+		}
+
+		if (result == Z_STREAM_END)
+		{
+			m_StreamEnd = true;
+		}
+		else if (result != Z_OK && result != Z_BUF_ERROR)
+		{
+			return false;
+		}
+
+		// If the output buffer was filled, there may be more to decode.
+		more = m_Stream->avail_in > 0 || m_Stream->avail_out == 0;
+	}
+
+	return true;
+}
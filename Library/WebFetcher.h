@@ -0,0 +1,177 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#ifndef RM_LIBRARY_WEBFETCHER_H_
+#define RM_LIBRARY_WEBFETCHER_H_
+
+#include <Windows.h>
+#include <WinInet.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct z_stream_s;
+
+// Process-wide fetch layer for WebParser measures. Requests for the same URL (with the same
+// headers and proxy) are shared:
+//
+// - If a request is already in progress, the caller waits for it and gets the same response.
+// - A response younger than the time to live (zero by default) is returned without a request.
+// - Otherwise the request is sent with If-None-Match and If-Modified-Since if the previous
+//   response had an ETag or Last-Modified header. A 304 response reuses the cached body.
+//
+// Compressed responses are decoded as they are received. Responses larger than the maximum body
+// size are treated as failed requests.
+//
+// All functions are thread-safe. The data returned by Fetch() stays valid as long as it is
+// referenced, even if the response is evicted in the meantime.
+class WebFetcher
+{
+public:
+	typedef std::vector<BYTE> Data;
+
+	struct Response
+	{
+		DWORD status;  // Zero if the protocol has no status code (e.g. FTP)
+		std::wstring etag;
+		std::wstring lastModified;
+		Data data;
+
+		Response() : status() {}
+	};
+
+	// Sends the requests. Tests replace the WinINet implementation with a stand-in server.
+	class Transport
+	{
+	public:
+		virtual ~Transport() {}
+
+		// Sends a GET request. The headers end with "\r\n" unless empty. Returns false if no
+		// response was received or if the body would be larger than maxSize bytes.
+		virtual bool Get(HINTERNET handle, const std::wstring& url, const std::wstring& headers, size_t maxSize, Response& response) = 0;
+	};
+
+	// Decodes a body with the given Content-Encoding (identity, gzip or deflate) as it is
+	// received.
+	class Decoder
+	{
+	public:
+		Decoder(Data& data, size_t maxSize);
+		~Decoder();
+
+		Decoder(const Decoder& other) = delete;
+		Decoder& operator=(Decoder other) = delete;
+
+		// Returns false if the encoding is not supported. The expected size is used only to
+		// allocate the buffer and may be zero if unknown.
+		bool Begin(const std::wstring& contentEncoding, size_t expectedSize);
+
+		// Returns false if the data is corrupt or the decoded body is too large.
+		bool Write(const BYTE* data, size_t size);
+
+		// Returns false if the body was cut short.
+		bool End();
+
+		bool IsTooLarge() const { return m_TooLarge; }
+
+	private:
+		enum class Encoding
+		{
+			Identity,
+			Gzip,
+			Deflate
+		};
+
+		bool Inflate(const BYTE* data, size_t size);
+
+		Data& m_Data;
+		size_t m_MaxSize;
+		Encoding m_Encoding;
+		z_stream_s* m_Stream;
+
+		// The first two bytes of a deflate body tell whether it has the zlib header. Some servers
+		// send raw deflate data instead.
+		BYTE m_Header[2];
+		size_t m_HeaderSize;
+
+		bool m_StreamEnd;
+		bool m_TooLarge;
+	};
+
+	struct Stats
+	{
+		ULONGLONG requests;		// Calls to Fetch()
+		ULONGLONG hits;			// Returned from the cache without a request
+		ULONGLONG coalesced;	// Waited for a request made by another caller
+		ULONGLONG revalidated;	// Cached body reused after a 304 response
+		ULONGLONG downloads;	// Full responses received
+		ULONGLONG errors;		// Requests without a response
+	};
+
+	WebFetcher(Transport* transport = nullptr);
+	~WebFetcher();
+
+	WebFetcher(const WebFetcher& other) = delete;
+	WebFetcher& operator=(WebFetcher other) = delete;
+
+	// Returns the body of the response or nullptr if the request failed. If forceReload is true,
+	// the cached response is not used and no conditional request is made. The result of a request
+	// already in progress is still shared.
+	std::shared_ptr<const Data> Fetch(HINTERNET handle, const std::wstring& url, const std::wstring& headers, bool forceReload);
+
+	// Responses older than this (in milliseconds) are validated with the server before use.
+	void SetTimeToLive(ULONGLONG timeToLive);
+	ULONGLONG GetTimeToLive() const { return m_TimeToLive; }
+
+	// Maximum size of a decoded body in bytes.
+	void SetMaxBodySize(size_t maxBodySize);
+	size_t GetMaxBodySize() const { return m_MaxBodySize; }
+
+	void Clear();
+
+	size_t GetSize();
+	Stats GetStats();
+
+	static const size_t MAX_ENTRIES = 64;
+	static const ULONGLONG DEFAULT_TIME_TO_LIVE = 0;
+	static const size_t DEFAULT_MAX_BODY_SIZE = 32 * 1024 * 1024;
+
+private:
+	struct Entry
+	{
+		std::shared_ptr<const Data> data;  // Last successful response
+		std::wstring etag;
+		std::wstring lastModified;
+		ULONGLONG fetchTime;
+		ULONGLONG useTime;
+
+		// While a request is in progress, other callers wait for its result.
+		bool pending;
+		DWORD requestThread;
+		std::shared_ptr<const Data> result;  // nullptr if the request failed
+
+		Entry() : fetchTime(), useTime(), pending(false), requestThread() {}
+	};
+
+	std::shared_ptr<Entry> GetEntry(const std::wstring& key, ULONGLONG now);
+
+	Transport* m_Transport;
+	bool m_OwnsTransport;
+
+	std::unordered_map<std::wstring, std::shared_ptr<Entry>> m_Entries;
+	ULONGLONG m_TimeToLive;
+	size_t m_MaxBodySize;
+	Stats m_Stats;
+
+	CRITICAL_SECTION m_CriticalSection;
+	CONDITION_VARIABLE m_RequestDone;
+};
+
+WebFetcher& GetWebFetcher();
+
+#endif
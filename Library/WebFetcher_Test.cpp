@@ -0,0 +1,327 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "WebFetcher.h"
+#include "zlib.h"
+#include "../Common/UnitTest.h"
+
+namespace {
+
+// Stand-in for an HTTP server. Every response has an ETag and a Last-Modified header and a
+// matching If-None-Match header gets a 304 response.
+class TestServer : public WebFetcher::Transport
+{
+public:
+	TestServer() : m_Requests(), m_Version(1), m_Fail(false), m_Gate() {}
+
+	bool Get(HINTERNET handle, const std::wstring& url, const std::wstring& headers, size_t maxSize, WebFetcher::Response& response) override
+	{
+		InterlockedIncrement(&m_Requests);
+		m_LastHeaders = headers;
+
+		if (m_Gate)
+		{
+			WaitForSingleObject(m_Gate, INFINITE);
+		}
+
+		if (m_Fail)
+		{
+			return false;
+		}
+
+		std::string body;
+		if (url == L"http://localhost/missing")
+		{
+			response.status = 404;
+			body = "Not found";
+		}
+		else
+		{
+			const std::wstring etag = L"\"" + std::to_wstring(m_Version) + L"\"";
+			if (headers.find(L"If-None-Match: " + etag + L"\r\n") != std::wstring::npos)
+			{
+				response.status = 304;
+				return true;
+			}
+
+			response.status = 200;
+			response.etag = etag;
+			response.lastModified = L"Thu, 01 Jan 2026 00:00:00 GMT";
+			body = url.find(L"other") != std::wstring::npos ? "other" : "version " + std::to_string(m_Version);
+		}
+
+		response.data.assign(body.begin(), body.end());
+		return true;
+	}
+
+	volatile LONG m_Requests;
+	std::wstring m_LastHeaders;
+	int m_Version;
+	bool m_Fail;
+	HANDLE m_Gate;
+};
+
+std::string ToString(const std::shared_ptr<const WebFetcher::Data>& data)
+{
+	return data ? std::string(data->begin(), data->end()) : std::string("(null)");
+}
+
+// Compresses the text with the given windowBits: 16 + 15 for gzip, 15 for zlib and -15 for raw
+// deflate.
+WebFetcher::Data Compress(const std::string& text, int windowBits)
+{
+	WebFetcher::Data data(text.size() + 256);
+
+	z_stream stream = {};
+	deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY);
+	stream.next_in = (Bytef*)text.data();
+	stream.avail_in = (uInt)text.size();
+	stream.next_out = &data[0];
+	stream.avail_out = (uInt)data.size();
+	deflate(&stream, Z_FINISH);
+	data.resize(stream.total_out);
+	deflateEnd(&stream);
+
+	return data;
+}
+
+// Decodes the data in pieces of the given size.
+bool Decode(const std::wstring& encoding, const WebFetcher::Data& data, size_t pieceSize, size_t maxSize, std::string& text)
+{
+	WebFetcher::Data decoded;
+	WebFetcher::Decoder decoder(decoded, maxSize);
+	if (!decoder.Begin(encoding, 0)) return false;
+
+	for (size_t pos = 0; pos < data.size(); pos += pieceSize)
+	{
+		if (!decoder.Write(&data[pos], min(pieceSize, data.size() - pos))) return false;
+	}
+
+	if (!decoder.End()) return false;
+
+	text.assign(decoded.begin(), decoded.end());
+	return true;
+}
+
+}  // namespace
+
+TEST_CLASS(Library_WebFetcher_Test)
+{
+public:
+	TEST_METHOD(TestCache)
+	{
+		TestServer server;
+		WebFetcher fetcher(&server);
+		fetcher.SetTimeToLive(3600000);
+
+		auto data = fetcher.Fetch(nullptr, L"http://localhost/feed", L"", false);
+		Assert::AreEqual(std::string("version 1"), ToString(data));
+		Assert::IsTrue(data == fetcher.Fetch(nullptr, L"http://localhost/feed", L"", false));
+		Assert::AreEqual(1L, (LONG)server.m_Requests);
+
+		// Different headers are cached separately.
+		fetcher.Fetch(nullptr, L"http://localhost/feed", L"Accept: text/xml\r\n\r\n", false);
+		Assert::AreEqual(2L, (LONG)server.m_Requests);
+		Assert::AreEqual(std::wstring(L"Accept: text/xml\r\n\r\n"), server.m_LastHeaders);
+
+		// The cache is bypassed with forceReload.
+		server.m_Version = 2;
+		Assert::AreEqual(std::string("version 2"), ToString(fetcher.Fetch(nullptr, L"http://localhost/feed", L"", true)));
+		Assert::AreEqual(std::wstring(), server.m_LastHeaders);
+		Assert::AreEqual(std::string("version 2"), ToString(fetcher.Fetch(nullptr, L"http://localhost/feed", L"", false)));
+		Assert::AreEqual(3L, (LONG)server.m_Requests);
+
+		const WebFetcher::Stats stats = fetcher.GetStats();
+		Assert::AreEqual(5ULL, stats.requests);
+		Assert::AreEqual(2ULL, stats.hits);
+		Assert::AreEqual(3ULL, stats.downloads);
+		Assert::AreEqual((size_t)2, fetcher.GetSize());
+
+		fetcher.Clear();
+		Assert::AreEqual((size_t)0, fetcher.GetSize());
+	}
+
+	TEST_METHOD(TestConditionalRequest)
+	{
+		TestServer server;
+		WebFetcher fetcher(&server);
+		fetcher.SetTimeToLive(0);
+
+		auto data = fetcher.Fetch(nullptr, L"http://localhost/feed", L"Header: 1\r\n\r\n", false);
+		Assert::AreEqual(std::wstring(L"Header: 1\r\n\r\n"), server.m_LastHeaders);
+
+		// The body of the 304 response is reused.
+		Assert::IsTrue(data == fetcher.Fetch(nullptr, L"http://localhost/feed", L"Header: 1\r\n\r\n", false));
+		Assert::AreEqual(
+			std::wstring(L"If-None-Match: \"1\"\r\nIf-Modified-Since: Thu, 01 Jan 2026 00:00:00 GMT\r\nHeader: 1\r\n\r\n"),
+			server.m_LastHeaders);
+
+		server.m_Version = 2;
+		Assert::AreEqual(std::string("version 2"), ToString(fetcher.Fetch(nullptr, L"http://localhost/feed", L"Header: 1\r\n\r\n", false)));
+
+		const WebFetcher::Stats stats = fetcher.GetStats();
+		Assert::AreEqual(3L, (LONG)server.m_Requests);
+		Assert::AreEqual(1ULL, stats.revalidated);
+		Assert::AreEqual(2ULL, stats.downloads);
+	}
+
+	TEST_METHOD(TestErrors)
+	{
+		TestServer server;
+		WebFetcher fetcher(&server);
+		fetcher.SetTimeToLive(3600000);
+
+		// Error pages are returned, but not cached.
+		Assert::AreEqual(std::string("Not found"), ToString(fetcher.Fetch(nullptr, L"http://localhost/missing", L"", false)));
+		Assert::AreEqual(std::string("Not found"), ToString(fetcher.Fetch(nullptr, L"http://localhost/missing", L"", false)));
+		Assert::AreEqual(2L, (LONG)server.m_Requests);
+
+		server.m_Fail = true;
+		Assert::IsNull(fetcher.Fetch(nullptr, L"http://localhost/feed", L"", false).get());
+		Assert::AreEqual(1ULL, fetcher.GetStats().errors);
+
+		// A failed request does not replace the cached response.
+		server.m_Fail = false;
+		auto data = fetcher.Fetch(nullptr, L"http://localhost/feed", L"", false);
+		server.m_Fail = true;
+		Assert::IsNull(fetcher.Fetch(nullptr, L"http://localhost/feed", L"", true).get());
+		Assert::IsTrue(data == fetcher.Fetch(nullptr, L"http://localhost/feed", L"", false));
+	}
+
+	TEST_METHOD(TestCoalescing)
+	{
+		TestServer server;
+		server.m_Gate = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+		WebFetcher fetcher(&server);
+
+		struct Context
+		{
+			WebFetcher* fetcher;
+			std::shared_ptr<const WebFetcher::Data> data;
+		} contexts[4];
+
+		auto threadProc = [](LPVOID param) -> DWORD
+		{
+			Context* context = (Context*)param;
+			context->data = context->fetcher->Fetch(nullptr, L"http://localhost/feed", L"", false);
+			return 0;
+		};
+
+		HANDLE threads[_countof(contexts)];
+		for (size_t i = 0; i < _countof(contexts); ++i)
+		{
+			contexts[i].fetcher = &fetcher;
+			threads[i] = CreateThread(nullptr, 0, threadProc, &contexts[i], 0, nullptr);
+		}
+
+		// Let the request finish once the other callers are waiting for it.
+		for (int i = 0; i < 5000 && fetcher.GetStats().coalesced < _countof(contexts) - 1; ++i)
+		{
+			Sleep(1);
+		}
+		SetEvent(server.m_Gate);
+
+		for (size_t i = 0; i < _countof(contexts); ++i)
+		{
+			WaitForSingleObject(threads[i], INFINITE);
+			CloseHandle(threads[i]);
+			Assert::AreEqual(std::string("version 1"), ToString(contexts[i].data));
+			Assert::IsTrue(contexts[i].data == contexts[0].data);
+		}
+
+		CloseHandle(server.m_Gate);
+		Assert::AreEqual(1L, (LONG)server.m_Requests);
+		Assert::AreEqual(3ULL, fetcher.GetStats().coalesced);
+	}
+
+	TEST_METHOD(TestEviction)
+	{
+		TestServer server;
+		WebFetcher fetcher(&server);
+		fetcher.SetTimeToLive(3600000);
+
+		for (size_t i = 0; i <= WebFetcher::MAX_ENTRIES; ++i)
+		{
+			fetcher.Fetch(nullptr, L"http://localhost/other" + std::to_wstring(i), L"", false);
+			if (i == 0)
+			{
+				Sleep(20);
+			}
+		}
+		Assert::AreEqual((size_t)WebFetcher::MAX_ENTRIES, fetcher.GetSize());
+
+		// The least recently used response was evicted.
+		fetcher.Fetch(nullptr, L"http://localhost/other0", L"", false);
+		Assert::AreEqual((LONG)WebFetcher::MAX_ENTRIES + 2, (LONG)server.m_Requests);
+	}
+
+	TEST_METHOD(TestMaxBodySize)
+	{
+		TestServer server;
+		WebFetcher fetcher(&server);
+
+		fetcher.SetMaxBodySize(9);
+		Assert::AreEqual(std::string("version 1"), ToString(fetcher.Fetch(nullptr, L"http://localhost/feed", L"", true)));
+
+		fetcher.SetMaxBodySize(8);
+		Assert::IsNull(fetcher.Fetch(nullptr, L"http://localhost/feed", L"", true).get());
+		Assert::AreEqual(1ULL, fetcher.GetStats().errors);
+	}
+
+	TEST_METHOD(TestDecoder)
+	{
+		std::string body;
+		for (int i = 0; i < 5000; ++i)
+		{
+			body += "<item>" + std::to_string(i) + "</item>";
+		}
+
+		const WebFetcher::Data gzip = Compress(body, 16 + MAX_WBITS);
+		const WebFetcher::Data zlib = Compress(body, MAX_WBITS);
+		const WebFetcher::Data raw = Compress(body, -MAX_WBITS);
+		const WebFetcher::Data identity(body.begin(), body.end());
+
+		const size_t pieceSizes[] = { 1, 7, 8192, 1000000 };
+		for (size_t pieceSize : pieceSizes)
+		{
+			std::string text;
+			Assert::IsTrue(Decode(L"gzip", gzip, pieceSize, SIZE_MAX, text));
+			Assert::IsTrue(body == text);
+			Assert::IsTrue(Decode(L"deflate", zlib, pieceSize, SIZE_MAX, text));
+			Assert::IsTrue(body == text);
+			Assert::IsTrue(Decode(L"Deflate", raw, pieceSize, SIZE_MAX, text));
+			Assert::IsTrue(body == text);
+			Assert::IsTrue(Decode(L"", identity, pieceSize, SIZE_MAX, text));
+			Assert::IsTrue(body == text);
+		}
+
+		// Concatenated gzip members are decoded as one body.
+		WebFetcher::Data members = Compress("first ", 16 + MAX_WBITS);
+		const WebFetcher::Data second = Compress("second", 16 + MAX_WBITS);
+		members.insert(members.end(), second.begin(), second.end());
+		std::string text;
+		Assert::IsTrue(Decode(L"x-gzip", members, 5, SIZE_MAX, text));
+		Assert::AreEqual(std::string("first second"), text);
+
+		// The limit applies to the decoded size.
+		Assert::IsTrue(Decode(L"gzip", gzip, 8192, body.size(), text));
+		Assert::IsFalse(Decode(L"gzip", gzip, 8192, body.size() - 1, text));
+		Assert::IsTrue(Decode(L"identity", identity, 8192, body.size(), text));
+		Assert::IsFalse(Decode(L"identity", identity, 8192, body.size() - 1, text));
+
+		// Truncated, corrupt and unsupported bodies fail.
+		const WebFetcher::Data truncated(gzip.begin(), gzip.begin() + gzip.size() / 2);
+		Assert::IsFalse(Decode(L"gzip", truncated, 8192, SIZE_MAX, text));
+		Assert::IsFalse(Decode(L"gzip", identity, 8192, SIZE_MAX, text));
+		Assert::IsFalse(Decode(L"br", identity, 8192, SIZE_MAX, text));
+
+		// An empty body is accepted.
+		Assert::IsTrue(Decode(L"gzip", WebFetcher::Data(), 8192, SIZE_MAX, text));
+		Assert::AreEqual(std::string(), text);
+	}
+};
@@ -0,0 +1,356 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#include "StdAfx.h"
+#include "WebTaskPool.h"
+#include "../Common/StringUtil.h"
+
+WebTaskPool& GetWebTaskPool()
+{
+	static WebTaskPool s_WebTaskPool;
+	return s_WebTaskPool;
+}
+
+WebTaskPool::WebTaskPool(UINT maxWorkers, UINT maxPerHost) :
+	m_MaxWorkers(max(1U, maxWorkers)),
+	m_MaxPerHost(max(1U, maxPerHost)),
+	m_WorkerCount(),
+	m_IdleWorkers(),
+	m_Shutdown(false),
+	m_EnterCount(),
+	m_TaskLeft(CreateEvent(nullptr, TRUE, FALSE, nullptr))
+{
+	InitializeCriticalSection(&m_CriticalSection);
+	InitializeConditionVariable(&m_TaskQueued);
+}
+
+WebTaskPool::~WebTaskPool()
+{
+	EnterCriticalSection(&m_CriticalSection);
+
+	m_Shutdown = true;
+
+	for (Task* task : m_Queue)
+	{
+		delete task;
+	}
+	m_Queue.clear();
+
+	for (Task* task : m_Running)
+	{
+		task->cancelled = true;
+	}
+
+	std::vector<HANDLE> workers;
+	workers.swap(m_Workers);
+
+	LeaveCriticalSection(&m_CriticalSection);
+
+	WakeAllConditionVariable(&m_TaskQueued);
+
+	// Idle workers exit right away and busy ones once their task returns. When the process is
+	// exiting, the workers have already been terminated and their handles are signaled.
+	for (HANDLE worker : workers)
+	{
+		WaitForSingleObject(worker, INFINITE);
+		CloseHandle(worker);
+	}
+
+	CloseHandle(m_TaskLeft);
+	DeleteCriticalSection(&m_CriticalSection);
+}
+
+bool WebTaskPool::Submit(const void* owner, const std::wstring& url, Function function)
+{
+	EnterCriticalSection(&m_CriticalSection);
+
+	bool queued = false;
+	if (!m_Shutdown &&
+		std::find(m_CancellingOwners.cbegin(), m_CancellingOwners.cend(), owner) == m_CancellingOwners.cend())
+	{
+		Task* task = new Task();
+		task->owner = owner;
+		task->host = GetHost(url);
+		task->function = std::move(function);
+		m_Queue.push_back(task);
+
+		// Start another worker unless there are enough idle ones to take the queued tasks.
+		if (m_IdleWorkers < m_Queue.size() && m_WorkerCount < m_MaxWorkers)
+		{
+			StartWorker();
+		}
+
+		if (m_WorkerCount > 0)
+		{
+			WakeConditionVariable(&m_TaskQueued);
+			queued = true;
+		}
+		else
+		{
+			m_Queue.pop_back();
+			delete task;
+		}
+	}
+
+	LeaveCriticalSection(&m_CriticalSection);
+	return queued;
+}
+
+/*
+** Tasks of other owners may access the owner as well (e.g. a parent measure that updates its
+** children), so this waits for every task that entered before the call. While waiting, new
+** tasks for the owner are rejected since the waited tasks may submit them (e.g. a WebParser
+** measure that starts its download) and nothing would cancel them afterwards.
+**
+*/
+void WebTaskPool::Cancel(const void* owner)
+{
+	EnterCriticalSection(&m_CriticalSection);
+
+	m_CancellingOwners.push_back(owner);
+
+	for (auto iter = m_Queue.begin(); iter != m_Queue.end(); )
+	{
+		if ((*iter)->owner == owner)
+		{
+			delete *iter;
+			iter = m_Queue.erase(iter);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+
+	for (Task* task : m_Running)
+	{
+		if (task->owner == owner)
+		{
+			task->cancelled = true;
+		}
+	}
+
+	const ULONGLONG enterCount = m_EnterCount;
+	auto isEntered = [enterCount](const Task* task)
+	{
+		return task->entered && task->enterCount <= enterCount;
+	};
+
+	while (std::any_of(m_Running.cbegin(), m_Running.cend(), isEntered))
+	{
+		ResetEvent(m_TaskLeft);
+		LeaveCriticalSection(&m_CriticalSection);
+
+		if (MsgWaitForMultipleObjects(1, &m_TaskLeft, FALSE, INFINITE, QS_SENDMESSAGE) == WAIT_OBJECT_0 + 1)
+		{
+			// Dispatches the messages sent by other threads.
+			MSG msg;
+			PeekMessage(&msg, nullptr, 0, 0, PM_NOREMOVE);
+		}
+
+		EnterCriticalSection(&m_CriticalSection);
+	}
+
+	m_CancellingOwners.erase(std::find(m_CancellingOwners.begin(), m_CancellingOwners.end(), owner));
+
+	LeaveCriticalSection(&m_CriticalSection);
+}
+
+UINT WebTaskPool::GetWorkerCount()
+{
+	EnterCriticalSection(&m_CriticalSection);
+	const UINT count = m_WorkerCount;
+	LeaveCriticalSection(&m_CriticalSection);
+	return count;
+}
+
+size_t WebTaskPool::GetQueueSize()
+{
+	EnterCriticalSection(&m_CriticalSection);
+	const size_t size = m_Queue.size();
+	LeaveCriticalSection(&m_CriticalSection);
+	return size;
+}
+
+/*
+** Returns the lowercase host (and port) of the url or an empty string if the url has none, e.g.
+** for local files. Tasks without a host are not limited.
+**
+*/
+std::wstring WebTaskPool::GetHost(const std::wstring& url)
+{
+	std::wstring::size_type start = url.find(L"://");
+	if (start == std::wstring::npos)
+	{
+		return std::wstring();
+	}
+
+	start += 3;
+	const std::wstring::size_type end = url.find_first_of(L"/?#", start);
+	std::wstring host(url, start, end == std::wstring::npos ? std::wstring::npos : end - start);
+
+	// Remove the user name and password.
+	const std::wstring::size_type pos = host.rfind(L'@');
+	if (pos != std::wstring::npos)
+	{
+		host.erase(0, pos + 1);
+	}
+
+	StringUtil::ToLowerCase(host);
+	return host;
+}
+
+unsigned __stdcall WebTaskPool::WorkerThreadProc(void* param)
+{
+	((WebTaskPool*)param)->RunWorker();
+	return 0;
+}
+
+void WebTaskPool::RunWorker()
+{
+	EnterCriticalSection(&m_CriticalSection);
+
+	ULONGLONG idleTime = GetTickCount64();
+	while (!m_Shutdown)
+	{
+		if (Task* task = TakeTask())
+		{
+			LeaveCriticalSection(&m_CriticalSection);
+
+			Context context(*this, task);
+			task->function(context);
+
+			EnterCriticalSection(&m_CriticalSection);
+			FinishTask(task);
+
+			idleTime = GetTickCount64();
+			continue;
+		}
+
+		const ULONGLONG idle = GetTickCount64() - idleTime;
+		if (idle >= IDLE_TIMEOUT)
+		{
+			break;
+		}
+
+		++m_IdleWorkers;
+		SleepConditionVariableCS(&m_TaskQueued, &m_CriticalSection, (DWORD)(IDLE_TIMEOUT - idle));
+		--m_IdleWorkers;
+	}
+
+	--m_WorkerCount;
+
+	LeaveCriticalSection(&m_CriticalSection);
+}
+
+bool WebTaskPool::StartWorker()
+{
+	// Close the handles of the workers that have exited.
+	auto exited = [](HANDLE worker)
+	{
+		if (WaitForSingleObject(worker, 0) == WAIT_OBJECT_0)
+		{
+			CloseHandle(worker);
+			return true;
+		}
+		return false;
+	};
+	m_Workers.erase(std::remove_if(m_Workers.begin(), m_Workers.end(), exited), m_Workers.end());
+
+	HANDLE worker = (HANDLE)_beginthreadex(nullptr, 0, WorkerThreadProc, this, 0, nullptr);
+	if (!worker)
+	{
+		return false;
+	}
+
+	m_Workers.push_back(worker);
+	++m_WorkerCount;
+	return true;
+}
+
+/*
+** Takes the first queued task whose host is below the limit.
+**
+*/
+WebTaskPool::Task* WebTaskPool::TakeTask()
+{
+	for (auto iter = m_Queue.begin(); iter != m_Queue.end(); ++iter)
+	{
+		Task* task = *iter;
+		if (!task->host.empty())
+		{
+			UINT& hostTasks = m_HostTasks[task->host];
+			if (hostTasks >= m_MaxPerHost)
+			{
+				continue;
+			}
+
+			++hostTasks;
+		}
+
+		m_Queue.erase(iter);
+		m_Running.push_back(task);
+		return task;
+	}
+
+	return nullptr;
+}
+
+void WebTaskPool::FinishTask(Task* task)
+{
+	// The task may have returned without leaving.
+	LeaveTask(task);
+
+	m_Running.erase(std::find(m_Running.begin(), m_Running.end(), task));
+
+	if (!task->host.empty())
+	{
+		auto iter = m_HostTasks.find(task->host);
+		if (--iter->second == 0)
+		{
+			m_HostTasks.erase(iter);
+		}
+	}
+
+	delete task;
+}
+
+bool WebTaskPool::EnterTask(Task* task)
+{
+	EnterCriticalSection(&m_CriticalSection);
+
+	const bool enter = !task->cancelled;
+	if (enter)
+	{
+		task->entered = true;
+		task->enterCount = ++m_EnterCount;
+	}
+
+	LeaveCriticalSection(&m_CriticalSection);
+	return enter;
+}
+
+void WebTaskPool::LeaveTask(Task* task)
+{
+	EnterCriticalSection(&m_CriticalSection);
+
+	if (task->entered)
+	{
+		task->entered = false;
+		SetEvent(m_TaskLeft);
+	}
+
+	LeaveCriticalSection(&m_CriticalSection);
+}
+
+bool WebTaskPool::IsTaskCancelled(Task* task)
+{
+	EnterCriticalSection(&m_CriticalSection);
+	const bool cancelled = task->cancelled;
+	LeaveCriticalSection(&m_CriticalSection);
+	return cancelled;
+}
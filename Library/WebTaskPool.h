@@ -0,0 +1,125 @@
+/* Copyright (C) 2026 Rainmeter Project Developers
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License; either version 2 of the License, or (at your option) any later
+ * version. If a copy of the GPL was not distributed with this file, You can
+ * obtain one at <https://www.gnu.org/licenses/gpl-2.0.html>. */
+
+#ifndef RM_LIBRARY_WEBTASKPOOL_H_
+#define RM_LIBRARY_WEBTASKPOOL_H_
+
+#include <Windows.h>
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Runs the network tasks of WebParser measures on a bounded set of worker threads. Workers are
+// started as needed up to the maximum and exit after being idle for a while. At most
+// maxPerHost tasks for the same host run at the same time; the others wait in the queue.
+//
+// Tasks are cancelled cooperatively. A task may block on the network for a long time, so it
+// must not touch its owner while doing so. Instead, it accesses the owner only between
+// Context::Enter() and Context::Leave(). Once Cancel() returns, the owner is no longer
+// accessed and may be deleted; the task itself finishes in the background.
+class WebTaskPool
+{
+	struct Task;
+
+public:
+	// Passed to a running task.
+	class Context
+	{
+	public:
+		// Returns false if the task was cancelled. In that case the owner must not be touched and
+		// the task should return.
+		bool Enter() { return m_Pool.EnterTask(m_Task); }
+		void Leave() { m_Pool.LeaveTask(m_Task); }
+
+		bool IsCancelled() { return m_Pool.IsTaskCancelled(m_Task); }
+
+	private:
+		friend class WebTaskPool;
+
+		Context(WebTaskPool& pool, Task* task) : m_Pool(pool), m_Task(task) {}
+
+		WebTaskPool& m_Pool;
+		Task* m_Task;
+	};
+
+	typedef std::function<void(Context&)> Function;
+
+	WebTaskPool(UINT maxWorkers = DEFAULT_MAX_WORKERS, UINT maxPerHost = DEFAULT_MAX_PER_HOST);
+	~WebTaskPool();
+
+	WebTaskPool(const WebTaskPool& other) = delete;
+	WebTaskPool& operator=(WebTaskPool other) = delete;
+
+	// Queues a task for the given owner. The url is used only to find the host. Returns false if
+	// the task could not be queued, e.g. while the tasks of the owner are being cancelled.
+	bool Submit(const void* owner, const std::wstring& url, Function function);
+
+	// Removes the queued tasks of the owner and cancels the running ones. Blocks until no task is
+	// accessing its owner. Sent messages are processed while waiting so that a task may log
+	// while the main thread waits for it.
+	void Cancel(const void* owner);
+
+	UINT GetWorkerCount();
+	size_t GetQueueSize();
+
+	static std::wstring GetHost(const std::wstring& url);
+
+	static const UINT DEFAULT_MAX_WORKERS = 8;
+	static const UINT DEFAULT_MAX_PER_HOST = 4;
+	static const DWORD IDLE_TIMEOUT = 30000;
+
+private:
+	struct Task
+	{
+		const void* owner;
+		std::wstring host;
+		Function function;
+		bool cancelled;
+
+		// Set while the task accesses its owner.
+		bool entered;
+		ULONGLONG enterCount;
+
+		Task() : owner(), cancelled(false), entered(false), enterCount() {}
+	};
+
+	static unsigned __stdcall WorkerThreadProc(void* param);
+
+	void RunWorker();
+	bool StartWorker();
+	Task* TakeTask();
+	void FinishTask(Task* task);
+
+	bool EnterTask(Task* task);
+	void LeaveTask(Task* task);
+	bool IsTaskCancelled(Task* task);
+
+	UINT m_MaxWorkers;
+	UINT m_MaxPerHost;
+
+	std::list<Task*> m_Queue;
+	std::vector<Task*> m_Running;
+	std::unordered_map<std::wstring, UINT> m_HostTasks;
+	std::vector<const void*> m_CancellingOwners;
+
+	std::vector<HANDLE> m_Workers;
+	UINT m_WorkerCount;
+	UINT m_IdleWorkers;
+	bool m_Shutdown;
+
+	ULONGLONG m_EnterCount;
+	HANDLE m_TaskLeft;
+
+	CRITICAL_SECTION m_CriticalSection;
+	CONDITION_VARIABLE m_TaskQueued;
+};
+
+WebTaskPool& GetWebTaskPool();
+
+#endif
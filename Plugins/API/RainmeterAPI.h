@@ -51,6 +51,21 @@ LIBRARY_EXPORT void __cdecl RmLogF(void* rm, int level, LPCWSTR format, ...);
 
 LIBRARY_EXPORT BOOL __cdecl LSLog(int level, LPCWSTR unused, LPCWSTR message);
 
+//
+// Plugin flags
+//
+
+// Plugins may export "UINT GetPluginFlags()" to return a combination of these flags.
+enum RmPluginFlags
+{
+	// Update() may be called on a worker thread concurrently with the Update() functions of other
+	// measures (but never concurrently with the other functions of the same measure). When this
+	// flag is set, Update() may call only RmLog, RmLogF, LSLog and RmGet. It must not call
+	// RmExecute, RmReplaceVariables, RmPathToAbsolute or the Rm*Read* functions, and it must not
+	// change the working directory, which is shared by all plugins.
+	RMPF_THREADSAFEUPDATE = 0x00000001
+};
+
 //
 // Wrapper functions
 //